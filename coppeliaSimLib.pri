@@ -4,6 +4,7 @@ DEFINES += SIM_LIB
 DEFINES += SIM_MATH_DOUBLE # math and vector classes
 DEFINES += TMPOPERATION # <-- remove once we release V4.6 (i.e. V4.5 needs to support both serialization formats). Same for CMakeLists.txt
 #DEFINES += HAS_PHYSX
+#DEFINES += SIM_WITHOUT_FUNCTRACE # compiles out TRACE_C_API, TRACE_LUA_API and TRACE_INTERNAL
 
 CONFIG += shared plugin debug_and_release
 CONFIG += WITH_QT # can be compiled without Qt, but then it should be headless, and some functionality won't be there, check TODO_SIM_WITH_QT
@@ -348,6 +349,7 @@ HEADERS += $$PWD/sourceCode/platform/vVarious.h \
     $$PWD/sourceCode/platform/vThread.h \
     $$PWD/sourceCode/platform/vMutex.h \
     $$PWD/sourceCode/platform/vFileFinder.h \
+    $$PWD/sourceCode/platform/vMappedFile.h \
     $$PWD/sourceCode/platform/vFile.h \
     $$PWD/sourceCode/platform/vDateTime.h \
     $$PWD/sourceCode/platform/vArchive.h
@@ -427,6 +429,8 @@ HEADERS += $$PWD/sourceCode/mainContainers/sceneContainers/drawingContainer.h \
     $$PWD/sourceCode/mainContainers/sceneContainers/distanceObjectContainer_old.h \
     $$PWD/sourceCode/mainContainers/sceneContainers/collisionObjectContainer_old.h \
     $$PWD/sourceCode/mainContainers/sceneContainers/sceneObjectContainer.h \
+    $$PWD/sourceCode/mainContainers/sceneContainers/worldTransformStore.h \
+    $$PWD/sourceCode/mainContainers/sceneContainers/sceneBroadphase.h \
     $$PWD/sourceCode/shared/mainContainers/sceneContainers/_sceneObjectContainer_.h \
     $$PWD/sourceCode/mainContainers/sceneContainers/mainSettings.h \
     $$PWD/sourceCode/mainContainers/sceneContainers/embeddedScriptContainer.h \
@@ -449,6 +453,10 @@ HEADERS += $$PWD/sourceCode/mainContainers/applicationContainers/copyBuffer.h \
     $$PWD/sourceCode/mainContainers/applicationContainers/calculationInfo.h \
     $$PWD/sourceCode/mainContainers/applicationContainers/interfaceStackContainer.h \
     $$PWD/sourceCode/mainContainers/applicationContainers/addOnScriptContainer.h \
+    $$PWD/sourceCode/mainContainers/applicationContainers/genesisEventSnapshot.h \
+    $$PWD/sourceCode/mainContainers/applicationContainers/eventData.h \
+    $$PWD/sourceCode/mainContainers/applicationContainers/eventNodePool.h \
+    $$PWD/sourceCode/mainContainers/applicationContainers/eventLog.h \
 
 HEADERS += $$PWD/sourceCode/sceneObjects/visionSensorObjectRelated/simpleFilter.h \
     $$PWD/sourceCode/sceneObjects/visionSensorObjectRelated/composedFilter.h \
@@ -459,6 +467,11 @@ HEADERS += $$PWD/sourceCode/scripting/userParameters.h \
     $$PWD/sourceCode/scripting/scriptObject.h \
     $$PWD/sourceCode/scripting/outsideCommandQueueForScript.h \
     $$PWD/sourceCode/scripting/luaWrapper.h \
+    $$PWD/sourceCode/scripting/luaBytecodeCache.h \
+    $$PWD/sourceCode/scripting/luaStatePool.h \
+    $$PWD/sourceCode/scripting/scriptProfiler.h \
+    $$PWD/sourceCode/scripting/scriptIsolation.h \
+    $$PWD/sourceCode/scripting/luaBuffer.h \
 
 HEADERS += $$PWD/sourceCode/scripting/customScriptFuncAndVar/scriptCustomFuncAndVarContainer.h \
     $$PWD/sourceCode/scripting/customScriptFuncAndVar/scriptCustomFunction.h \
@@ -507,6 +520,7 @@ HEADERS += $$PWD/sourceCode/variousFunctions/sceneObjectOperations.h \
 
 HEADERS += $$PWD/sourceCode/geometricAlgorithms/linMotionRoutines.h \
     $$PWD/sourceCode/geometricAlgorithms/meshRoutines.h \
+    $$PWD/sourceCode/geometricAlgorithms/aabbTree.h \
     $$PWD/sourceCode/geometricAlgorithms/meshManip.h \
     $$PWD/sourceCode/geometricAlgorithms/edgeElement.h \
     $$PWD/sourceCode/geometricAlgorithms/algos.h \
@@ -523,6 +537,7 @@ HEADERS += $$PWD/sourceCode/various/simConfig.h \
     $$PWD/sourceCode/various/folderSystem.h \
     $$PWD/sourceCode/various/dynMaterialObject.h \
     $$PWD/sourceCode/various/easyLock.h \
+    $$PWD/sourceCode/various/funcTraceBuffer.h \
     $$PWD/sourceCode/various/ghostObject.h \
     $$PWD/sourceCode/various/sigHandler.h \
     $$PWD/sourceCode/various/syncObject.h \
@@ -575,6 +590,7 @@ HEADERS += $$PWD/sourceCode/utils/threadPool_old.h \
     $$PWD/sourceCode/utils/cbor.h \
     $$PWD/sourceCode/utils/annJson.h \
     $$PWD/sourceCode/utils/sha256.h \
+    $$PWD/sourceCode/utils/flatHashMap.h \
 
 
 HEADERS += $$PWD/sourceCode/customUserInterfaces/buttonBlock.h \
@@ -749,6 +765,7 @@ SOURCES += $$PWD/sourceCode/platform/vVarious.cpp \
     $$PWD/sourceCode/platform/vThread.cpp \
     $$PWD/sourceCode/platform/vMutex.cpp \
     $$PWD/sourceCode/platform/vFileFinder.cpp \
+    $$PWD/sourceCode/platform/vMappedFile.cpp \
     $$PWD/sourceCode/platform/vFile.cpp \
     $$PWD/sourceCode/platform/vDateTime.cpp \
     $$PWD/sourceCode/platform/vArchive.cpp
@@ -830,6 +847,8 @@ SOURCES += $$PWD/sourceCode/mainContainers/sceneContainers/bannerContainer.cpp \
     $$PWD/sourceCode/mainContainers/sceneContainers/collisionObjectContainer_old.cpp \
     $$PWD/sourceCode/mainContainers/sceneContainers/outsideCommandQueue.cpp \
     $$PWD/sourceCode/mainContainers/sceneContainers/sceneObjectContainer.cpp \
+    $$PWD/sourceCode/mainContainers/sceneContainers/worldTransformStore.cpp \
+    $$PWD/sourceCode/mainContainers/sceneContainers/sceneBroadphase.cpp \
     $$PWD/sourceCode/shared/mainContainers/sceneContainers/_sceneObjectContainer_.cpp \
     $$PWD/sourceCode/mainContainers/sceneContainers/mainSettings.cpp \
     $$PWD/sourceCode/mainContainers/sceneContainers/embeddedScriptContainer.cpp \
@@ -851,6 +870,10 @@ SOURCES += $$PWD/sourceCode/mainContainers/applicationContainers/copyBuffer.cpp
     $$PWD/sourceCode/mainContainers/applicationContainers/calculationInfo.cpp \
     $$PWD/sourceCode/mainContainers/applicationContainers/interfaceStackContainer.cpp \
     $$PWD/sourceCode/mainContainers/applicationContainers/addOnScriptContainer.cpp \
+    $$PWD/sourceCode/mainContainers/applicationContainers/genesisEventSnapshot.cpp \
+    $$PWD/sourceCode/mainContainers/applicationContainers/eventData.cpp \
+    $$PWD/sourceCode/mainContainers/applicationContainers/eventNodePool.cpp \
+    $$PWD/sourceCode/mainContainers/applicationContainers/eventLog.cpp \
 
 SOURCES += $$PWD/sourceCode/sceneObjects/visionSensorObjectRelated/simpleFilter.cpp \
     $$PWD/sourceCode/sceneObjects/visionSensorObjectRelated/composedFilter.cpp \
@@ -861,6 +884,11 @@ SOURCES += $$PWD/sourceCode/scripting/userParameters.cpp \
     $$PWD/sourceCode/scripting/scriptObject.cpp \
     $$PWD/sourceCode/scripting/outsideCommandQueueForScript.cpp \
     $$PWD/sourceCode/scripting/luaWrapper.cpp \
+    $$PWD/sourceCode/scripting/luaBytecodeCache.cpp \
+    $$PWD/sourceCode/scripting/luaStatePool.cpp \
+    $$PWD/sourceCode/scripting/scriptProfiler.cpp \
+    $$PWD/sourceCode/scripting/scriptIsolation.cpp \
+    $$PWD/sourceCode/scripting/luaBuffer.cpp \
 
 SOURCES += $$PWD/sourceCode/scripting/customScriptFuncAndVar/scriptCustomFuncAndVarContainer.cpp \
     $$PWD/sourceCode/scripting/customScriptFuncAndVar/scriptCustomFunction.cpp \
@@ -910,6 +938,7 @@ SOURCES += $$PWD/sourceCode/variousFunctions/sceneObjectOperations.cpp \
 
 SOURCES += $$PWD/sourceCode/geometricAlgorithms/linMotionRoutines.cpp \
     $$PWD/sourceCode/geometricAlgorithms/meshRoutines.cpp \
+    $$PWD/sourceCode/geometricAlgorithms/aabbTree.cpp \
     $$PWD/sourceCode/geometricAlgorithms/meshManip.cpp \
     $$PWD/sourceCode/geometricAlgorithms/edgeElement.cpp \
     $$PWD/sourceCode/geometricAlgorithms/algos.cpp \
@@ -923,6 +952,7 @@ SOURCES += $$PWD/sourceCode/various/gV.cpp \
     $$PWD/sourceCode/various/app.cpp \
     $$PWD/sourceCode/various/dynMaterialObject.cpp \
     $$PWD/sourceCode/various/easyLock.cpp \
+    $$PWD/sourceCode/various/funcTraceBuffer.cpp \
     $$PWD/sourceCode/various/ghostObject.cpp \
     $$PWD/sourceCode/various/sigHandler.cpp \
     $$PWD/sourceCode/various/syncObject.cpp \
@@ -43,7 +43,11 @@ bool CCollisionRoutine::doEntitiesCollide(int entity1ID,int entity2ID,std::vecto
             { // Special group here (all objects except the shape):
                 std::vector<CSceneObject*> exception;
                 exception.push_back(object1);
-                App::currentWorld->sceneObjects->getAllCollidableObjectsFromSceneExcept(&exception,group);
+                std::vector<CSceneObject*> candidates; // objects with overlapping bounding boxes
+                if (App::currentWorld->sceneObjects->getBroadphaseCandidates(exception,0.0,candidates))
+                    App::currentWorld->sceneObjects->getAllCollidableObjectsFromSceneExcept(&exception,group,&candidates);
+                else
+                    App::currentWorld->sceneObjects->getAllCollidableObjectsFromSceneExcept(&exception,group);
             }
             else
             { // Regular group here:
@@ -99,7 +103,11 @@ bool CCollisionRoutine::doEntitiesCollide(int entity1ID,int entity2ID,std::vecto
                 std::vector<CSceneObject*> group2;
                 if (entity2ID==-1)
                 { // Special group here
-                    App::currentWorld->sceneObjects->getAllCollidableObjectsFromSceneExcept(&group1,group2);
+                    std::vector<CSceneObject*> candidates; // objects with overlapping bounding boxes
+                    if (App::currentWorld->sceneObjects->getBroadphaseCandidates(group1,0.0,candidates))
+                        App::currentWorld->sceneObjects->getAllCollidableObjectsFromSceneExcept(&group1,group2,&candidates);
+                    else
+                        App::currentWorld->sceneObjects->getAllCollidableObjectsFromSceneExcept(&group1,group2);
                 }
                 else
                 { // Regular group here:
@@ -128,10 +136,11 @@ bool CCollisionRoutine::doEntitiesCollide(int entity1ID,int entity2ID,std::vecto
 
 //----------------------------------------------------------------------------------
 
-bool CCollisionRoutine::_doesShapeCollideWithShape(CShape* shape1,CShape* shape2,std::vector<double>* intersections,bool overrideShape1CollidableFlag,bool overrideShape2CollidableFlag)
+bool CCollisionRoutine::_doesShapeCollideWithShape(CShape* shape1,CShape* shape2,std::vector<double>* intersections,bool overrideShape1CollidableFlag,bool overrideShape2CollidableFlag,const C7Vector* shape1Tr/*=nullptr*/,const C7Vector* shape2Tr/*=nullptr*/)
 {   // if intersections is different from nullptr we check for all collisions and
     // append intersection segments to the vector.
     // We never check a shape against itself!!
+    // shape1Tr and shape2Tr are the shapes' full cumulative transformations, if already known (e.g. from a batch read)
     if (shape1==shape2)
         return(false);
     if ( ( (shape1->getCumulativeObjectSpecialProperty()&sim_objectspecialproperty_collidable)==0 )&&(!overrideShape1CollidableFlag) )
@@ -142,7 +151,16 @@ bool CCollisionRoutine::_doesShapeCollideWithShape(CShape* shape1,CShape* shape2
     // Before building collision nodes, check if the shape's bounding boxes collide (new since 9/7/2014):
     if ( (!shape1->isMeshCalculationStructureInitialized())||(!shape2->isMeshCalculationStructureInitialized()) )
     {
-        if (!CPluginContainer::geomPlugin_getBoxBoxCollision(shape1->getFullCumulativeTransformation(),shape1->getBoundingBoxHalfSizes(),shape2->getFullCumulativeTransformation(),shape2->getBoundingBoxHalfSizes(),true))
+        C7Vector tr1,tr2;
+        if (shape1Tr!=nullptr)
+            tr1=*shape1Tr;
+        else
+            tr1=shape1->getFullCumulativeTransformation();
+        if (shape2Tr!=nullptr)
+            tr2=*shape2Tr;
+        else
+            tr2=shape2->getFullCumulativeTransformation();
+        if (!CPluginContainer::geomPlugin_getBoxBoxCollision(tr1,shape1->getBoundingBoxHalfSizes(),tr2,shape2->getBoundingBoxHalfSizes(),true))
             return(false);
     }
 
@@ -157,13 +175,16 @@ bool CCollisionRoutine::_doesGroupCollideWithShape(const std::vector<CSceneObjec
 {   // if intersections is different from nullptr we check for ALL shape-shape collisions and
     // append intersection segments to the vector.
     bool returnValue=false;
+    std::vector<C7Vector> transformations;
+    App::currentWorld->sceneObjects->getWorldTransformations(group,transformations); // batch read, for the bounding box pre-checks
+    C7Vector shapeTr(shape->getFullCumulativeTransformation());
     for (size_t i=0;i<group.size();i++)
     {
         if (group[i]->getObjectType()==sim_object_shape_type)
         {
             if (shape!=group[i])
             { // never self-collision
-                if (_doesShapeCollideWithShape(shape,(CShape*)group[i],intersections,overrideShapeCollidableFlag,true))
+                if (_doesShapeCollideWithShape(shape,(CShape*)group[i],intersections,overrideShapeCollidableFlag,true,&shapeTr,&transformations[i]))
                 {
                     returnValue=true;
                     collidingGroupObject=group[i]->getObjectHandle();
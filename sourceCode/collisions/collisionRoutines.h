@@ -18,7 +18,7 @@ public:
 
 private:
     static bool _doesObjectCollideWithObject(CSceneObject* object1,CSceneObject* object2,bool overrideObject1CollidableFlag,bool overrideObject2CollidableFlag,std::vector<double>* intersections);
-    static bool _doesShapeCollideWithShape(CShape* shape1,CShape* shape2,std::vector<double>* intersections,bool overrideShape1CollidableFlag,bool overrideShape2CollidableFlag);
+    static bool _doesShapeCollideWithShape(CShape* shape1,CShape* shape2,std::vector<double>* intersections,bool overrideShape1CollidableFlag,bool overrideShape2CollidableFlag,const C7Vector* shape1Tr=nullptr,const C7Vector* shape2Tr=nullptr);
     static bool _doesOctreeCollideWithShape(COctree* octree,CShape* shape,bool overrideOctreeCollidableFlag,bool overrideShapeCollidableFlag);
     static bool _doesOctreeCollideWithOctree(COctree* octree1,COctree* octree2,bool overrideOctree1CollidableFlag,bool overrideOctree2CollidableFlag);
     static bool _doesOctreeCollideWithPointCloud(COctree* octree,CPointCloud* pointCloud,bool overrideOctreeCollidableFlag,bool overridePointCloudCollidableFlag);
@@ -146,19 +146,19 @@ void CColorObject::pushShapeColorChangeEvent(int objectHandle,int colorIndex)
     {
         const char* cmd="color";
         auto [event,data]=App::worldContainer->prepareSceneObjectChangedEvent(objectHandle,false,cmd,false);
-        CInterfaceStackTable* sdata=new CInterfaceStackTable();
-        data->appendMapObject_stringObject(cmd,sdata);
+        data->openMapObject_stringMap(cmd);
         float c[9];
         int w=sim_colorcomponent_ambient_diffuse;
         getColor(c+0,w);
         getColor(c+3,sim_colorcomponent_specular);
         getColor(c+6,sim_colorcomponent_emission);
-        sdata->appendMapObject_stringFloatArray("color",c,9);
+        data->appendMapObject_stringFloatArray("color",c,9);
         float transp=0.0;
         if (_translucid)
             transp=1.0-_opacity;
-        sdata->appendMapObject_stringFloat("transparency",transp);
-        sdata->appendMapObject_stringInt32("index",colorIndex);
+        data->appendMapObject_stringFloat("transparency",transp);
+        data->appendMapObject_stringInt32("index",colorIndex);
+        data->closeObject();
         App::worldContainer->pushEvent(event);
     }
 }
@@ -169,15 +169,15 @@ void CColorObject::pushColorChangeEvent(int objectHandle,float col1[9],float col
     {
         const char* cmd="colors";
         auto [event,data]=App::worldContainer->prepareSceneObjectChangedEvent(objectHandle,false,cmd,false);
-        CInterfaceStackTable* sdata=new CInterfaceStackTable();
-        data->appendMapObject_stringObject(cmd,sdata);
-        sdata->appendArrayObject_floatArray(col1,9);
+        data->openMapObject_stringArray(cmd);
+        data->appendArrayObject_floatArray(col1,9);
         if (col2!=nullptr)
-            sdata->appendArrayObject_floatArray(col2,9);
+            data->appendArrayObject_floatArray(col2,9);
         if (col3!=nullptr)
-            sdata->appendArrayObject_floatArray(col3,9);
+            data->appendArrayObject_floatArray(col3,9);
         if (col4!=nullptr)
-            sdata->appendArrayObject_floatArray(col4,9);
+            data->appendArrayObject_floatArray(col4,9);
+        data->closeObject();
         App::worldContainer->pushEvent(event);
     }
 }
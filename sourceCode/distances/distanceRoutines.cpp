@@ -118,7 +118,11 @@ bool CDistanceRoutine::getDistanceBetweenEntitiesIfSmaller(int entity1ID,int ent
             { // Special group here (all objects except the object):
                 std::vector<CSceneObject*> exception;
                 exception.push_back(object1);
-                App::currentWorld->sceneObjects->getAllMeasurableObjectsFromSceneExcept(&exception,group);
+                std::vector<CSceneObject*> candidates; // objects with bounding boxes within the threshold
+                if ( (dist<FLOAT_MAX)&&App::currentWorld->sceneObjects->getBroadphaseCandidates(exception,dist,candidates) )
+                    App::currentWorld->sceneObjects->getAllMeasurableObjectsFromSceneExcept(&exception,group,&candidates);
+                else
+                    App::currentWorld->sceneObjects->getAllMeasurableObjectsFromSceneExcept(&exception,group);
             }
             else
             { // Regular group here:
@@ -161,7 +165,11 @@ bool CDistanceRoutine::getDistanceBetweenEntitiesIfSmaller(int entity1ID,int ent
                 std::vector<CSceneObject*> group2;
                 if (entity2ID==-1)
                 { // Special group here
-                    App::currentWorld->sceneObjects->getAllMeasurableObjectsFromSceneExcept(&group1,group2);
+                    std::vector<CSceneObject*> candidates; // objects with bounding boxes within the threshold
+                    if ( (dist<FLOAT_MAX)&&App::currentWorld->sceneObjects->getBroadphaseCandidates(group1,dist,candidates) )
+                        App::currentWorld->sceneObjects->getAllMeasurableObjectsFromSceneExcept(&group1,group2,&candidates);
+                    else
+                        App::currentWorld->sceneObjects->getAllMeasurableObjectsFromSceneExcept(&group1,group2);
                 }
                 else
                 { // Regular group here:
@@ -0,0 +1,315 @@
+#include <aabbTree.h>
+#include <algorithm>
+
+#define AABBTREE_ABSOLUTE_MARGIN 0.01 // in meters
+#define AABBTREE_RELATIVE_MARGIN 0.1 // relative to the box size
+
+CAabbTree::CAabbTree()
+{
+    clear();
+}
+
+CAabbTree::~CAabbTree()
+{
+}
+
+void CAabbTree::clear()
+{
+    _nodes.clear();
+    _root=-1;
+    _freeList=-1;
+    _proxyCount=0;
+}
+
+int CAabbTree::createProxy(const C3Vector& boxMin,const C3Vector& boxMax,int id)
+{
+    int proxy=_allocateNode();
+    _fatten(boxMin,boxMax,_nodes[proxy].boxMin,_nodes[proxy].boxMax);
+    _nodes[proxy].height=0;
+    _nodes[proxy].id=id;
+    _insertLeaf(proxy);
+    _proxyCount++;
+    return(proxy);
+}
+
+void CAabbTree::destroyProxy(int proxy)
+{
+    _removeLeaf(proxy);
+    _freeNode(proxy);
+    _proxyCount--;
+}
+
+bool CAabbTree::moveProxy(int proxy,const C3Vector& boxMin,const C3Vector& boxMax)
+{
+    SAabbTreeNode& node=_nodes[proxy];
+    bool contained=true;
+    for (size_t i=0;i<3;i++)
+        contained=contained&&(node.boxMin.data[i]<=boxMin.data[i])&&(node.boxMax.data[i]>=boxMax.data[i]);
+    if (contained)
+        return(false);
+    _removeLeaf(proxy);
+    _fatten(boxMin,boxMax,_nodes[proxy].boxMin,_nodes[proxy].boxMax);
+    _insertLeaf(proxy);
+    return(true);
+}
+
+void CAabbTree::query(const C3Vector& boxMin,const C3Vector& boxMax,std::vector<int>& ids) const
+{
+    if (_root==-1)
+        return;
+    std::vector<int> toExplore;
+    toExplore.push_back(_root);
+    while (toExplore.size()>0)
+    {
+        const SAabbTreeNode& node=_nodes[toExplore[toExplore.size()-1]];
+        toExplore.pop_back();
+        bool overlap=true;
+        for (size_t i=0;i<3;i++)
+            overlap=overlap&&(node.boxMin.data[i]<=boxMax.data[i])&&(node.boxMax.data[i]>=boxMin.data[i]);
+        if (overlap)
+        {
+            if (node.child1==-1)
+                ids.push_back(node.id);
+            else
+            {
+                toExplore.push_back(node.child1);
+                toExplore.push_back(node.child2);
+            }
+        }
+    }
+}
+
+size_t CAabbTree::getProxyCount() const
+{
+    return(_proxyCount);
+}
+
+int CAabbTree::getHeight() const
+{
+    int retVal=0;
+    if (_root!=-1)
+        retVal=_nodes[_root].height;
+    return(retVal);
+}
+
+int CAabbTree::_allocateNode()
+{
+    int retVal=_freeList;
+    if (retVal==-1)
+    {
+        _nodes.push_back(SAabbTreeNode());
+        retVal=int(_nodes.size())-1;
+    }
+    else
+        _freeList=_nodes[retVal].parent;
+    _nodes[retVal].parent=-1;
+    _nodes[retVal].child1=-1;
+    _nodes[retVal].child2=-1;
+    _nodes[retVal].height=0;
+    _nodes[retVal].id=-1;
+    return(retVal);
+}
+
+void CAabbTree::_freeNode(int node)
+{
+    _nodes[node].parent=_freeList;
+    _nodes[node].height=-1;
+    _freeList=node;
+}
+
+void CAabbTree::_insertLeaf(int leaf)
+{
+    if (_root==-1)
+    {
+        _root=leaf;
+        _nodes[leaf].parent=-1;
+        return;
+    }
+
+    // Find the best sibling, i.e. the one that increases the total area least:
+    int index=_root;
+    while (_nodes[index].child1!=-1)
+    {
+        C3Vector combinedMin,combinedMax;
+        _combine(_nodes[index],_nodes[leaf],combinedMin,combinedMax);
+        double area=_getArea(_nodes[index].boxMin,_nodes[index].boxMax);
+        double combinedArea=_getArea(combinedMin,combinedMax);
+        double cost=2.0*combinedArea; // new parent for this node and the leaf
+        double inheritanceCost=2.0*(combinedArea-area); // minimum cost of pushing the leaf further down
+        double childCosts[2];
+        int children[2]={_nodes[index].child1,_nodes[index].child2};
+        for (size_t i=0;i<2;i++)
+        {
+            const SAabbTreeNode& child=_nodes[children[i]];
+            C3Vector mi,ma;
+            _combine(child,_nodes[leaf],mi,ma);
+            childCosts[i]=_getArea(mi,ma)+inheritanceCost;
+            if (child.child1!=-1)
+                childCosts[i]-=_getArea(child.boxMin,child.boxMax);
+        }
+        if ( (cost<childCosts[0])&&(cost<childCosts[1]) )
+            break;
+        if (childCosts[0]<childCosts[1])
+            index=children[0];
+        else
+            index=children[1];
+    }
+    int sibling=index;
+
+    // Create a new parent:
+    int oldParent=_nodes[sibling].parent;
+    int newParent=_allocateNode(); // beware, can invalidate references to _nodes
+    _nodes[newParent].parent=oldParent;
+    _combine(_nodes[sibling],_nodes[leaf],_nodes[newParent].boxMin,_nodes[newParent].boxMax);
+    _nodes[newParent].height=_nodes[sibling].height+1;
+    _nodes[newParent].child1=sibling;
+    _nodes[newParent].child2=leaf;
+    _nodes[sibling].parent=newParent;
+    _nodes[leaf].parent=newParent;
+    if (oldParent==-1)
+        _root=newParent;
+    else
+    {
+        if (_nodes[oldParent].child1==sibling)
+            _nodes[oldParent].child1=newParent;
+        else
+            _nodes[oldParent].child2=newParent;
+    }
+
+    // Refit and rebalance the ancestors:
+    index=_nodes[leaf].parent;
+    while (index!=-1)
+    {
+        index=_balance(index);
+        SAabbTreeNode& node=_nodes[index];
+        node.height=1+std::max<int>(_nodes[node.child1].height,_nodes[node.child2].height);
+        _combine(_nodes[node.child1],_nodes[node.child2],node.boxMin,node.boxMax);
+        index=node.parent;
+    }
+}
+
+void CAabbTree::_removeLeaf(int leaf)
+{
+    if (leaf==_root)
+    {
+        _root=-1;
+        return;
+    }
+    int parent=_nodes[leaf].parent;
+    int grandParent=_nodes[parent].parent;
+    int sibling=_nodes[parent].child1;
+    if (sibling==leaf)
+        sibling=_nodes[parent].child2;
+    if (grandParent==-1)
+    {
+        _root=sibling;
+        _nodes[sibling].parent=-1;
+        _freeNode(parent);
+    }
+    else
+    {
+        if (_nodes[grandParent].child1==parent)
+            _nodes[grandParent].child1=sibling;
+        else
+            _nodes[grandParent].child2=sibling;
+        _nodes[sibling].parent=grandParent;
+        _freeNode(parent);
+        int index=grandParent;
+        while (index!=-1)
+        {
+            index=_balance(index);
+            SAabbTreeNode& node=_nodes[index];
+            node.height=1+std::max<int>(_nodes[node.child1].height,_nodes[node.child2].height);
+            _combine(_nodes[node.child1],_nodes[node.child2],node.boxMin,node.boxMax);
+            index=node.parent;
+        }
+    }
+}
+
+int CAabbTree::_balance(int a)
+{ // rotates a's higher child up if a is unbalanced. Returns the new root of the subtree
+    SAabbTreeNode& nodeA=_nodes[a];
+    if ( (nodeA.child1==-1)||(nodeA.height<2) )
+        return(a);
+    int b=nodeA.child1;
+    int c=nodeA.child2;
+    SAabbTreeNode& nodeB=_nodes[b];
+    SAabbTreeNode& nodeC=_nodes[c];
+    int balance=nodeC.height-nodeB.height;
+    if ( (balance>1)||(balance<-1) )
+    {
+        int up=c; // the child that is rotated up
+        int other=b;
+        if (balance<-1)
+        {
+            up=b;
+            other=c;
+        }
+        SAabbTreeNode& nodeUp=_nodes[up];
+        SAabbTreeNode& nodeOther=_nodes[other];
+        int f=nodeUp.child1;
+        int g=nodeUp.child2;
+
+        // 'up' replaces 'a':
+        nodeUp.child1=a;
+        nodeUp.parent=nodeA.parent;
+        nodeA.parent=up;
+        if (nodeUp.parent==-1)
+            _root=up;
+        else
+        {
+            if (_nodes[nodeUp.parent].child1==a)
+                _nodes[nodeUp.parent].child1=up;
+            else
+                _nodes[nodeUp.parent].child2=up;
+        }
+
+        // 'up' keeps its higher child, 'a' takes the other one:
+        int keep=f;
+        int give=g;
+        if (_nodes[g].height>_nodes[f].height)
+        {
+            keep=g;
+            give=f;
+        }
+        nodeUp.child2=keep;
+        if (up==c)
+            nodeA.child2=give;
+        else
+            nodeA.child1=give;
+        _nodes[give].parent=a;
+        _combine(nodeOther,_nodes[give],nodeA.boxMin,nodeA.boxMax);
+        nodeA.height=1+std::max<int>(nodeOther.height,_nodes[give].height);
+        _combine(nodeA,_nodes[keep],nodeUp.boxMin,nodeUp.boxMax);
+        nodeUp.height=1+std::max<int>(nodeA.height,_nodes[keep].height);
+        return(up);
+    }
+    return(a);
+}
+
+void CAabbTree::_fatten(const C3Vector& boxMin,const C3Vector& boxMax,C3Vector& fatMin,C3Vector& fatMax) const
+{
+    for (size_t i=0;i<3;i++)
+    {
+        double m=AABBTREE_ABSOLUTE_MARGIN+AABBTREE_RELATIVE_MARGIN*(boxMax.data[i]-boxMin.data[i]);
+        fatMin.data[i]=boxMin.data[i]-m;
+        fatMax.data[i]=boxMax.data[i]+m;
+    }
+}
+
+double CAabbTree::_getArea(const C3Vector& boxMin,const C3Vector& boxMax)
+{
+    double dx=boxMax.data[0]-boxMin.data[0];
+    double dy=boxMax.data[1]-boxMin.data[1];
+    double dz=boxMax.data[2]-boxMin.data[2];
+    return(2.0*(dx*dy+dy*dz+dz*dx));
+}
+
+void CAabbTree::_combine(const SAabbTreeNode& a,const SAabbTreeNode& b,C3Vector& boxMin,C3Vector& boxMax)
+{
+    for (size_t i=0;i<3;i++)
+    {
+        boxMin.data[i]=std::min<double>(a.boxMin.data[i],b.boxMin.data[i]);
+        boxMax.data[i]=std::max<double>(a.boxMax.data[i],b.boxMax.data[i]);
+    }
+}
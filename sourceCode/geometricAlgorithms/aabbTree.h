@@ -0,0 +1,46 @@
+#pragma once
+
+#include <simMath/3Vector.h>
+#include <vector>
+
+struct SAabbTreeNode
+{
+    C3Vector boxMin;
+    C3Vector boxMax;
+    int parent; // next free node, for free nodes
+    int child1; // -1 for leaves
+    int child2;
+    int height; // 0 for leaves, -1 for free nodes
+    int id; // leaves only
+};
+
+class CAabbTree
+{ // Dynamic AABB tree (balanced binary tree, surface area insertion heuristic). Leaves hold enlarged boxes, so that
+  // small motions do not require a tree update
+public:
+    CAabbTree();
+    virtual ~CAabbTree();
+
+    void clear();
+    int createProxy(const C3Vector& boxMin,const C3Vector& boxMax,int id); // returns the proxy
+    void destroyProxy(int proxy);
+    bool moveProxy(int proxy,const C3Vector& boxMin,const C3Vector& boxMax); // true if the tree was updated
+    void query(const C3Vector& boxMin,const C3Vector& boxMax,std::vector<int>& ids) const; // ids of the leaves that overlap the box
+    size_t getProxyCount() const;
+    int getHeight() const;
+
+private:
+    int _allocateNode();
+    void _freeNode(int node);
+    void _insertLeaf(int leaf);
+    void _removeLeaf(int leaf);
+    int _balance(int a);
+    void _fatten(const C3Vector& boxMin,const C3Vector& boxMax,C3Vector& fatMin,C3Vector& fatMax) const;
+    static double _getArea(const C3Vector& boxMin,const C3Vector& boxMax);
+    static void _combine(const SAabbTreeNode& a,const SAabbTreeNode& b,C3Vector& boxMin,C3Vector& boxMax);
+
+    std::vector<SAabbTreeNode> _nodes;
+    int _root;
+    int _freeList;
+    size_t _proxyCount;
+};
@@ -34,6 +34,11 @@ int CInterfaceStack::getId() const
     return(_interfaceStackId);
 }
 
+bool CInterfaceStack::hasId() const
+{
+    return(_interfaceStackId!=-1);
+}
+
 int CInterfaceStack::getStackSize() const
 {
     return((int)_stackObjects.size());
@@ -14,6 +14,7 @@ public:
 
     void setId(int id);
     int getId() const;
+    bool hasId() const;
     void clear();
 
     // C interface (creation):
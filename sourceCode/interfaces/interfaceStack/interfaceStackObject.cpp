@@ -5,6 +5,103 @@
 #include <interfaceStackBool.h>
 #include <interfaceStackString.h>
 #include <interfaceStackTable.h>
+#include <atomic>
+#include <new>
+
+#define STACKOBJECTPOOL_GRANULARITY 16
+#define STACKOBJECTPOOL_CLASSES 8 // i.e. nodes up to 128 bytes are pooled
+#define STACKOBJECTPOOL_MAX_FREE_BLOCKS 8192 // per size class and thread
+
+struct SStackObjectFreeBlock
+{
+    SStackObjectFreeBlock* next;
+};
+
+struct SStackObjectPool
+{
+    SStackObjectFreeBlock* freeBlocks[STACKOBJECTPOOL_CLASSES];
+    size_t freeBlockCnt[STACKOBJECTPOOL_CLASSES];
+    SStackObjectPool();
+    ~SStackObjectPool();
+};
+
+static thread_local SStackObjectPool _stackObjectPool;
+static thread_local bool _stackObjectPoolDestroyed=false; // nodes can be freed during thread/static destruction
+static std::atomic<unsigned long long int> _stackObjectHeapAllocCnt(0);
+static std::atomic<unsigned long long int> _stackObjectPooledAllocCnt(0);
+
+SStackObjectPool::SStackObjectPool()
+{
+    for (size_t i=0;i<STACKOBJECTPOOL_CLASSES;i++)
+    {
+        freeBlocks[i]=nullptr;
+        freeBlockCnt[i]=0;
+    }
+}
+
+SStackObjectPool::~SStackObjectPool()
+{
+    _stackObjectPoolDestroyed=true;
+    for (size_t i=0;i<STACKOBJECTPOOL_CLASSES;i++)
+    {
+        while (freeBlocks[i]!=nullptr)
+        {
+            SStackObjectFreeBlock* b=freeBlocks[i];
+            freeBlocks[i]=b->next;
+            ::operator delete(b);
+        }
+    }
+}
+
+void* CInterfaceStackObject::operator new(size_t size)
+{
+    size_t c=(size-1)/STACKOBJECTPOOL_GRANULARITY;
+    if (c<STACKOBJECTPOOL_CLASSES)
+    {
+        if (!_stackObjectPoolDestroyed)
+        {
+            SStackObjectPool& pool=_stackObjectPool;
+            if (pool.freeBlocks[c]!=nullptr)
+            {
+                SStackObjectFreeBlock* b=pool.freeBlocks[c];
+                pool.freeBlocks[c]=b->next;
+                pool.freeBlockCnt[c]--;
+                _stackObjectPooledAllocCnt.fetch_add(1,std::memory_order_relaxed);
+                return(b);
+            }
+        }
+        size=(c+1)*STACKOBJECTPOOL_GRANULARITY; // blocks of a same class are interchangeable
+    }
+    _stackObjectHeapAllocCnt.fetch_add(1,std::memory_order_relaxed);
+    return(::operator new(size));
+}
+
+void CInterfaceStackObject::operator delete(void* p,size_t size)
+{ // size is the one of the most derived class (virtual destructor). A block freed by another thread than the
+    // one that allocated it simply migrates to that thread's free list
+    if (p==nullptr)
+        return;
+    size_t c=(size-1)/STACKOBJECTPOOL_GRANULARITY;
+    if ( (c<STACKOBJECTPOOL_CLASSES)&&(!_stackObjectPoolDestroyed) )
+    {
+        SStackObjectPool& pool=_stackObjectPool;
+        if (pool.freeBlockCnt[c]<STACKOBJECTPOOL_MAX_FREE_BLOCKS)
+        {
+            SStackObjectFreeBlock* b=(SStackObjectFreeBlock*)p;
+            b->next=pool.freeBlocks[c];
+            pool.freeBlocks[c]=b;
+            pool.freeBlockCnt[c]++;
+            return;
+        }
+    }
+    ::operator delete(p);
+}
+
+void CInterfaceStackObject::getAllocationCounters(unsigned long long int& heapAllocations,unsigned long long int& pooledAllocations)
+{
+    heapAllocations=_stackObjectHeapAllocCnt.load(std::memory_order_relaxed);
+    pooledAllocations=_stackObjectPooledAllocCnt.load(std::memory_order_relaxed);
+}
 
 CInterfaceStackObject::CInterfaceStackObject()
 {
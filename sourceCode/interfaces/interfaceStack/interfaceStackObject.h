@@ -31,6 +31,11 @@ public:
 
     int getObjectType() const;
 
+    // Nodes are small and short-lived: they come from per-thread free lists, per size class
+    static void* operator new(size_t size);
+    static void operator delete(void* p,size_t size);
+    static void getAllocationCounters(unsigned long long int& heapAllocations,unsigned long long int& pooledAllocations);
+
 protected:
     int _objectType;
 };
@@ -6,23 +6,29 @@
 #include <interfaceStackString.h>
 #include <interfaceStackTable.h>
 #include <algorithm> // std::sort, etc.
+#include <string.h>
+#include <chrono>
 
 CInterfaceStackTable::CInterfaceStackTable()
 {
     _objectType=STACK_OBJECT_TABLE;
     _isTableArray=true;
     _isCircularRef=false;
+    _keyIndex=nullptr;
+    _packedType=STACK_PACKED_NONE;
+    _packedCnt=0;
 }
 
 CInterfaceStackTable::~CInterfaceStackTable()
 {
+    delete _keyIndex;
     for (size_t i=0;i<_tableObjects.size();i++)
         delete _tableObjects[i];
 }
 
 bool CInterfaceStackTable::isEmpty() const
 {
-    return(_tableObjects.size()==0);
+    return( (_tableObjects.size()==0)&&(_packedCnt==0) );
 }
 
 bool CInterfaceStackTable::isTableArray() const
@@ -34,6 +40,8 @@ size_t CInterfaceStackTable::getArraySize() const
 {
     if (!_isTableArray)
         return(0);
+    if (_packedType!=STACK_PACKED_NONE)
+        return(_packedCnt);
     return(_tableObjects.size());
 }
 
@@ -54,11 +62,105 @@ void CInterfaceStackTable::setCircularRef()
     _isCircularRef=true;
 }
 
+int CInterfaceStackTable::getPackedType() const
+{
+    return(_packedType);
+}
+
+const void* CInterfaceStackTable::getPackedData() const
+{ // getArraySize() items, of type getPackedType()
+    if (_packedType==STACK_PACKED_NONE)
+        return(nullptr);
+    return(_packedData.data());
+}
+
+void CInterfaceStackTable::_setPackedArray(int packedType,const void* array,size_t l,size_t itemSize)
+{
+    for (size_t i=0;i<_tableObjects.size();i++)
+        delete _tableObjects[i];
+    _tableObjects.clear();
+    _rebuildKeyIndex();
+    _isTableArray=true;
+    _packedType=packedType;
+    _packedCnt=l;
+    _packedData.assign((const unsigned char*)array,(const unsigned char*)array+l*itemSize);
+    if (l==0)
+        _packedType=STACK_PACKED_NONE;
+}
+
+CInterfaceStackObject* CInterfaceStackTable::_createPackedItem(size_t ind) const
+{ // the caller takes ownership
+    const unsigned char* d=_packedData.data();
+    if (_packedType==STACK_PACKED_UCHAR)
+        return(new CInterfaceStackInteger(d[ind]));
+    if (_packedType==STACK_PACKED_INT32)
+        return(new CInterfaceStackInteger(((const int*)d)[ind]));
+    if (_packedType==STACK_PACKED_INT64)
+        return(new CInterfaceStackInteger(((const long long int*)d)[ind]));
+    if (_packedType==STACK_PACKED_FLOAT)
+        return(new CInterfaceStackNumber((double)((const float*)d)[ind]));
+    return(new CInterfaceStackNumber(((const double*)d)[ind]));
+}
+
+void CInterfaceStackTable::_expandPacked()
+{ // only from non-const methods: const methods read the packed data as is, so that they are safe to call concurrently
+    if (_packedType!=STACK_PACKED_NONE)
+    {
+        _tableObjects.reserve(_packedCnt);
+        for (size_t i=0;i<_packedCnt;i++)
+            _tableObjects.push_back(_createPackedItem(i));
+        _packedType=STACK_PACKED_NONE;
+        _packedCnt=0;
+        _packedData.clear();
+        _packedData.shrink_to_fit();
+    }
+}
+
+template<class T> void CInterfaceStackTable::_getPackedArray(T* array,size_t count) const
+{
+    size_t c=count;
+    if (c>_packedCnt)
+        c=_packedCnt;
+    const unsigned char* d=_packedData.data();
+    if (_packedType==STACK_PACKED_UCHAR)
+    {
+        for (size_t i=0;i<c;i++)
+            array[i]=(T)d[i];
+    }
+    else if (_packedType==STACK_PACKED_INT32)
+    {
+        for (size_t i=0;i<c;i++)
+            array[i]=(T)((const int*)d)[i];
+    }
+    else if (_packedType==STACK_PACKED_INT64)
+    {
+        for (size_t i=0;i<c;i++)
+            array[i]=(T)((const long long int*)d)[i];
+    }
+    else if (_packedType==STACK_PACKED_FLOAT)
+    {
+        for (size_t i=0;i<c;i++)
+            array[i]=(T)((const float*)d)[i];
+    }
+    else
+    {
+        for (size_t i=0;i<c;i++)
+            array[i]=(T)((const double*)d)[i];
+    }
+    for (size_t i=c;i<count;i++)
+        array[i]=0; // fill with zeros
+}
+
 
 bool CInterfaceStackTable::getUCharArray(unsigned char* array,int count) const
 {
     if (!_isTableArray)
         return(false);
+    if (_packedType!=STACK_PACKED_NONE)
+    {
+        _getPackedArray(array,(size_t)count);
+        return(true);
+    }
     bool retVal=true;
     size_t c=(size_t)count;
     if (c>_tableObjects.size())
@@ -85,6 +187,11 @@ bool CInterfaceStackTable::getInt32Array(int* array,int count) const
 {
     if (!_isTableArray)
         return(false);
+    if (_packedType!=STACK_PACKED_NONE)
+    {
+        _getPackedArray(array,(size_t)count);
+        return(true);
+    }
     bool retVal=true;
     size_t c=(size_t)count;
     if (c>_tableObjects.size())
@@ -111,6 +218,11 @@ bool CInterfaceStackTable::getInt64Array(long long int* array,int count) const
 {
     if (!_isTableArray)
         return(false);
+    if (_packedType!=STACK_PACKED_NONE)
+    {
+        _getPackedArray(array,(size_t)count);
+        return(true);
+    }
     bool retVal=true;
     size_t c=(size_t)count;
     if (c>_tableObjects.size())
@@ -137,6 +249,11 @@ bool CInterfaceStackTable::getFloatArray(float* array,int count) const
 {
     if (!_isTableArray)
         return(false);
+    if (_packedType!=STACK_PACKED_NONE)
+    {
+        _getPackedArray(array,(size_t)count);
+        return(true);
+    }
     bool retVal=true;
     size_t c=(size_t)count;
     if (c>_tableObjects.size())
@@ -163,6 +280,11 @@ bool CInterfaceStackTable::getDoubleArray(double* array,int count) const
 {
     if (!_isTableArray)
         return(false);
+    if (_packedType!=STACK_PACKED_NONE)
+    {
+        _getPackedArray(array,(size_t)count);
+        return(true);
+    }
     bool retVal=true;
     size_t c=(size_t)count;
     if (c>_tableObjects.size())
@@ -187,82 +309,99 @@ bool CInterfaceStackTable::getDoubleArray(double* array,int count) const
 
 bool CInterfaceStackTable::containsKey(const char* fieldName) const
 {
-    if (_isTableArray)
-        return(false);
-    for (size_t i=0;i<_tableObjects.size()/2;i++)
-    {
-        CInterfaceStackObject* key=_tableObjects[2*i+0];
-        if (key->getObjectType()==STACK_OBJECT_STRING)
-        {
-            std::string theKey(((CInterfaceStackString*)key)->getValue(0));
-            if (theKey.compare(fieldName)==0)
-                return(true);
-        }
-    }
-    return(false);
+    return(_getStringKeyPairIndex(fieldName,strlen(fieldName))>=0);
 }
 
 CInterfaceStackObject* CInterfaceStackTable::getMapObject(const char* fieldName) const
 {
     if (_isTableArray)
         return(nullptr);
-    size_t p=std::string(fieldName).find('.',0);
-    if (p==std::string::npos)
+    const char* p=strchr(fieldName,'.');
+    if (p==nullptr)
     {
-        for (size_t i=0;i<_tableObjects.size()/2;i++)
-        {
-            CInterfaceStackObject* key=_tableObjects[2*i+0];
-            CInterfaceStackObject* obj=_tableObjects[2*i+1];
-            if (key->getObjectType()==STACK_OBJECT_STRING)
-            {
-                std::string theKey(((CInterfaceStackString*)key)->getValue(0));
-                if (theKey.compare(fieldName)==0)
-                    return(obj);
-            }
-        }
+        long long int i=_getStringKeyPairIndex(fieldName,strlen(fieldName));
+        if (i>=0)
+            return(_tableObjects[2*i+1]);
     }
     else
     {
-        std::string tableName1(fieldName,fieldName+p);
-        std::string tableName2(fieldName+p+1);
-        for (size_t i=0;i<_tableObjects.size()/2;i++)
+        long long int i=_getStringKeyPairIndex(fieldName,size_t(p-fieldName));
+        if (i>=0)
         {
-            CInterfaceStackObject* key=_tableObjects[2*i+0];
             CInterfaceStackObject* otherMap=_tableObjects[2*i+1];
-            if ( (key->getObjectType()==STACK_OBJECT_STRING)&&(otherMap->getObjectType()==STACK_OBJECT_TABLE) )
+            if (otherMap->getObjectType()==STACK_OBJECT_TABLE)
             {
-                std::string theKey(((CInterfaceStackString*)key)->getValue(0));
                 CInterfaceStackTable* theTable=(CInterfaceStackTable*)otherMap;
                 if (!theTable->isTableArray())
-                {
-                    if (theKey.compare(tableName1)==0)
-                        return(theTable->getMapObject(tableName2.c_str()));
-                }
+                    return(theTable->getMapObject(p+1));
             }
         }
     }
     return(nullptr);
 }
 
-bool CInterfaceStackTable::removeFromKey(const char* keyToRemove)
-{
+long long int CInterfaceStackTable::_getStringKeyPairIndex(const char* key,size_t keyL) const
+{ // returns -1 if not found
     if (_isTableArray)
-        return(false);
-    for (size_t i=0;i<_tableObjects.size()/2;i++)
+        return(-1);
+    size_t cnt=_tableObjects.size()/2;
+    if (_keyIndex!=nullptr)
     {
-        CInterfaceStackObject* key=_tableObjects[2*i+0];
-        if (key->getObjectType()==STACK_OBJECT_STRING)
+        auto it=_keyIndex->find(std::string_view(key,keyL));
+        if (it!=_keyIndex->end())
+            return((long long int)it->second);
+        return(-1);
+    }
+    for (size_t i=0;i<cnt;i++)
+    {
+        CInterfaceStackObject* k=_tableObjects[2*i+0];
+        if (k->getObjectType()==STACK_OBJECT_STRING)
+        {
+            size_t l;
+            const char* c=((CInterfaceStackString*)k)->getValue(&l);
+            if ( (l==keyL)&&(memcmp(c,key,l)==0) )
+                return((long long int)i);
+        }
+    }
+    return(-1);
+}
+
+void CInterfaceStackTable::_rebuildKeyIndex()
+{ // call when pairs are removed or reordered. Appending maintains the index. The index is never built from a const
+  // method, so that concurrent readers are safe
+    delete _keyIndex;
+    _keyIndex=nullptr;
+    size_t cnt=_tableObjects.size()/2;
+    if ( (!_isTableArray)&&(cnt>=INTERFACESTACKTABLE_KEYINDEX_MIN_SIZE) )
+    { // keys are unique (see appendArrayOrMapObject), and point into the key objects, that are never modified
+        _keyIndex=new std::unordered_map<std::string_view,size_t>();
+        _keyIndex->reserve(cnt);
+        for (size_t i=0;i<cnt;i++)
         {
-            std::string theKey(((CInterfaceStackString*)key)->getValue(0));
-            if (theKey.compare(keyToRemove)==0)
+            CInterfaceStackObject* k=_tableObjects[2*i+0];
+            if (k->getObjectType()==STACK_OBJECT_STRING)
             {
-                delete key;
-                delete _tableObjects[2*i+1];
-                _tableObjects.erase(_tableObjects.begin()+2*i,_tableObjects.begin()+2*i+2);
-                return(true);
+                size_t l;
+                const char* c=((CInterfaceStackString*)k)->getValue(&l);
+                (*_keyIndex)[std::string_view(c,l)]=i;
             }
         }
     }
+}
+
+bool CInterfaceStackTable::removeFromKey(const char* keyToRemove)
+{
+    if (_isTableArray)
+        return(false);
+    long long int i=_getStringKeyPairIndex(keyToRemove,strlen(keyToRemove));
+    if (i>=0)
+    {
+        delete _tableObjects[2*i+0];
+        delete _tableObjects[2*i+1];
+        _tableObjects.erase(_tableObjects.begin()+2*i,_tableObjects.begin()+2*i+2);
+        _rebuildKeyIndex();
+        return(true);
+    }
     return(false);
 }
 
@@ -270,22 +409,25 @@ bool CInterfaceStackTable::removeFromKey(const CInterfaceStackObject* keyToRemov
 {
     if (_isTableArray)
         return(false);
+    if (keyToRemove->getObjectType()==STACK_OBJECT_STRING)
+    {
+        size_t l;
+        const char* c=((CInterfaceStackString*)keyToRemove)->getValue(&l);
+        long long int i=_getStringKeyPairIndex(c,l);
+        if (i>=0)
+        {
+            delete _tableObjects[2*i+0];
+            delete _tableObjects[2*i+1];
+            _tableObjects.erase(_tableObjects.begin()+2*i,_tableObjects.begin()+2*i+2);
+            _rebuildKeyIndex();
+            return(true);
+        }
+        return(false);
+    }
     for (size_t i=0;i<_tableObjects.size()/2;i++)
     {
         CInterfaceStackObject* key=_tableObjects[2*i+0];
         CInterfaceStackObject* obj=_tableObjects[2*i+1];
-        if ( (key->getObjectType()==STACK_OBJECT_STRING)&&(keyToRemove->getObjectType()==STACK_OBJECT_STRING) )
-        {
-            std::string theKey1(((CInterfaceStackString*)key)->getValue(0));
-            std::string theKey2(((CInterfaceStackString*)keyToRemove)->getValue(0));
-            if (theKey1.compare(theKey2)==0)
-            {
-                delete key;
-                delete obj;
-                _tableObjects.erase(_tableObjects.begin()+2*i,_tableObjects.begin()+2*i+2);
-                return(true);
-            }
-        }
         if ( (key->getObjectType()==STACK_OBJECT_NUMBER)&&(keyToRemove->getObjectType()==STACK_OBJECT_NUMBER) )
         {
             double theKey1(((CInterfaceStackNumber*)key)->getValue());
@@ -295,6 +437,7 @@ bool CInterfaceStackTable::removeFromKey(const CInterfaceStackObject* keyToRemov
                 delete key;
                 delete obj;
                 _tableObjects.erase(_tableObjects.begin()+2*i,_tableObjects.begin()+2*i+2);
+                _rebuildKeyIndex();
                 return(true);
             }
         }
@@ -307,6 +450,7 @@ bool CInterfaceStackTable::removeFromKey(const CInterfaceStackObject* keyToRemov
                 delete key;
                 delete obj;
                 _tableObjects.erase(_tableObjects.begin()+2*i,_tableObjects.begin()+2*i+2);
+                _rebuildKeyIndex();
                 return(true);
             }
         }
@@ -319,6 +463,7 @@ bool CInterfaceStackTable::removeFromKey(const CInterfaceStackObject* keyToRemov
                 delete key;
                 delete obj;
                 _tableObjects.erase(_tableObjects.begin()+2*i,_tableObjects.begin()+2*i+2);
+                _rebuildKeyIndex();
                 return(true);
             }
         }
@@ -328,6 +473,7 @@ bool CInterfaceStackTable::removeFromKey(const CInterfaceStackObject* keyToRemov
 
 void CInterfaceStackTable::appendArrayObject(CInterfaceStackObject* obj)
 {
+    _expandPacked();
     long long int index;
     if (_isTableArray)
         _tableObjects.push_back(obj);
@@ -340,6 +486,7 @@ void CInterfaceStackTable::appendArrayObject(CInterfaceStackObject* obj)
 
 void CInterfaceStackTable::insertArrayObject(CInterfaceStackObject* obj,size_t pos)
 {
+    _expandPacked();
     if (_isTableArray)
         _tableObjects.insert(_tableObjects.begin()+pos,obj);
 }
@@ -368,6 +515,7 @@ void CInterfaceStackTable::appendArrayOrMapObject(CInterfaceStackObject* key,CIn
 {   // here we basically treat this table as an array, until the key is:
     // 1) not a number, 2) not consecutive, 3) does not start at 1.
     // In that case, we then convert that table from array to map representation
+    _expandPacked();
     bool valueInserted=false;
     if (_isTableArray)
     {
@@ -403,6 +551,14 @@ void CInterfaceStackTable::appendArrayOrMapObject(CInterfaceStackObject* key,CIn
         removeFromKey(key); // first remove a possibly existing object with the same key
         _tableObjects.push_back(key);
         _tableObjects.push_back(obj);
+        if ( (_keyIndex==nullptr)&&(_tableObjects.size()/2>=INTERFACESTACKTABLE_KEYINDEX_MIN_SIZE) )
+            _rebuildKeyIndex();
+        else if ( (_keyIndex!=nullptr)&&(key->getObjectType()==STACK_OBJECT_STRING) )
+        {
+            size_t l;
+            const char* c=((CInterfaceStackString*)key)->getValue(&l);
+            (*_keyIndex)[std::string_view(c,l)]=_tableObjects.size()/2-1;
+        }
     }
 }
 
@@ -543,12 +699,15 @@ void CInterfaceStackTable::appendMapObject_stringObject(const char* key,CInterfa
 
 void CInterfaceStackTable::removeArrayItemAtIndex(size_t ind)
 {
+    _expandPacked();
     delete _tableObjects[ind];
     _tableObjects.erase(_tableObjects.begin()+ind);
+    _rebuildKeyIndex();
 }
 
-CInterfaceStackObject* CInterfaceStackTable::getArrayItemAtIndex(size_t ind) const
+CInterfaceStackObject* CInterfaceStackTable::getArrayItemAtIndex(size_t ind)
 {
+    _expandPacked();
     if ( (!_isTableArray)||(ind>=_tableObjects.size()) )
         return(nullptr);
     return(_tableObjects[ind]);
@@ -590,57 +749,48 @@ CInterfaceStackObject* CInterfaceStackTable::copyYourself() const
     CInterfaceStackTable* retVal=new CInterfaceStackTable();
     for (size_t i=0;i<_tableObjects.size();i++)
         retVal->_tableObjects.push_back(_tableObjects[i]->copyYourself());
+    retVal->_packedType=_packedType;
+    retVal->_packedCnt=_packedCnt;
+    retVal->_packedData=_packedData;
     retVal->_isTableArray=_isTableArray;
     retVal->_isCircularRef=_isCircularRef;
+    retVal->_rebuildKeyIndex();
     return(retVal);
 }
 
 void CInterfaceStackTable::getAllObjectsAndClearTable(std::vector<CInterfaceStackObject*>& allObjs)
 {
+    _expandPacked();
     allObjs.clear();
     allObjs.assign(_tableObjects.begin(),_tableObjects.end());
     _tableObjects.clear();
     _isTableArray=true;
+    _rebuildKeyIndex();
 }
 
 void CInterfaceStackTable::setUCharArray(const unsigned char* array,size_t l)
 {
-    _tableObjects.clear();
-    _isTableArray=true;
-    for (size_t i=0;i<l;i++)
-        _tableObjects.push_back(new CInterfaceStackInteger(array[i]));
+    _setPackedArray(STACK_PACKED_UCHAR,array,l,sizeof(unsigned char));
 }
 
 void CInterfaceStackTable::setInt32Array(const int* array,size_t l)
 {
-    _tableObjects.clear();
-    _isTableArray=true;
-    for (size_t i=0;i<l;i++)
-        _tableObjects.push_back(new CInterfaceStackInteger(array[i]));
+    _setPackedArray(STACK_PACKED_INT32,array,l,sizeof(int));
 }
 
 void CInterfaceStackTable::setInt64Array(const long long int* array,size_t l)
 {
-    _tableObjects.clear();
-    _isTableArray=true;
-    for (size_t i=0;i<l;i++)
-        _tableObjects.push_back(new CInterfaceStackInteger(array[i]));
+    _setPackedArray(STACK_PACKED_INT64,array,l,sizeof(long long int));
 }
 
 void CInterfaceStackTable::setFloatArray(const float* array,size_t l)
 {
-    _tableObjects.clear();
-    _isTableArray=true;
-    for (size_t i=0;i<l;i++)
-        _tableObjects.push_back(new CInterfaceStackNumber((double)array[i]));
+    _setPackedArray(STACK_PACKED_FLOAT,array,l,sizeof(float));
 }
 
 void CInterfaceStackTable::setDoubleArray(const double* array,size_t l)
 {
-    _tableObjects.clear();
-    _isTableArray=true;
-    for (size_t i=0;i<l;i++)
-        _tableObjects.push_back(new CInterfaceStackNumber(array[i]));
+    _setPackedArray(STACK_PACKED_DOUBLE,array,l,sizeof(double));
 }
 
 int CInterfaceStackTable::getTableInfo(int infoType) const
@@ -669,6 +819,15 @@ int CInterfaceStackTable::getTableInfo(int infoType) const
 
 bool CInterfaceStackTable::_areAllValueThis(int what,bool integerAndDoubleTolerant) const
 {
+    if (_packedType!=STACK_PACKED_NONE)
+    {
+        int itemType=STACK_OBJECT_INTEGER;
+        if ( (_packedType==STACK_PACKED_FLOAT)||(_packedType==STACK_PACKED_DOUBLE) )
+            itemType=STACK_OBJECT_NUMBER;
+        if ( integerAndDoubleTolerant&&((what==STACK_OBJECT_NUMBER)||(what==STACK_OBJECT_INTEGER)) )
+            return(true);
+        return(what==itemType);
+    }
     if (_tableObjects.size()==0)
         return(true);
     if (_isTableArray)
@@ -708,6 +867,14 @@ bool CInterfaceStackTable::_areAllValueThis(int what,bool integerAndDoubleTolera
 
 void CInterfaceStackTable::printContent(int spaces,std::string& buffer) const
 {
+    if (_packedType!=STACK_PACKED_NONE)
+    { // print an expanded copy, this table stays packed
+        CInterfaceStackTable* expanded=(CInterfaceStackTable*)copyYourself();
+        expanded->_expandPacked();
+        expanded->printContent(spaces,buffer);
+        delete expanded;
+        return;
+    }
     for (int i=0;i<spaces;i++)
         buffer+=" ";
     if (_isCircularRef)
@@ -752,22 +919,31 @@ std::string CInterfaceStackTable::getObjectData() const
             retVal=char(0);
     }
     unsigned int l=(unsigned int)_tableObjects.size();
+    if (_packedType!=STACK_PACKED_NONE)
+        l=(unsigned int)_packedCnt;
     char* tmp=(char*)(&l);
     for (size_t i=0;i<sizeof(l);i++)
         retVal.push_back(tmp[i]);
     if (_isTableArray)
     {
-        for (size_t i=0;i<_tableObjects.size();i++)
+        for (size_t i=0;i<l;i++)
         {
+            const CInterfaceStackObject* item;
+            if (_packedType!=STACK_PACKED_NONE)
+                item=_createPackedItem(i); // same data as the expanded table, without expanding it
+            else
+                item=_tableObjects[i];
 #ifdef LUA_STACK_COMPATIBILITY_MODE
-            if (_tableObjects[i]->getObjectType()==STACK_OBJECT_INTEGER)
+            if (item->getObjectType()==STACK_OBJECT_INTEGER)
                 retVal.push_back((char)STACK_OBJECT_NUMBER);
             else
-                retVal.push_back((char)_tableObjects[i]->getObjectType());
+                retVal.push_back((char)item->getObjectType());
 #else
-            retVal.push_back((char)_tableObjects[i]->getObjectType());
+            retVal.push_back((char)item->getObjectType());
 #endif
-            retVal+=_tableObjects[i]->getObjectData();
+            retVal+=item->getObjectData();
+            if (_packedType!=STACK_PACKED_NONE)
+                delete item;
         }
     }
     else
@@ -900,6 +1076,29 @@ std::string CInterfaceStackTable::getObjectData() const
 
 void CInterfaceStackTable::addCborObjectData(CCbor* cborObj) const
 {
+    if (_packedType!=STACK_PACKED_NONE)
+    { // typed array, without expanding
+        const unsigned char* d=_packedData.data();
+        if (_packedType==STACK_PACKED_FLOAT)
+            cborObj->appendFloatArray((const float*)d,_packedCnt);
+        else if (_packedType==STACK_PACKED_DOUBLE)
+            cborObj->appendDoubleArray((const double*)d,_packedCnt);
+        else
+        { // integers use the shortest encoding, as for CInterfaceStackInteger
+            cborObj->appendArray(_packedCnt);
+            for (size_t i=0;i<_packedCnt;i++)
+            {
+                if (_packedType==STACK_PACKED_UCHAR)
+                    cborObj->appendInt(d[i]);
+                else if (_packedType==STACK_PACKED_INT32)
+                    cborObj->appendInt(((const int*)d)[i]);
+                else
+                    cborObj->appendInt(((const long long int*)d)[i]);
+            }
+            cborObj->appendBreakIfApplicable();
+        }
+        return;
+    }
     if (_isCircularRef)
         cborObj->appendMap(0);
     else
@@ -997,6 +1196,10 @@ void CInterfaceStackTable::addCborObjectData(CCbor* cborObj) const
 unsigned int CInterfaceStackTable::createFromData(const char* data)
 {
     unsigned int retVal=0;
+    _rebuildKeyIndex();
+    _packedType=STACK_PACKED_NONE;
+    _packedCnt=0;
+    _packedData.clear();
     _isTableArray=((data[retVal]&1)!=0);
     _isCircularRef=((data[retVal]&2)!=0);
     retVal++;
@@ -1012,6 +1215,7 @@ unsigned int CInterfaceStackTable::createFromData(const char* data)
         _tableObjects.push_back(obj);
         retVal+=r;
     }
+    _rebuildKeyIndex();
     return(retVal);
 }
 
@@ -1049,3 +1253,36 @@ bool CInterfaceStackTable::checkCreateFromData(const char* data,unsigned int& w,
     }
     return(true);
 }
+
+void CInterfaceStackTable::benchmarkMapLookups(size_t keyCnt,size_t lookups,double& indexedMs,double& scannedMs)
+{ // getMapObject on a map table with keyCnt string keys, with the key index (if the table is large enough to get one)
+  // and with a linear scan
+    CInterfaceStackTable* table=new CInterfaceStackTable();
+    std::vector<std::string> keys;
+    for (size_t i=0;i<keyCnt;i++)
+    {
+        keys.push_back("key"+std::to_string(i));
+        table->appendMapObject_stringInt32(keys[i].c_str(),int(i));
+    }
+    size_t found=0;
+    for (size_t pass=0;pass<2;pass++)
+    {
+        if (pass==1)
+        { // drop the index
+            delete table->_keyIndex;
+            table->_keyIndex=nullptr;
+        }
+        auto start=std::chrono::steady_clock::now();
+        for (size_t i=0;i<lookups;i++)
+        {
+            if (table->getMapObject(keys[(i*7919)%keyCnt].c_str())!=nullptr)
+                found++;
+        }
+        double ms=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+        if (pass==0)
+            indexedMs=ms;
+        else
+            scannedMs=ms;
+    }
+    delete table;
+}
@@ -2,6 +2,18 @@
 
 #include <interfaceStackObject.h>
 #include <vector>
+#include <unordered_map>
+#include <string_view>
+
+#define INTERFACESTACKTABLE_KEYINDEX_MIN_SIZE 16 // map tables with fewer entries are simply scanned
+
+enum {  STACK_PACKED_NONE=0,
+        STACK_PACKED_UCHAR,
+        STACK_PACKED_INT32,
+        STACK_PACKED_INT64,
+        STACK_PACKED_FLOAT,
+        STACK_PACKED_DOUBLE
+};
 
 class CInterfaceStackTable : public CInterfaceStackObject
 {
@@ -22,8 +34,10 @@ public:
     size_t getMapEntryCount() const;
     bool isCircularRef() const;
     void setCircularRef();
+    int getPackedType() const;
+    const void* getPackedData() const;
 
-    CInterfaceStackObject* getArrayItemAtIndex(size_t ind) const;
+    CInterfaceStackObject* getArrayItemAtIndex(size_t ind);
     CInterfaceStackObject* getMapItemAtIndex(size_t ind,std::string& stringKey,double& numberKey,long long int& integerKey,bool& boolKey,int& keyType) const;
     void removeArrayItemAtIndex(size_t ind);
     void getAllObjectsAndClearTable(std::vector<CInterfaceStackObject*>& allObjs);
@@ -81,10 +95,24 @@ public:
 
     int getTableInfo(int infoType) const;
 
+    static void benchmarkMapLookups(size_t keyCnt,size_t lookups,double& indexedMs,double& scannedMs);
+
 protected:
     bool _areAllValueThis(int what,bool integerAndDoubleTolerant) const;
+    long long int _getStringKeyPairIndex(const char* key,size_t keyL) const;
+    void _rebuildKeyIndex();
+    void _setPackedArray(int packedType,const void* array,size_t l,size_t itemSize);
+    void _expandPacked();
+    CInterfaceStackObject* _createPackedItem(size_t ind) const;
+    template<class T> void _getPackedArray(T* array,size_t count) const;
 
+    // Numeric arrays set via set*Array are kept packed in _packedData (_tableObjects is then empty), and only
+    // expanded into individual objects when an item or a structural change is needed (from non-const methods only):
     std::vector<CInterfaceStackObject*> _tableObjects;
+    std::vector<unsigned char> _packedData;
+    int _packedType;
+    size_t _packedCnt;
+    std::unordered_map<std::string_view,size_t>* _keyIndex; // string key --> pair index, maintained on mutation for large maps
     bool _isTableArray;
     bool _isCircularRef;
 };
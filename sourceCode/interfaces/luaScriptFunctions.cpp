@@ -12,6 +12,9 @@
 #include <app.h>
 #include <apiErrors.h>
 #include <interfaceStack.h>
+#include <interfaceStackString.h>
+#include <interfaceStackInteger.h>
+#include <interfaceStackNumber.h>
 #include <fileOperations.h>
 #include <ttUtil.h>
 #include <imgLoaderSaver.h>
@@ -20,29 +23,52 @@
 #include <distanceRoutines.h>
 #include <cbor.h>
 #include <meshRoutines.h>
-
+#include <luaBytecodeCache.h>
+#include <luaStatePool.h>
+#include <scriptProfiler.h>
+#include <luaBuffer.h>
+#include <scriptIsolation.h>
+#include <chrono>
+
+// funcName must be a string literal (or outlive the call). errorString and warningString stay empty
+// (i.e. do not allocate) in the usual case where nothing is reported
 #define LUA_START(funcName) \
     CApiErrors::clearThreadBasedFirstCapiErrorAndWarning_old(); \
-    std::string functionName(funcName); \
+    const char* functionName=funcName; \
+    CScriptProfilerApiCall profilerApiCall(L,functionName); \
     std::string errorString; \
     std::string warningString; \
-    bool cSideErrorOrWarningReporting=true;
+    bool cSideErrorOrWarningReporting=true; \
+    LUA_CHECK_ISOLATION()
 
 #define LUA_START_NO_CSIDE_ERROR(funcName) \
     CApiErrors::clearThreadBasedFirstCapiErrorAndWarning_old(); \
-    std::string functionName(funcName); \
+    const char* functionName=funcName; \
+    CScriptProfilerApiCall profilerApiCall(L,functionName); \
     std::string errorString; \
     std::string warningString; \
-    bool cSideErrorOrWarningReporting=false;
+    bool cSideErrorOrWarningReporting=false; \
+    LUA_CHECK_ISOLATION()
+
+// Isolated scripts (see CScriptIsolation) may only call reading functions. Writing functions are buffered:
+#define LUA_CHECK_ISOLATION() \
+    if (CScriptIsolation::isRunningIsolated()) \
+    { \
+        int isolationRes=CScriptIsolation::handleApiCall(L,functionName); \
+        if (isolationRes>=0) \
+            LUA_END(isolationRes); \
+    }
 
 #define LUA_END(p) \
     do { \
-        _reportWarningsIfNeeded(L,functionName.c_str(),warningString.c_str(),cSideErrorOrWarningReporting); \
+        _reportWarningsIfNeeded(L,functionName,warningString,cSideErrorOrWarningReporting); \
         return(p); \
     } while(0)
 
-void _reportWarningsIfNeeded(luaWrap_lua_State* L,const char* functionName,const char* warningString,bool cSideErrorOrWarningReporting)
+void _reportWarningsIfNeeded(luaWrap_lua_State* L,const char* functionName,const std::string& warningString,bool cSideErrorOrWarningReporting)
 {
+    if ( (warningString.size()==0)&&(!cSideErrorOrWarningReporting) )
+        return;
     std::string warnStr(warningString);
     if ( (warnStr.size()==0)&&cSideErrorOrWarningReporting )
         warnStr=CApiErrors::getAndClearThreadBasedFirstCapiWarning_old(); // without old threads, use CApiErrors::getAndClearLastWarningOrError
@@ -60,13 +86,18 @@ void _reportWarningsIfNeeded(luaWrap_lua_State* L,const char* functionName,const
             msg+=functionName;
             msg+="' ";
             msg+=warnStr;
-            App::logScriptMsg(it->getShortDescriptiveName().c_str(),verb,msg.c_str());
+            if (CScriptIsolation::isRunningIsolated())
+                CScriptIsolation::deferLog(verb,msg.c_str());
+            else
+                App::logScriptMsg(it->getShortDescriptiveName().c_str(),verb,msg.c_str());
         }
     }
 }
 
-void _raiseErrorIfNeeded(luaWrap_lua_State* L,const char* functionName,const char* errorString,bool cSideErrorOrWarningReporting)
+void _raiseErrorIfNeeded(luaWrap_lua_State* L,const char* functionName,const std::string& errorString,bool cSideErrorOrWarningReporting)
 {
+    if ( (errorString.size()==0)&&(!cSideErrorOrWarningReporting) )
+        return;
     std::string errStr(errorString);
     if ( (errStr.size()==0)&&cSideErrorOrWarningReporting )
         errStr=CApiErrors::getAndClearThreadBasedFirstCapiError_old(); // without old threads, use CApiErrors::getAndClearLastWarningOrError
@@ -92,7 +123,7 @@ void _raiseErrorIfNeeded(luaWrap_lua_State* L,const char* functionName,const cha
     luaWrap_lua_error(L); // does a long jump and never returns
 }
 
-#define LUA_RAISE_ERROR_OR_YIELD_IF_NEEDED() _raiseErrorIfNeeded(L,functionName.c_str(),errorString.c_str(),cSideErrorOrWarningReporting)
+#define LUA_RAISE_ERROR_OR_YIELD_IF_NEEDED() _raiseErrorIfNeeded(L,functionName,errorString,cSideErrorOrWarningReporting)
 
 
 const SLuaCommands simLuaCommands[]=
@@ -150,6 +181,8 @@ const SLuaCommands simLuaCommands[]=
     {"sim.setObjectMatrix",_simSetObjectMatrix,                  "sim.setObjectMatrix(int objectHandle,int relativeToObjectHandle,float[12] matrix)",true},
     {"sim.getObjectPose",_simGetObjectPose,                      "float[7] pose=sim.getObjectPose(int objectHandle,int relativeToObjectHandle)",true},
     {"sim.setObjectPose",_simSetObjectPose,                      "sim.setObjectPose(int objectHandle,int relativeToObjectHandle,float[7] pose)",true},
+    {"sim.getObjectPoses",_simGetObjectPoses,                    "float[] poses=sim.getObjectPoses(int[] objectHandles,int relativeToObjectHandle)",true},
+    {"sim.setObjectPoses",_simSetObjectPoses,                    "sim.setObjectPoses(int[] objectHandles,int relativeToObjectHandle,float[] poses)",true},
     {"sim.getObjectChildPose",_simGetObjectChildPose,            "float[7] pose=sim.getObjectChildPose(int objectHandle)",true},
     {"sim.setObjectChildPose",_simSetObjectChildPose,            "sim.setObjectChildPose(int objectHandle,float[7] pose)",true},
     {"sim.buildIdentityMatrix",_simBuildIdentityMatrix,          "float[12] matrix=sim.buildIdentityMatrix()",true},
@@ -220,6 +253,7 @@ const SLuaCommands simLuaCommands[]=
     {"sim.packUInt16Table",_simPackUInt16Table,                  "buffer data=sim.packUInt16Table(int[] uint16Numbers,int startUint16Index=0,int uint16Count=0)",true},
     {"sim.unpackInt32Table",_simUnpackInt32Table,                "int[] int32Numbers=sim.unpackInt32Table(buffer data,int startInt32Index=0,int int32Count=0,int additionalByteOffset=0)",true},
     {"sim.unpackUInt32Table",_simUnpackUInt32Table,              "int[] uint32Numbers=sim.unpackUInt32Table(buffer data,int startUint32Index=0,int uint32Count=0,int additionalByteOffset=0)",true},
+    {"sim.createBuffer",CLuaBuffer::createBuffer,                "buffer buf=sim.createBuffer(int elementCount/string data,string type='uint8')",true},
     {"sim.unpackFloatTable",_simUnpackFloatTable,                "float[] floatNumbers=sim.unpackFloatTable(buffer data,int startFloatIndex=0,int floatCount=0,int additionalByteOffset=0)",true},
     {"sim.unpackDoubleTable",_simUnpackDoubleTable,              "float[] doubleNumbers=sim.unpackDoubleTable(buffer data,int startDoubleIndex=0,int doubleCount=0,int additionalByteOffset=0)",true},
     {"sim.unpackUInt8Table",_simUnpackUInt8Table,                "int[] uint8Numbers=sim.unpackUInt8Table(buffer data,int startUint8Index=0,int uint8count=0)",true},
@@ -286,7 +320,7 @@ const SLuaCommands simLuaCommands[]=
     {"sim.importMesh",_simImportMesh,                            "float[1..*] vertices,int[1..*] indices=sim.importMesh(int fileformat,string pathAndFilename,int options,float identicalVerticeTolerance,float scalingFactor)",true},
     {"sim.exportMesh",_simExportMesh,                            "sim.exportMesh(int fileformat,string pathAndFilename,int options,float scalingFactor,float[1..*] vertices,int[1..*] indices)",true},
     {"sim.createMeshShape",_simCreateMeshShape,                  "int shapeHandle=sim.createMeshShape(int options,float shadingAngle,float[] vertices,int[] indices)",true},
-    {"sim.getShapeMesh",_simGetShapeMesh,                        "float[] vertices,int[] indices,float[] normals=sim.getShapeMesh(int shapeHandle)",true},
+    {"sim.getShapeMesh",_simGetShapeMesh,                        "float[] vertices,int[] indices,float[] normals=sim.getShapeMesh(int shapeHandle,int options=0)",true},
     {"sim.createPrimitiveShape",_simCreatePrimitiveShape,        "int shapeHandle=sim.createPrimitiveShape(int primitiveType,float[3] sizes,int options=0)",true},
     {"sim.createHeightfieldShape",_simCreateHeightfieldShape,    "int shapeHandle=sim.createHeightfieldShape(int options,float shadingAngle,int xPointCount,int yPointCount,float xSize,float[] heights)",true},
     {"sim.createJoint",_simCreateJoint,                          "int jointHandle=sim.createJoint(int jointType,int jointMode,int options,float[2] sizes=nil)",true},
@@ -382,7 +416,7 @@ const SLuaCommands simLuaCommands[]=
     {"sim.removePointsFromPointCloud",_simRemovePointsFromPointCloud,"int totalPointCnt=sim.removePointsFromPointCloud(int pointCloudHandle,int options,float[] points,float tolerance)",true},
     {"sim.intersectPointsWithPointCloud",_simIntersectPointsWithPointCloud,"int totalPointCnt=sim.intersectPointsWithPointCloud(int pointCloudHandle,int options,float[] points,float tolerance)",true},
     {"sim.getOctreeVoxels",_simGetOctreeVoxels,                  "float[] voxels=sim.getOctreeVoxels(int octreeHandle)",true},
-    {"sim.getPointCloudPoints",_simGetPointCloudPoints,          "float[] points=sim.getPointCloudPoints(int pointCloudHandle)",true},
+    {"sim.getPointCloudPoints",_simGetPointCloudPoints,          "float[] points=sim.getPointCloudPoints(int pointCloudHandle,int options=0)",true},
     {"sim.insertObjectIntoOctree",_simInsertObjectIntoOctree,    "int totalVoxelCnt=sim.insertObjectIntoOctree(int octreeHandle,int objectHandle,int options,float[] color=nil,int tag=0)",true},
     {"sim.subtractObjectFromOctree",_simSubtractObjectFromOctree,    "int totalVoxelCnt=sim.subtractObjectFromOctree(int octreeHandle,int objectHandle,int options)",true},
     {"sim.insertObjectIntoPointCloud",_simInsertObjectIntoPointCloud,"int totalPointCnt=sim.insertObjectIntoPointCloud(int pointCloudHandle,int objectHandle,int options,float gridSize,float[] color=nil,float duplicateTolerance=nil)",true},
@@ -405,6 +439,7 @@ const SLuaCommands simLuaCommands[]=
     {"sim.isDeprecated",_simIsDeprecated,                        "int result=sim.isDeprecated(string funcOrConst)",true},
     {"sim.getPersistentDataTags",_simGetPersistentDataTags,      "string[] tags=sim.getPersistentDataTags()",true},
     {"sim.getRandom",_simGetRandom,                              "float randomNumber=sim.getRandom(int seed=nil)",true},
+    {"sim.setScriptIsolated",_simSetScriptIsolated,              "sim.setScriptIsolated(bool isolated)",true},
     {"sim.textEditorOpen",_simTextEditorOpen,                    "int handle=sim.textEditorOpen(string initText,string properties)",true},
     {"sim.textEditorClose",_simTextEditorClose,                  "string text,int[2] pos,int[2] size=sim.textEditorClose(int handle)",true},
     {"sim.textEditorShow",_simTextEditorShow,                    "sim.textEditorShow(int handle,bool showState)",true},
@@ -423,6 +458,7 @@ const SLuaCommands simLuaCommands[]=
     {"sim.initScript",_simInitScript,                            "bool result=sim.initScript(int scriptHandle)",true},
     {"sim.moduleEntry",_simModuleEntry,                          "int handle=sim.moduleEntry(int handle,string label=nil,int state=-1)",true},
     {"sim.pushUserEvent",_simPushUserEvent,                      "sim.pushUserEvent(string event,int handle,int uid,map eventData,int options=0)",true},
+    {"sim.setEventFilters",_simSetEventFilters,                  "sim.setEventFilters(map filters=nil)",true},
     {"sim.createCollectionEx",_simCreateCollectionEx,            "",false}, // implemented in sim.lua
     {"sim.getGenesisEvents",_simGetGenesisEvents,                "map[] events=sim.getGenesisEvents()\nbuffer events=sim.getGenesisEvents()",true},
     {"sim.broadcastMsg",_simBroadcastMsg,                        "sim.broadcastMsg(map message,int options=0)",true},
@@ -2362,21 +2398,23 @@ int _simGenericFunctionHandler(luaWrap_lua_State* L)
 
 //    it->printInterpreterStack();
 
+    std::string pluginFunctionName;
     int outputArgCount=0;
     for (size_t j=0;j<App::worldContainer->scriptCustomFuncAndVarContainer->getCustomFunctionCount();j++)
     { // we now search for the callback to call:
         CScriptCustomFunction* it=App::worldContainer->scriptCustomFuncAndVarContainer->getCustomFunctionFromIndex(j);
         if (it->getFunctionID()==id)
         { // we have the right one! Now we need to prepare the input and output argument arrays:
-            functionName=it->getFunctionName();
-            App::logMsg(sim_verbosity_debug,(std::string("sim.genericFunctionHandler: ")+functionName).c_str());
+            pluginFunctionName=it->getFunctionName();
+            App::logMsg(sim_verbosity_debug,(std::string("sim.genericFunctionHandler: ")+pluginFunctionName).c_str());
             if (it->getPluginName().size()!=0)
             {
-                functionName+="@simExt";
-                functionName+=it->getPluginName();
+                pluginFunctionName+="@simExt";
+                pluginFunctionName+=it->getPluginName();
             }
             else
-                functionName+="@plugin";
+                pluginFunctionName+="@plugin";
+            functionName=pluginFunctionName.c_str();
 
             if (it->getUsesStackToExchangeData())
                 outputArgCount=_genericFunctionHandler(L,it,errorString);
@@ -2702,8 +2740,13 @@ int _simGetVisionSensorImg(luaWrap_lua_State* L)
                                 size[0]=resolution[0];
                             if (size[1]==0)
                                 size[1]=resolution[1];
-                            luaWrap_lua_pushlstring(L,(const char*)img,s*size[0]*size[1]);
-                            delete[] ((char*)img);
+                            if ((options&8)!=0)
+                                CLuaBuffer::pushBuffer(L,img,s*size[0]*size[1],LUABUFFER_TYPE_UINT8); // no copy: the buffer takes ownership
+                            else
+                            {
+                                luaWrap_lua_pushlstring(L,(const char*)img,s*size[0]*size[1]);
+                                delete[] ((char*)img);
+                            }
                             pushIntTableOntoStack(L,2,resolution);
                             LUA_END(2);
                         }
@@ -2733,10 +2776,10 @@ int _simSetVisionSensorImg(luaWrap_lua_State* L)
             { // ok we have a valid vision sensor
                 int resolution[2];
                 ((CVisionSensor*)it)->getResolution(resolution);
-                if (luaWrap_lua_isstring(L,2))
+                size_t l;
+                unsigned char* img=(unsigned char*)CLuaBuffer::getData(L,2,&l); // string or buffer
+                if (img!=nullptr)
                 {
-                    size_t l;
-                    unsigned char* img=(unsigned char*)luaWrap_lua_tolstring(L,2,&l);
 
 
                     int options=0;
@@ -2821,8 +2864,13 @@ int _simGetVisionSensorDepth(luaWrap_lua_State* L)
                             size[0]=resolution[0];
                         if (size[1]==0)
                             size[1]=resolution[1];
-                        luaWrap_lua_pushlstring(L,(const char*)depth,size[0]*size[1]*sizeof(float));
-                        delete[] ((char*)depth);
+                        if ((options&8)!=0)
+                            CLuaBuffer::pushBuffer(L,depth,size[0]*size[1]*sizeof(float),LUABUFFER_TYPE_FLOAT); // no copy: the buffer takes ownership
+                        else
+                        {
+                            luaWrap_lua_pushlstring(L,(const char*)depth,size[0]*size[1]*sizeof(float));
+                            delete[] ((char*)depth);
+                        }
                         pushIntTableOntoStack(L,2,resolution);
                         LUA_END(2);
                     }
@@ -4078,6 +4126,52 @@ int _simSetObjectPose(luaWrap_lua_State* L)
     LUA_END(1);
 }
 
+int _simGetObjectPoses(luaWrap_lua_State* L)
+{ // poses are returned in a flat table, 7 values per object
+    TRACE_LUA_API;
+    LUA_START("sim.getObjectPoses");
+
+    if (checkInputArguments(L,&errorString,lua_arg_number,-1,lua_arg_number,0))
+    {
+        int cnt=int(luaWrap_lua_rawlen(L,1));
+        std::vector<int> handles(cnt+1);
+        std::vector<double> poses(7*cnt+1);
+        getIntsFromTable(L,1,cnt,&handles[0]);
+        if (simGetObjectPoses_internal(&handles[0],cnt,luaToInt(L,2),&poses[0])>=0)
+        {
+            pushDoubleTableOntoStack(L,7*cnt,&poses[0]); // Success
+            LUA_END(1);
+        }
+    }
+
+    LUA_RAISE_ERROR_OR_YIELD_IF_NEEDED(); // we might never return from this!
+    LUA_END(0);
+}
+
+int _simSetObjectPoses(luaWrap_lua_State* L)
+{ // poses are provided in a flat table, 7 values per object
+    TRACE_LUA_API;
+    LUA_START("sim.setObjectPoses");
+
+    if (checkInputArguments(L,&errorString,lua_arg_number,-1,lua_arg_number,0,lua_arg_number,-1))
+    {
+        int cnt=int(luaWrap_lua_rawlen(L,1));
+        if (int(luaWrap_lua_rawlen(L,3))>=7*cnt)
+        {
+            std::vector<int> handles(cnt+1);
+            std::vector<double> poses(7*cnt+1);
+            getIntsFromTable(L,1,cnt,&handles[0]);
+            getDoublesFromTable(L,3,7*cnt,&poses[0]);
+            simSetObjectPoses_internal(&handles[0],cnt,luaToInt(L,2),&poses[0]);
+        }
+        else
+            errorString=SIM_ERROR_ONE_TABLE_SIZE_IS_WRONG;
+    }
+
+    LUA_RAISE_ERROR_OR_YIELD_IF_NEEDED(); // we might never return from this!
+    LUA_END(0);
+}
+
 int _simGetObjectChildPose(luaWrap_lua_State* L)
 {
     TRACE_LUA_API;
@@ -5333,6 +5427,364 @@ int _simTest(luaWrap_lua_State* L)
             App::worldContainer->setMergeEvents(luaToBool(L,2));
             LUA_END(0);
         }
+        if (cmd.compare("sim.cborEventStream")==0)
+        {
+            if (App::worldContainer->setCborEventStream(luaToBool(L,2)))
+                LUA_END(0);
+            errorString=SIM_ERROR_EVENT_FILTERS_IN_STREAMING_MODE;
+        }
+        if (cmd.compare("sim.genesisSnapshotMaxSize")==0)
+        {
+            App::worldContainer->setGenesisSnapshotMaxSize(size_t(luaWrap_lua_tointeger(L,2)));
+            LUA_END(0);
+        }
+        if (cmd.compare("sim.interfaceStackAllocations")==0)
+        { // returns the cumulated heap and pooled allocation counts of stack nodes, e.g. to diff around a callback
+            unsigned long long int heapAllocs,pooledAllocs;
+            CInterfaceStackObject::getAllocationCounters(heapAllocs,pooledAllocs);
+            luaWrap_lua_pushinteger(L,(long long int)heapAllocs);
+            luaWrap_lua_pushinteger(L,(long long int)pooledAllocs);
+            LUA_END(2);
+        }
+        if (cmd.compare("sim.scriptsToExecuteRebuilds")==0)
+        { // returns how many times the script execution order was rebuilt in the last simulation step, and so far in the current one
+            luaWrap_lua_pushinteger(L,(long long int)App::currentWorld->embeddedScriptContainer->getScriptsToExecuteRebuildCount(true));
+            luaWrap_lua_pushinteger(L,(long long int)App::currentWorld->embeddedScriptContainer->getScriptsToExecuteRebuildCount(false));
+            LUA_END(2);
+        }
+        if (cmd.compare("sim.funcTrace")==0)
+        { // sim.test("sim.funcTrace",recordsPerThread) (or true, for 1000000) starts the binary function trace, sim.test("sim.funcTrace") stops it
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isnumber(L,2) )
+                CFuncTraceBuffer::start(size_t(luaWrap_lua_tointeger(L,2)));
+            else if (luaWrap_lua_gettop(L)>=2)
+                CFuncTraceBuffer::start(1000000);
+            else
+                CFuncTraceBuffer::stop();
+            luaWrap_lua_pushinteger(L,(long long int)CFuncTraceBuffer::getRecordCount());
+            LUA_END(1);
+        }
+        if (cmd.compare("sim.funcTraceDump")==0)
+        { // sim.test("sim.funcTraceDump",filename) stops the binary function trace, and writes it as Chrome trace JSON
+            bool res=false;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isstring(L,2) )
+            {
+                CFuncTraceBuffer::stop();
+                res=CFuncTraceBuffer::dumpAsChromeTrace(luaWrap_lua_tostring(L,2));
+            }
+            luaWrap_lua_pushboolean(L,res);
+            LUA_END(1);
+        }
+        if (cmd.compare("sim.luaBytecodeCache")==0)
+        { // returns the hits, misses and memory size of the Lua bytecode cache. sim.test("sim.luaBytecodeCache",true) also clears the memory cache
+            size_t hits,misses,memorySize;
+            CLuaBytecodeCache::getStats(hits,misses,memorySize);
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaToBool(L,2) )
+                CLuaBytecodeCache::clear();
+            luaWrap_lua_pushinteger(L,(long long int)hits);
+            luaWrap_lua_pushinteger(L,(long long int)misses);
+            luaWrap_lua_pushinteger(L,(long long int)memorySize);
+            LUA_END(3);
+        }
+        if (cmd.compare("sim.luaStatePool")==0)
+        { // returns the available states, hits and misses of the Lua state pool. sim.test("sim.luaStatePool",size) also sets the pool size and refills the pool
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isnumber(L,2) )
+            {
+                App::userSettings->luaStatePoolSize=std::max<int>(0,luaWrap_lua_tointeger(L,2));
+                CLuaStatePool::getDefaultPool()->refill(true);
+            }
+            size_t available,hits,misses;
+            CLuaStatePool::getDefaultPool()->getStats(available,hits,misses);
+            luaWrap_lua_pushinteger(L,(long long int)available);
+            luaWrap_lua_pushinteger(L,(long long int)hits);
+            luaWrap_lua_pushinteger(L,(long long int)misses);
+            LUA_END(3);
+        }
+        if (cmd.compare("sim.luaStatePoolBenchmark")==0)
+        { // sim.test("sim.luaStatePoolBenchmark",stateCount=20). Returns the time in ms to build the states in the calling thread,
+            // of the refill call made at simulation end, until the pool is refilled in the background, and to take the states from the pool
+            size_t stateCnt=20;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isnumber(L,2) )
+                stateCnt=size_t(std::max<int>(1,luaToInt(L,2)));
+            double buildMs,refillCallMs,backgroundMs,takeMs;
+            CLuaStatePool::benchmark(stateCnt,buildMs,refillCallMs,backgroundMs,takeMs);
+            luaWrap_lua_pushnumber(L,buildMs);
+            luaWrap_lua_pushnumber(L,refillCallMs);
+            luaWrap_lua_pushnumber(L,backgroundMs);
+            luaWrap_lua_pushnumber(L,takeMs);
+            LUA_END(4);
+        }
+        if (cmd.compare("sim.scriptIsolation")==0)
+        { // returns the worker thread count, the isolated sysCall_sensing runs and the buffered API calls so far
+            int workers;
+            size_t scriptRuns,bufferedCalls;
+            CScriptIsolation::getStats(workers,scriptRuns,bufferedCalls);
+            luaWrap_lua_pushinteger(L,workers);
+            luaWrap_lua_pushinteger(L,(long long int)scriptRuns);
+            luaWrap_lua_pushinteger(L,(long long int)bufferedCalls);
+            LUA_END(3);
+        }
+        if (cmd.compare("sim.transformCacheBenchmark")==0)
+        { // sim.test("sim.transformCacheBenchmark",depth=100,operations=100000,writeRatio=0.1). Returns the time in ms with and without the transformation cache, and the max. error
+            int depth=100;
+            int operations=100000;
+            double writeRatio=0.1;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isnumber(L,2) )
+                depth=std::max<int>(1,luaToInt(L,2));
+            if ( (luaWrap_lua_gettop(L)>=3)&&luaWrap_lua_isnumber(L,3) )
+                operations=std::max<int>(0,luaToInt(L,3));
+            if ( (luaWrap_lua_gettop(L)>=4)&&luaWrap_lua_isnumber(L,4) )
+                writeRatio=luaToDouble(L,4);
+            if (VThread::isCurrentThreadTheMainSimulationThread())
+            {
+                double cachedMs,uncachedMs,maxError;
+                CSceneObject::benchmarkTransformationCache(depth,operations,writeRatio,cachedMs,uncachedMs,maxError);
+                luaWrap_lua_pushnumber(L,cachedMs);
+                luaWrap_lua_pushnumber(L,uncachedMs);
+                luaWrap_lua_pushnumber(L,maxError);
+                LUA_END(3);
+            }
+            LUA_END(0);
+        }
+        if (cmd.compare("sim.luaApiCallBenchmark")==0)
+        { // sim.test("sim.luaApiCallBenchmark",calls=1000000). Returns the time in ns per call of the sim.getSimulationTime wrapper
+            // (i.e. with the entry and exit macros), and of the bare C API call it wraps
+            int calls=1000000;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isnumber(L,2) )
+                calls=std::max<int>(1,luaToInt(L,2));
+            int top=luaWrap_lua_gettop(L);
+            auto start=std::chrono::steady_clock::now();
+            for (int i=0;i<calls;i++)
+            {
+                _simGetSimulationTime(L);
+                luaWrap_lua_settop(L,top);
+            }
+            double wrapperNs=double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count())/double(calls);
+            start=std::chrono::steady_clock::now();
+            for (int i=0;i<calls;i++)
+            {
+                luaWrap_lua_pushnumber(L,simGetSimulationTime_internal());
+                luaWrap_lua_settop(L,top);
+            }
+            double bareNs=double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()-start).count())/double(calls);
+            luaWrap_lua_pushnumber(L,wrapperNs);
+            luaWrap_lua_pushnumber(L,bareNs);
+            LUA_END(2);
+        }
+        if (cmd.compare("sim.objectPoseBenchmark")==0)
+        { // sim.test("sim.objectPoseBenchmark",iterations=100). Reads and writes back the absolute poses of all scene objects,
+            // with one C API call per object, then with the batch functions. Returns the time in ms of the per-call get, batch get,
+            // per-call set and batch set
+            int iterations=100;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isnumber(L,2) )
+                iterations=std::max<int>(1,luaToInt(L,2));
+            if (VThread::isCurrentThreadTheMainSimulationThread())
+            {
+                std::vector<int> handles;
+                for (size_t i=0;i<App::currentWorld->sceneObjects->getObjectCount();i++)
+                    handles.push_back(App::currentWorld->sceneObjects->getObjectFromIndex(i)->getObjectHandle());
+                int cnt=int(handles.size());
+                std::vector<double> poses(7*handles.size()+1);
+                double ms[4];
+                for (int mode=0;mode<4;mode++)
+                {
+                    auto start=std::chrono::steady_clock::now();
+                    for (int it=0;it<iterations;it++)
+                    {
+                        if (mode==0)
+                        {
+                            for (int i=0;i<cnt;i++)
+                                simGetObjectPose_internal(handles[i],sim_handle_world,poses.data()+7*size_t(i));
+                        }
+                        if (mode==1)
+                            simGetObjectPoses_internal(handles.data(),cnt,sim_handle_world,poses.data());
+                        if (mode==2)
+                        { // the poses written back are the current ones: the scene stays unchanged
+                            for (int i=0;i<cnt;i++)
+                                simSetObjectPose_internal(handles[i],sim_handle_world,poses.data()+7*size_t(i));
+                        }
+                        if (mode==3)
+                            simSetObjectPoses_internal(handles.data(),cnt,sim_handle_world,poses.data());
+                    }
+                    ms[mode]=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+                }
+                for (size_t i=0;i<4;i++)
+                    luaWrap_lua_pushnumber(L,ms[i]);
+                LUA_END(4);
+            }
+            LUA_END(0);
+        }
+        if (cmd.compare("sim.worldTransformStore")==0)
+        { // returns whether the world transformation store is enabled, its slot count, its rebuild count and the poses recomputed in the last batch update
+            size_t slots=0;
+            size_t rebuilds=0;
+            size_t recomputed=0;
+            App::currentWorld->sceneObjects->getWorldTransformStoreStats(slots,rebuilds,recomputed);
+            luaWrap_lua_pushboolean(L,App::userSettings->worldTransformStore);
+            luaWrap_lua_pushinteger(L,(long long int)slots);
+            luaWrap_lua_pushinteger(L,(long long int)rebuilds);
+            luaWrap_lua_pushinteger(L,(long long int)recomputed);
+            LUA_END(4);
+        }
+        if (cmd.compare("sim.objectIndexBenchmark")==0)
+        { // sim.test("sim.objectIndexBenchmark",objectCount=10000,lookups=1000000). Returns the lookup time in ms with the flat hash map and with std::map
+            size_t objectCount=10000;
+            size_t lookups=1000000;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isnumber(L,2) )
+                objectCount=size_t(std::max<int>(1,luaToInt(L,2)));
+            if ( (luaWrap_lua_gettop(L)>=3)&&luaWrap_lua_isnumber(L,3) )
+                lookups=size_t(std::max<int>(0,luaToInt(L,3)));
+            double flatMapMs,stdMapMs;
+            _CSceneObjectContainer_::benchmarkObjectIndex(objectCount,lookups,flatMapMs,stdMapMs);
+            luaWrap_lua_pushnumber(L,flatMapMs);
+            luaWrap_lua_pushnumber(L,stdMapMs);
+            LUA_END(2);
+        }
+        if (cmd.compare("sim.objectPathCache")==0)
+        { // returns the hits, misses and entries of the object path cache of the current scene
+            size_t hits,misses,entries;
+            App::currentWorld->sceneObjects->getObjectPathCacheStats(hits,misses,entries);
+            luaWrap_lua_pushinteger(L,(long long int)hits);
+            luaWrap_lua_pushinteger(L,(long long int)misses);
+            luaWrap_lua_pushinteger(L,(long long int)entries);
+            LUA_END(3);
+        }
+        if (cmd.compare("sim.sceneBroadphase")==0)
+        { // returns the proxy count, the tree height, and the rebuild and refit counts of the broadphase of the current scene, or nothing if it was not used yet
+            size_t proxies,rebuilds,refits;
+            int height;
+            if (App::currentWorld->sceneObjects->getBroadphaseStats(proxies,height,rebuilds,refits))
+            {
+                luaWrap_lua_pushinteger(L,(long long int)proxies);
+                luaWrap_lua_pushinteger(L,height);
+                luaWrap_lua_pushinteger(L,(long long int)rebuilds);
+                luaWrap_lua_pushinteger(L,(long long int)refits);
+                LUA_END(4);
+            }
+            LUA_END(0);
+        }
+        if (cmd.compare("sim.stackTableLookupBenchmark")==0)
+        { // sim.test("sim.stackTableLookupBenchmark",keyCount=64,lookups=1000000). Returns the getMapObject time in ms with the
+            // key index and with a linear scan. Maps with fewer than INTERFACESTACKTABLE_KEYINDEX_MIN_SIZE keys have no index
+            size_t keyCount=64;
+            size_t lookups=1000000;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isnumber(L,2) )
+                keyCount=size_t(std::max<int>(1,luaToInt(L,2)));
+            if ( (luaWrap_lua_gettop(L)>=3)&&luaWrap_lua_isnumber(L,3) )
+                lookups=size_t(std::max<int>(0,luaToInt(L,3)));
+            double indexedMs,scannedMs;
+            CInterfaceStackTable::benchmarkMapLookups(keyCount,lookups,indexedMs,scannedMs);
+            luaWrap_lua_pushnumber(L,indexedMs);
+            luaWrap_lua_pushnumber(L,scannedMs);
+            LUA_END(2);
+        }
+        if (cmd.compare("sim.eventMergeBenchmark")==0)
+        { // sim.test("sim.eventMergeBenchmark",eventCount=100000,uidCount=1000,mergeable=true). Pose change events go through pushEvent.
+            // Returns the merge time in ms, the number of kept events, and the push and drain time in ms.
+            // With mergeable=false and uidCount=1, all events stay (previously the quadratic case)
+            size_t eventCount=100000;
+            size_t uidCount=1000;
+            bool mergeable=true;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isnumber(L,2) )
+                eventCount=(size_t)std::max<int>(0,luaToInt(L,2));
+            if ( (luaWrap_lua_gettop(L)>=3)&&luaWrap_lua_isnumber(L,3) )
+                uidCount=(size_t)std::max<int>(1,luaToInt(L,3));
+            if ( (luaWrap_lua_gettop(L)>=4)&&luaWrap_lua_isboolean(L,4) )
+                mergeable=luaToBool(L,4);
+            double pushMs,mergeMs;
+            size_t keptEvents;
+            App::worldContainer->benchmarkEventMerging(eventCount,uidCount,mergeable,pushMs,mergeMs,keptEvents);
+            luaWrap_lua_pushnumber(L,mergeMs);
+            luaWrap_lua_pushinteger(L,(long long int)keptEvents);
+            luaWrap_lua_pushnumber(L,pushMs);
+            LUA_END(3);
+        }
+        if (cmd.compare("sim.eventPushBenchmark")==0)
+        { // sim.test("sim.eventPushBenchmark",threadCnt=4,eventsPerThread=100000). Contention benchmark of pushEvent and of the
+            // queue drain. Returns the time in ms for all pushes and drains, and whether each producer's order was kept
+            size_t threadCnt=4;
+            size_t eventsPerThread=100000;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isnumber(L,2) )
+                threadCnt=(size_t)std::max<int>(1,luaToInt(L,2));
+            if ( (luaWrap_lua_gettop(L)>=3)&&luaWrap_lua_isnumber(L,3) )
+                eventsPerThread=(size_t)std::max<int>(0,luaToInt(L,3));
+            double pushMs;
+            bool orderOk;
+            App::worldContainer->benchmarkEventPush(threadCnt,eventsPerThread,pushMs,orderOk);
+            luaWrap_lua_pushnumber(L,pushMs);
+            luaWrap_lua_pushboolean(L,orderOk);
+            LUA_END(2);
+        }
+        if (cmd.compare("sim.eventMergeTest")==0)
+        { // regression test of the event merging. Returns true, or false and an error message
+            std::string err;
+            bool ok=App::worldContainer->testEventMerging(err);
+            luaWrap_lua_pushboolean(L,ok);
+            if (!ok)
+            {
+                luaWrap_lua_pushstring(L,err.c_str());
+                LUA_END(2);
+            }
+            LUA_END(1);
+        }
+        if (cmd.compare("sim.profileScripts")==0)
+        { // sim.test("sim.profileScripts",true,intervalInUs=0) starts (and clears), sim.test("sim.profileScripts",false) stops. Returns the profiled script handles, their time in ms and their C API time share
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isboolean(L,2) )
+            {
+                if (luaToBool(L,2))
+                {
+                    int interval=0;
+                    if ( (luaWrap_lua_gettop(L)>=3)&&luaWrap_lua_isnumber(L,3) )
+                        interval=luaToInt(L,3);
+                    CScriptProfiler::clear();
+                    CScriptProfiler::start(interval);
+                }
+                else
+                    CScriptProfiler::stop();
+            }
+            std::vector<int> handles;
+            std::vector<double> times;
+            std::vector<double> apiShares;
+            CScriptProfiler::getScriptTotals(handles,times,apiShares);
+            pushIntTableOntoStack(L,handles.size(),handles.data());
+            pushDoubleTableOntoStack(L,times.size(),times.data());
+            pushDoubleTableOntoStack(L,apiShares.size(),apiShares.data());
+            LUA_END(3);
+        }
+        if (cmd.compare("sim.profileScriptsExport")==0)
+        { // sim.test("sim.profileScriptsExport",filename) writes collapsed stacks (times in us), e.g. for flamegraph.pl
+            bool res=false;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isstring(L,2) )
+                res=CScriptProfiler::exportCollapsedStacks(luaWrap_lua_tostring(L,2));
+            luaWrap_lua_pushboolean(L,res);
+            LUA_END(1);
+        }
+        if (cmd.compare("sim.recordEvents")==0)
+        { // sim.test("sim.recordEvents",filePrefix,segmentSizeInBytes=64MB) starts, sim.test("sim.recordEvents") stops
+            bool res=true;
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isstring(L,2) )
+            {
+                size_t segmentSize=64*1024*1024;
+                if ( (luaWrap_lua_gettop(L)>=3)&&luaWrap_lua_isnumber(L,3) )
+                    segmentSize=size_t(luaWrap_lua_tointeger(L,3));
+                res=App::worldContainer->startEventRecording(luaWrap_lua_tostring(L,2),segmentSize);
+            }
+            else
+                App::worldContainer->stopEventRecording();
+            luaWrap_lua_pushboolean(L,res);
+            LUA_END(1);
+        }
+        if (cmd.compare("sim.replayEvents")==0)
+        { // sim.test("sim.replayEvents",filePrefix,speed=0), speed 0 is as fast as possible (returns the batch count). Otherwise
+            // the replay runs in the background, paced by the simulation thread loop (returns 0)
+            if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isstring(L,2) )
+            {
+                double speed=0.0;
+                if ( (luaWrap_lua_gettop(L)>=3)&&luaWrap_lua_isnumber(L,3) )
+                    speed=luaToDouble(L,3);
+                luaWrap_lua_pushinteger(L,App::worldContainer->replayEventLog(luaWrap_lua_tostring(L,2),speed));
+                LUA_END(1);
+            }
+        }
         if (cmd.compare("sim.fetchCreationEvents")==0)
         {
             CInterfaceStack* stack=App::worldContainer->interfaceStackContainer->createStack();
@@ -6426,7 +6878,7 @@ int _simUnpackInt32Table(luaWrap_lua_State* L)
     TRACE_LUA_API;
     LUA_START("sim.unpackInt32Table");
 
-    if (checkInputArguments(L,&errorString,lua_arg_string,0))
+    if (CLuaBuffer::isBuffer(L,1)||checkInputArguments(L,&errorString,lua_arg_string,0))
     {
         int startIndex=0;
         int count=0;
@@ -6450,7 +6902,7 @@ int _simUnpackInt32Table(luaWrap_lua_State* L)
                         additionalCharOffset=luaToInt(L,4);
 
                     size_t dataLength;
-                    char* data=((char*)luaWrap_lua_tolstring(L,1,&dataLength))+additionalCharOffset;
+                    char* data=((char*)CLuaBuffer::getData(L,1,&dataLength))+additionalCharOffset;
                     dataLength=sizeof(int)*((dataLength-additionalCharOffset)/sizeof(int));
                     int packetCount=int(dataLength/sizeof(int));
                     if (count==0)
@@ -6489,7 +6941,7 @@ int _simUnpackUInt32Table(luaWrap_lua_State* L)
     TRACE_LUA_API;
     LUA_START("sim.unpackUInt32Table");
 
-    if (checkInputArguments(L,&errorString,lua_arg_string,0))
+    if (CLuaBuffer::isBuffer(L,1)||checkInputArguments(L,&errorString,lua_arg_string,0))
     {
         int startIndex=0;
         int count=0;
@@ -6513,7 +6965,7 @@ int _simUnpackUInt32Table(luaWrap_lua_State* L)
                         additionalCharOffset=luaToInt(L,4);
 
                     size_t dataLength;
-                    char* data=((char*)luaWrap_lua_tolstring(L,1,&dataLength))+additionalCharOffset;
+                    char* data=((char*)CLuaBuffer::getData(L,1,&dataLength))+additionalCharOffset;
                     dataLength=sizeof(unsigned int)*((dataLength-additionalCharOffset)/sizeof(unsigned int));
                     int packetCount=int(dataLength/sizeof(unsigned int));
                     if (count==0)
@@ -6552,7 +7004,7 @@ int _simUnpackFloatTable(luaWrap_lua_State* L)
     TRACE_LUA_API;
     LUA_START("sim.unpackFloatTable");
 
-    if (checkInputArguments(L,&errorString,lua_arg_string,0))
+    if (CLuaBuffer::isBuffer(L,1)||checkInputArguments(L,&errorString,lua_arg_string,0))
     {
         int startIndex=0;
         int count=0;
@@ -6576,7 +7028,7 @@ int _simUnpackFloatTable(luaWrap_lua_State* L)
                         additionalCharOffset=luaToInt(L,4);
 
                     size_t dataLength;
-                    char* data=((char*)luaWrap_lua_tolstring(L,1,&dataLength))+additionalCharOffset;
+                    char* data=((char*)CLuaBuffer::getData(L,1,&dataLength))+additionalCharOffset;
                     dataLength=sizeof(float)*((dataLength-additionalCharOffset)/sizeof(float));
                     int packetCount=int(dataLength/sizeof(float));
                     if (count==0)
@@ -6615,7 +7067,7 @@ int _simUnpackDoubleTable(luaWrap_lua_State* L)
     TRACE_LUA_API;
     LUA_START("sim.unpackDoubleTable");
 
-    if (checkInputArguments(L,&errorString,lua_arg_string,0))
+    if (CLuaBuffer::isBuffer(L,1)||checkInputArguments(L,&errorString,lua_arg_string,0))
     {
         int startIndex=0;
         int count=0;
@@ -6639,7 +7091,7 @@ int _simUnpackDoubleTable(luaWrap_lua_State* L)
                         additionalCharOffset=luaToInt(L,4);
 
                     size_t dataLength;
-                    char* data=((char*)luaWrap_lua_tolstring(L,1,&dataLength))+additionalCharOffset;
+                    char* data=((char*)CLuaBuffer::getData(L,1,&dataLength))+additionalCharOffset;
                     dataLength=sizeof(double)*((dataLength-additionalCharOffset)/sizeof(double));
                     int packetCount=int(dataLength/sizeof(double));
                     if (count==0)
@@ -6682,7 +7134,7 @@ int _simUnpackUInt8Table(luaWrap_lua_State* L)
     TRACE_LUA_API;
     LUA_START("sim.unpackUInt8Table");
 
-    if (checkInputArguments(L,&errorString,lua_arg_string,0))
+    if (CLuaBuffer::isBuffer(L,1)||checkInputArguments(L,&errorString,lua_arg_string,0))
     {
         int startIndex=0;
         int count=0;
@@ -6699,7 +7151,7 @@ int _simUnpackUInt8Table(luaWrap_lua_State* L)
                     count=luaToInt(L,3);
 
                 size_t dataLength;
-                const char* data=(char*)luaWrap_lua_tolstring(L,1,&dataLength);
+                const char* data=(char*)CLuaBuffer::getData(L,1,&dataLength);
                 int packetCount=(int)dataLength;
                 if (count==0)
                     count=int(1999999999);
@@ -6733,7 +7185,7 @@ int _simUnpackUInt16Table(luaWrap_lua_State* L)
     TRACE_LUA_API;
     LUA_START("sim.unpackUInt16Table");
 
-    if (checkInputArguments(L,&errorString,lua_arg_string,0))
+    if (CLuaBuffer::isBuffer(L,1)||checkInputArguments(L,&errorString,lua_arg_string,0))
     {
         int startIndex=0;
         int count=0;
@@ -6757,7 +7209,7 @@ int _simUnpackUInt16Table(luaWrap_lua_State* L)
                         additionalCharOffset=luaToInt(L,4);
 
                     size_t dataLength;
-                    char* data=((char*)luaWrap_lua_tolstring(L,1,&dataLength))+additionalCharOffset;
+                    char* data=((char*)CLuaBuffer::getData(L,1,&dataLength))+additionalCharOffset;
                     dataLength=2*((dataLength-additionalCharOffset)/2);
                     int packetCount=(int)dataLength/2;
                     if (count==0)
@@ -9624,16 +10076,32 @@ int _simGetShapeMesh(luaWrap_lua_State* L)
         int* indices;
         int indicesSize;
         double* normals;
-        int result=simGetShapeMesh_internal(luaToInt(L,1),&vertices,&verticesSize,&indices,&indicesSize,&normals);
-        if (result>0)
+        int options=0;
+        int res=checkOneGeneralInputArgument(L,2,lua_arg_integer,0,true,false,&errorString);
+        if (res>=0)
         {
-            pushDoubleTableOntoStack(L,verticesSize,vertices);
-            pushIntTableOntoStack(L,indicesSize,indices);
-            pushDoubleTableOntoStack(L,indicesSize*3,normals);
-            delete[] vertices;
-            delete[] indices;
-            delete[] normals;
-            LUA_END(3);
+            if (res==2)
+                options=luaToInt(L,2);
+            int result=simGetShapeMesh_internal(luaToInt(L,1),&vertices,&verticesSize,&indices,&indicesSize,&normals);
+            if (result>0)
+            {
+                if ((options&8)!=0)
+                { // no copy: the buffers take ownership
+                    CLuaBuffer::pushBuffer(L,vertices,verticesSize*sizeof(double),LUABUFFER_TYPE_DOUBLE);
+                    CLuaBuffer::pushBuffer(L,indices,indicesSize*sizeof(int),LUABUFFER_TYPE_INT32);
+                    CLuaBuffer::pushBuffer(L,normals,indicesSize*3*sizeof(double),LUABUFFER_TYPE_DOUBLE);
+                }
+                else
+                {
+                    pushDoubleTableOntoStack(L,verticesSize,vertices);
+                    pushIntTableOntoStack(L,indicesSize,indices);
+                    pushDoubleTableOntoStack(L,indicesSize*3,normals);
+                    delete[] vertices;
+                    delete[] indices;
+                    delete[] normals;
+                }
+                LUA_END(3);
+            }
         }
     }
 
@@ -11149,7 +11617,7 @@ int _simPushUserEvent(luaWrap_lua_State* L)
                     CScriptObject::buildFromInterpreterStack_lua(L,stack,4,0); // skip the 3 first args
                     CInterfaceStackTable* t=(CInterfaceStackTable*)stack->detachStackObjectFromIndex(0);
                     App::worldContainer->interfaceStackContainer->destroyStack(stack);
-                    event.eventTable->appendMapObject_stringObject("data",t);
+                    data->setTable(t);
                     App::worldContainer->pushEvent(event);
                 }
             }
@@ -11161,6 +11629,29 @@ int _simPushUserEvent(luaWrap_lua_State* L)
     LUA_END(0);
 }
 
+int _simSetEventFilters(luaWrap_lua_State* L)
+{ // filters: {eventTypes={..},handles={..},uids={..},fields={..}}. No argument removes the filters
+    TRACE_LUA_API;
+    LUA_START("sim.setEventFilters");
+
+    int scriptHandle=CScriptObject::getScriptHandleFromInterpreterState_lua(L);
+    if (luaWrap_lua_istable(L,1))
+    {
+        CInterfaceStack* stack=App::worldContainer->interfaceStackContainer->createStack();
+        CScriptObject::buildFromInterpreterStack_lua(L,stack,1,1);
+        SEventFilter filter;
+        CWorldContainer::getEventFilterFromTable((CInterfaceStackTable*)stack->getStackObjectFromIndex(0),filter);
+        App::worldContainer->interfaceStackContainer->destroyStack(stack);
+        if (!App::worldContainer->setEventFilter({eventsubscriber_script,scriptHandle},&filter))
+            errorString=SIM_ERROR_EVENT_FILTERS_IN_STREAMING_MODE;
+    }
+    else
+        App::worldContainer->setEventFilter({eventsubscriber_script,scriptHandle},nullptr);
+
+    LUA_RAISE_ERROR_OR_YIELD_IF_NEEDED(); // we might never return from this!
+    LUA_END(0);
+}
+
 int _simBroadcastMsg(luaWrap_lua_State* L)
 {
     TRACE_LUA_API;
@@ -12489,12 +12980,22 @@ int _simGetPointCloudPoints(luaWrap_lua_State* L)
     if (checkInputArguments(L,&errorString,lua_arg_number,0))
     {
         int handle=luaToInt(L,1);
-        int ptCnt=-1;
-        const double* p=simGetPointCloudPoints_internal(handle,&ptCnt,nullptr);
-        if (ptCnt>=0)
+        int options=0;
+        int res=checkOneGeneralInputArgument(L,2,lua_arg_integer,0,true,false,&errorString);
+        if (res>=0)
         {
-            pushDoubleTableOntoStack(L,ptCnt*3,p);
-            LUA_END(1);
+            if (res==2)
+                options=luaToInt(L,2);
+            int ptCnt=-1;
+            const double* p=simGetPointCloudPoints_internal(handle,&ptCnt,nullptr);
+            if (ptCnt>=0)
+            {
+                if ((options&8)!=0)
+                    CLuaBuffer::pushBufferCopy(L,p,ptCnt*3*sizeof(double),LUABUFFER_TYPE_DOUBLE); // one memcpy, no per-element conversion
+                else
+                    pushDoubleTableOntoStack(L,ptCnt*3,p);
+                LUA_END(1);
+            }
         }
     }
 
@@ -13465,6 +13966,27 @@ int _simGetRandom(luaWrap_lua_State* L)
     LUA_END(0);
 }
 
+int _simSetScriptIsolated(luaWrap_lua_State* L)
+{
+    TRACE_LUA_API;
+    LUA_START("sim.setScriptIsolated");
+
+    if (checkInputArguments(L,&errorString,lua_arg_bool,0))
+    {
+        CScriptObject* it=App::worldContainer->getScriptFromHandle(CScriptObject::getScriptHandleFromInterpreterState_lua(L));
+        if (it!=nullptr)
+        {
+            if ( (it->getScriptType()==sim_scripttype_childscript)||(it->getScriptType()==sim_scripttype_customizationscript) )
+                it->setIsolatedExecution(luaWrap_lua_toboolean(L,1)!=0);
+            else
+                errorString="only child and customization scripts can be isolated.";
+        }
+    }
+
+    LUA_RAISE_ERROR_OR_YIELD_IF_NEEDED(); // we might never return from this!
+    LUA_END(0);
+}
+
 //****************************************************
 //****************************************************
 //****************************************************
@@ -43,8 +43,8 @@ int luaToInt(luaWrap_lua_State* L,int pos);
 double luaToDouble(luaWrap_lua_State* L,int pos);
 bool luaToBool(luaWrap_lua_State* L,int pos);
 
-void _reportWarningsIfNeeded(luaWrap_lua_State* L,const char* functionName,const char* warningString,bool cSideErrorOrWarningReporting);
-void _raiseErrorIfNeeded(luaWrap_lua_State* L,const char* functionName,const char* errorString,bool cSideErrorReporting);
+void _reportWarningsIfNeeded(luaWrap_lua_State* L,const char* functionName,const std::string& warningString,bool cSideErrorOrWarningReporting);
+void _raiseErrorIfNeeded(luaWrap_lua_State* L,const char* functionName,const std::string& errorString,bool cSideErrorReporting);
 bool doesEntityExist(std::string* errStr,int identifier);
 bool checkInputArguments(luaWrap_lua_State* L,std::string* errStr,
                          int type1=lua_arg_empty,int type1Cnt_zeroIfNotTable=-2,
@@ -125,6 +125,8 @@ extern int _simGetObjectMatrix(luaWrap_lua_State* L);
 extern int _simSetObjectMatrix(luaWrap_lua_State* L);
 extern int _simGetObjectPose(luaWrap_lua_State* L);
 extern int _simSetObjectPose(luaWrap_lua_State* L);
+extern int _simGetObjectPoses(luaWrap_lua_State* L);
+extern int _simSetObjectPoses(luaWrap_lua_State* L);
 extern int _simGetObjectChildPose(luaWrap_lua_State* L);
 extern int _simSetObjectChildPose(luaWrap_lua_State* L);
 extern int _simBuildIdentityMatrix(luaWrap_lua_State* L);
@@ -384,6 +386,7 @@ extern int _simRegisterScriptFuncHook(luaWrap_lua_State* L);
 extern int _simIsDeprecated(luaWrap_lua_State* L);
 extern int _simGetPersistentDataTags(luaWrap_lua_State* L);
 extern int _simGetRandom(luaWrap_lua_State* L);
+extern int _simSetScriptIsolated(luaWrap_lua_State* L);
 extern int _simTest(luaWrap_lua_State* L);
 extern int _simTextEditorOpen(luaWrap_lua_State* L);
 extern int _simTextEditorClose(luaWrap_lua_State* L);
@@ -403,6 +406,7 @@ extern int _simGetClosestPosOnPath(luaWrap_lua_State* L);
 extern int _simInitScript(luaWrap_lua_State* L);
 extern int _simModuleEntry(luaWrap_lua_State* L);
 extern int _simPushUserEvent(luaWrap_lua_State* L);
+extern int _simSetEventFilters(luaWrap_lua_State* L);
 extern int _simGetGenesisEvents(luaWrap_lua_State* L);
 extern int _simBroadcastMsg(luaWrap_lua_State* L);
 extern int _simHandleJointMotion(luaWrap_lua_State* L);
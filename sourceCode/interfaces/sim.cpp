@@ -162,6 +162,14 @@ SIM_DLLEXPORT int simResetScript(int scriptHandle)
 {
     return(simResetScript_internal(scriptHandle));
 }
+SIM_DLLEXPORT int simSetEventFilters(int scriptHandle,int stackHandle)
+{
+    return(simSetEventFilters_internal(scriptHandle,stackHandle));
+}
+SIM_DLLEXPORT int simSetPluginEventFilters(const char* pluginName,int stackHandle,void(*callback)(int eventsStackHandle))
+{
+    return(simSetPluginEventFilters_internal(pluginName,stackHandle,callback));
+}
 SIM_DLLEXPORT int simAddScript(int scriptProperty)
 {
     return(simAddScript_internal(scriptProperty));
@@ -1037,6 +1045,14 @@ SIM_DLLEXPORT int simSetObjectPose_D(int objectHandle,int relativeToObjectHandle
 {
     return(simSetObjectPose_internal(objectHandle,relativeToObjectHandle,pose));
 }
+SIM_DLLEXPORT int simGetObjectPoses_D(const int* objectHandles,int count,int relativeToObjectHandle,double* poses)
+{
+    return(simGetObjectPoses_internal(objectHandles,count,relativeToObjectHandle,poses));
+}
+SIM_DLLEXPORT int simSetObjectPoses_D(const int* objectHandles,int count,int relativeToObjectHandle,const double* poses)
+{
+    return(simSetObjectPoses_internal(objectHandles,count,relativeToObjectHandle,poses));
+}
 SIM_DLLEXPORT int simGetObjectPosition_D(int objectHandle,int relativeToObjectHandle,double* position)
 {
     return(simGetObjectPosition_internal(objectHandle,relativeToObjectHandle,position));
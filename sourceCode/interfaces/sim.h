@@ -56,6 +56,8 @@ SIM_DLLEXPORT int simSetObjectSel(const int* handles,int cnt);
 SIM_DLLEXPORT int simAssociateScriptWithObject(int scriptHandle,int associatedObjectHandle);
 SIM_DLLEXPORT int simHandleMainScript();
 SIM_DLLEXPORT int simResetScript(int scriptHandle);
+SIM_DLLEXPORT int simSetEventFilters(int scriptHandle,int stackHandle);
+SIM_DLLEXPORT int simSetPluginEventFilters(const char* pluginName,int stackHandle,void(*callback)(int eventsStackHandle));
 SIM_DLLEXPORT int simAddScript(int scriptProperty);
 SIM_DLLEXPORT int simRemoveScript(int scriptHandle);
 SIM_DLLEXPORT int simRefreshDialogs(int refreshDegree);
@@ -278,6 +280,8 @@ SIM_DLLEXPORT int simGetObjectMatrix_D(int objectHandle,int relativeToObjectHand
 SIM_DLLEXPORT int simSetObjectMatrix_D(int objectHandle,int relativeToObjectHandle,const double* matrix);
 SIM_DLLEXPORT int simGetObjectPose_D(int objectHandle,int relativeToObjectHandle,double* pose);
 SIM_DLLEXPORT int simSetObjectPose_D(int objectHandle,int relativeToObjectHandle,const double* pose);
+SIM_DLLEXPORT int simGetObjectPoses_D(const int* objectHandles,int count,int relativeToObjectHandle,double* poses);
+SIM_DLLEXPORT int simSetObjectPoses_D(const int* objectHandles,int count,int relativeToObjectHandle,const double* poses);
 SIM_DLLEXPORT int simGetObjectPosition_D(int objectHandle,int relativeToObjectHandle,double* position);
 SIM_DLLEXPORT int simSetObjectPosition_D(int objectHandle,int relativeToObjectHandle,const double* position);
 SIM_DLLEXPORT int simGetObjectOrientation_D(int objectHandle,int relativeToObjectHandle,double* eulerAngles);
@@ -1657,6 +1657,156 @@ int simSetObjectPose_internal(int objectHandle,int relativeToObjectHandle,const
     return(-1);
 }
 
+static C7Vector _getFullCumulativeTransformation_cached(const CSceneObject* object,std::unordered_map<const CSceneObject*,C7Vector>& cache)
+{ // used by the batch pose functions: each subtree's cumulative transformation is computed only once
+    auto it=cache.find(object);
+    if (it!=cache.end())
+        return(it->second);
+    C7Vector retVal(object->getFullLocalTransformation());
+    if (object->getParent()!=nullptr)
+        retVal=_getFullCumulativeTransformation_cached(object->getParent(),cache)*retVal;
+    cache[object]=retVal;
+    return(retVal);
+}
+
+int simGetObjectPoses_internal(const int* objectHandles,int count,int relativeToObjectHandle,double* poses)
+{ // poses is count*7 values. Returns the number of poses, or -1
+    TRACE_C_API;
+
+    if (!isSimulatorInitialized(__func__))
+        return(-1);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA
+    {
+        std::unordered_map<const CSceneObject*,C7Vector> cache;
+        for (int i=0;i<count;i++)
+        {
+            int handleFlags=objectHandles[i]&0xff00000;
+            int objectHandle=objectHandles[i]&0xfffff;
+            if (!doesObjectExist(__func__,objectHandle))
+                return(-1);
+            CSceneObject* it=App::currentWorld->sceneObjects->getObjectFromHandle(objectHandle);
+            int relHandle=relativeToObjectHandle;
+            if (relHandle==sim_handle_parent)
+            {
+                relHandle=sim_handle_world;
+                CSceneObject* parent=it->getParent();
+                if (parent!=nullptr)
+                    relHandle=parent->getObjectHandle();
+            }
+            bool inverse=false;
+            if (relHandle==sim_handle_inverse)
+            {
+                inverse=true;
+                relHandle=sim_handle_world;
+            }
+            if (relHandle!=sim_handle_world)
+            {
+                if (!doesObjectExist(__func__,relHandle))
+                    return(-1);
+            }
+            CSceneObject* relObj=App::currentWorld->sceneObjects->getObjectFromHandle(relHandle);
+            C7Vector tr(it->getLocalTransformation());
+            if (it->getParent()!=nullptr)
+                tr=_getFullCumulativeTransformation_cached(it->getParent(),cache)*tr;
+            if (relObj!=nullptr)
+            {
+                C7Vector relTr;
+                if ( (handleFlags&sim_handleflag_reljointbaseframe)!=0)
+                {
+                    relTr=relObj->getLocalTransformation();
+                    if (relObj->getParent()!=nullptr)
+                        relTr=_getFullCumulativeTransformation_cached(relObj->getParent(),cache)*relTr;
+                }
+                else
+                    relTr=_getFullCumulativeTransformation_cached(relObj,cache);
+                tr=relTr.getInverse()*tr;
+            }
+            if (inverse)
+                tr.inverse();
+            tr.getData(poses+7*size_t(i),(handleFlags&sim_handleflag_wxyzquat)==0);
+        }
+        return(count);
+    }
+    CApiErrors::setLastWarningOrError(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_READ);
+    return(-1);
+}
+
+int simSetObjectPoses_internal(const int* objectHandles,int count,int relativeToObjectHandle,const double* poses)
+{ // poses is count*7 values. Poses are applied in sequence, as with repeated calls to simSetObjectPose. Returns the number of poses, or -1
+    TRACE_C_API;
+
+    if (!isSimulatorInitialized(__func__))
+        return(-1);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_WRITE_DATA
+    {
+        for (int i=0;i<count;i++)
+        { // check all handles first: we do not want to apply only part of the poses
+            if (!doesObjectExist(__func__,objectHandles[i]&0xfffff))
+                return(-1);
+        }
+        if ( (relativeToObjectHandle!=sim_handle_world)&&(relativeToObjectHandle!=sim_handle_parent)&&(relativeToObjectHandle!=sim_handle_inverse) )
+        {
+            if (!doesObjectExist(__func__,relativeToObjectHandle))
+                return(-1);
+        }
+        std::unordered_map<const CSceneObject*,C7Vector> cache;
+        for (int i=0;i<count;i++)
+        {
+            int handleFlags=objectHandles[i]&0xff00000;
+            CSceneObject* it=App::currentWorld->sceneObjects->getObjectFromHandle(objectHandles[i]&0xfffff);
+            int relHandle=relativeToObjectHandle;
+            if (relHandle==sim_handle_parent)
+            {
+                relHandle=sim_handle_world;
+                CSceneObject* parent=it->getParent();
+                if (parent!=nullptr)
+                    relHandle=parent->getObjectHandle();
+            }
+            bool inverse=false;
+            if (relHandle==sim_handle_inverse)
+            {
+                inverse=true;
+                relHandle=sim_handle_world;
+            }
+            if (it->getDynamicFlag()>1) // for non-static shapes, and other objects that are in the dyn. world
+                it->setDynamicsResetFlag(true,true);
+            C7Vector tr;
+            tr.setData(poses+7*size_t(i),(handleFlags&sim_handleflag_wxyzquat)==0);
+            if (inverse)
+                tr.inverse();
+            CSceneObject* objRel=App::currentWorld->sceneObjects->getObjectFromHandle(relHandle);
+            if (objRel!=nullptr)
+            {
+                C7Vector relTr;
+                if ( (handleFlags&sim_handleflag_reljointbaseframe)!=0)
+                {
+                    relTr=objRel->getLocalTransformation();
+                    if (objRel->getParent()!=nullptr)
+                        relTr=_getFullCumulativeTransformation_cached(objRel->getParent(),cache)*relTr;
+                }
+                else
+                    relTr=_getFullCumulativeTransformation_cached(objRel,cache);
+                tr=relTr*tr;
+            }
+            C7Vector parentTr;
+            parentTr.setIdentity();
+            if (it->getParent()!=nullptr)
+                parentTr=_getFullCumulativeTransformation_cached(it->getParent(),cache);
+            it->setLocalTransformation(parentTr.getInverse()*tr);
+            // the object and its descendants moved:
+            if (it->getChildCount()>0)
+                cache.clear();
+            else
+                cache.erase(it);
+        }
+        return(count);
+    }
+    CApiErrors::setLastWarningOrError(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_WRITE);
+    return(-1);
+}
+
 int simGetObjectPosition_internal(int objectHandle,int relativeToObjectHandle,double* position)
 {
     TRACE_C_API;
@@ -5085,6 +5235,100 @@ int simResetScript_internal(int scriptHandle)
     return(-1);
 }
 
+static bool _getEventFilterFromStack(const char* funcName,int stackHandle,SEventFilter& filter)
+{ // the stack's top item is a filter table, as with sim.setEventFilters
+    CInterfaceStack* stack=App::worldContainer->interfaceStackContainer->getStack(stackHandle);
+    if (stack==nullptr)
+    {
+        CApiErrors::setLastWarningOrError(funcName,SIM_ERROR_INVALID_HANDLE);
+        return(false);
+    }
+    CInterfaceStackObject* obj=nullptr;
+    if (stack->getStackSize()>0)
+        obj=stack->getStackObjectFromIndex(stack->getStackSize()-1);
+    if ( (obj==nullptr)||(obj->getObjectType()!=STACK_OBJECT_TABLE) )
+    {
+        CApiErrors::setLastWarningOrError(funcName,SIM_ERROR_INVALID_DATA);
+        return(false);
+    }
+    CWorldContainer::getEventFilterFromTable((CInterfaceStackTable*)obj,filter);
+    return(true);
+}
+
+int simSetEventFilters_internal(int scriptHandle,int stackHandle)
+{ // the stack's top item is a filter table, as with sim.setEventFilters. stackHandle=-1 removes the script's filters.
+  // Lets plugins set the filters of the scripts they drive
+    TRACE_C_API;
+
+    if (!isSimulatorInitialized(__func__))
+        return(-1);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_WRITE_DATA
+    {
+        if (App::worldContainer->getScriptFromHandle(scriptHandle)==nullptr)
+        {
+            CApiErrors::setLastWarningOrError(__func__,SIM_ERROR_SCRIPT_INEXISTANT);
+            return(-1);
+        }
+        SEventSubscriber subscriber={eventsubscriber_script,scriptHandle};
+        if (stackHandle==-1)
+        {
+            App::worldContainer->setEventFilter(subscriber,nullptr);
+            return(1);
+        }
+        SEventFilter filter;
+        if (!_getEventFilterFromStack(__func__,stackHandle,filter))
+            return(-1);
+        if (!App::worldContainer->setEventFilter(subscriber,&filter))
+        {
+            CApiErrors::setLastWarningOrError(__func__,SIM_ERROR_EVENT_FILTERS_IN_STREAMING_MODE);
+            return(-1);
+        }
+        return(1);
+    }
+    CApiErrors::setLastWarningOrError(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_WRITE);
+    return(-1);
+}
+
+int simSetPluginEventFilters_internal(const char* pluginName,int stackHandle,void(*callback)(int eventsStackHandle))
+{ // subscribes a plugin to the event batches, with a filter table on the stack's top item, as with sim.setEventFilters.
+  // stackHandle=-1: no filter. callback=nullptr unsubscribes. The callback is called from the simulation thread,
+  // with a stack holding the batch as passed to sysCall_event, and valid only during the call
+    TRACE_C_API;
+
+    if (!isSimulatorInitialized(__func__))
+        return(-1);
+
+    IF_C_API_SIM_OR_UI_THREAD_CAN_WRITE_DATA
+    {
+        CPlugin* plugin=CPluginContainer::getPluginFromName(pluginName,true);
+        if (plugin==nullptr)
+        {
+            CApiErrors::setLastWarningOrError(__func__,SIM_ERROR_INVALID_PLUGIN_NAME);
+            return(-1);
+        }
+        SEventSubscriber subscriber={eventsubscriber_plugin,plugin->handle};
+        if (callback==nullptr)
+        {
+            App::worldContainer->setEventFilter(subscriber,nullptr);
+            plugin->eventCallback=nullptr;
+            return(1);
+        }
+        SEventFilter filter;
+        if ( (stackHandle!=-1)&&(!_getEventFilterFromStack(__func__,stackHandle,filter)) )
+            return(-1);
+        if (!App::worldContainer->setEventFilter(subscriber,&filter))
+        {
+            CApiErrors::setLastWarningOrError(__func__,SIM_ERROR_EVENT_FILTERS_IN_STREAMING_MODE);
+            return(-1);
+        }
+        plugin->eventCallback=callback;
+        return(1);
+    }
+    CApiErrors::setLastWarningOrError(__func__,SIM_ERROR_COULD_NOT_LOCK_RESOURCES_FOR_WRITE);
+    return(-1);
+}
+
 int simAssociateScriptWithObject_internal(int scriptHandle,int associatedObjectHandle)
 {
     TRACE_C_API;
@@ -39,6 +39,8 @@ int simGetObjectMatrix_internal(int objectHandle,int relativeToObjectHandle,doub
 int simSetObjectMatrix_internal(int objectHandle,int relativeToObjectHandle,const double* matrix);
 int simGetObjectPose_internal(int objectHandle,int relativeToObjectHandle,double* pose);
 int simSetObjectPose_internal(int objectHandle,int relativeToObjectHandle,const double* pose);
+int simGetObjectPoses_internal(const int* objectHandles,int count,int relativeToObjectHandle,double* poses);
+int simSetObjectPoses_internal(const int* objectHandles,int count,int relativeToObjectHandle,const double* poses);
 int simGetObjectPosition_internal(int objectHandle,int relativeToObjectHandle,double* position);
 int simSetObjectPosition_internal(int objectHandle,int relativeToObjectHandle,const double* position);
 int simGetObjectOrientation_internal(int objectHandle,int relativeToObjectHandle,double* eulerAngles);
@@ -90,6 +92,8 @@ int simHandleDynamics_internal(double deltaTime);
 int simAssociateScriptWithObject_internal(int scriptHandle,int associatedObjectHandle);
 int simHandleMainScript_internal();
 int simResetScript_internal(int scriptHandle);
+int simSetEventFilters_internal(int scriptHandle,int stackHandle);
+int simSetPluginEventFilters_internal(const char* pluginName,int stackHandle,void(*callback)(int eventsStackHandle));
 int simAddScript_internal(int scriptProperty);
 int simRemoveScript_internal(int scriptHandle);
 int simRefreshDialogs_internal(int refreshDegree);
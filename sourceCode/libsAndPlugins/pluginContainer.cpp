@@ -18,6 +18,7 @@ CPlugin::CPlugin(const char* filename,const char* pluginName)
     extendedVersionInt=-1;
     _consoleVerbosity=sim_verbosity_useglobal;
     _statusbarVerbosity=sim_verbosity_useglobal;
+    eventCallback=nullptr;
 
     // Following used to detect appartenance:
     instance=nullptr;
@@ -530,6 +531,7 @@ bool CPluginContainer::unloadPlugin(int handle)
             std::string nm(it->getName());
             _removePlugin(handle);
             App::worldContainer->scriptCustomFuncAndVarContainer->announcePluginWasKilled(nm.c_str());
+            App::worldContainer->setEventFilter({eventsubscriber_plugin,handle},nullptr);
             retVal=true;
         }
         else
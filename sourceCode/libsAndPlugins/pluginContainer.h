@@ -8,6 +8,7 @@
 typedef  unsigned char (__cdecl *ptrStart)(void*,int);
 typedef  void (__cdecl *ptrEnd)(void);
 typedef  void* (__cdecl *ptrMessage)(int,int*,void*,int*);
+typedef  void (__cdecl *ptrEventCallback)(int);
 typedef  void (__cdecl *ptrExtRenderer)(int,void*);
 typedef  void (__cdecl *ptrQhull)(void*);
 typedef  void (__cdecl *ptrHACD)(void*);
@@ -211,6 +212,7 @@ public:
     ptrStart startAddress;
     ptrEnd endAddress;
     ptrMessage messageAddress;
+    ptrEventCallback eventCallback; // set via simSetPluginEventFilters
 
     ptr_dynPlugin_startSimulation_D dynPlugin_startSimulation;
     ptr_dynPlugin_endSimulation dynPlugin_endSimulation;
@@ -0,0 +1,611 @@
+#include <eventData.h>
+#include <interfaceStackString.h>
+#include <interfaceStackInteger.h>
+#include <interfaceStackNumber.h>
+#include <interfaceStackBool.h>
+#include <interfaceStackNull.h>
+#include <string.h>
+
+CEventData::CEventData(bool cbor) : _cbor(nullptr,0)
+{
+    _isCbor=cbor;
+    _table=nullptr;
+    _ownsTable=true;
+    _openCborContainers=0;
+    if (_isCbor)
+    {
+        _cbor.appendMap(0); // indefinite length, closed in close
+        _openCborContainers=1;
+    }
+    else
+    {
+        _table=new CInterfaceStackTable();
+        _openTables.push_back(_table);
+    }
+}
+
+CEventData::CEventData(CInterfaceStackTable* table) : _cbor(nullptr,0)
+{
+    _isCbor=false;
+    _table=table;
+    _ownsTable=true;
+    _openCborContainers=0;
+    _openTables.push_back(_table);
+}
+
+CEventData::~CEventData()
+{
+    if (_ownsTable)
+        delete _table;
+}
+
+CEventData* CEventData::copyYourself() const
+{
+    CEventData* retVal;
+    if (_isCbor)
+    {
+        retVal=new CEventData(true);
+        retVal->_cbor=_cbor;
+        retVal->_openCborContainers=_openCborContainers;
+    }
+    else
+        retVal=new CEventData((CInterfaceStackTable*)_table->copyYourself());
+    return(retVal);
+}
+
+bool CEventData::isCbor() const
+{
+    return(_isCbor);
+}
+
+void CEventData::close()
+{
+    if (_isCbor)
+    {
+        while (_openCborContainers>0)
+        {
+            _cbor.appendBreakIfApplicable();
+            _openCborContainers--;
+        }
+    }
+    else
+        _openTables.resize(1);
+}
+
+void CEventData::toTable()
+{
+    if (_isCbor)
+    {
+        close();
+        size_t l;
+        const unsigned char* b=_cbor.getBuff(l);
+        size_t pos=0;
+        CInterfaceStackObject* obj=_decodeCborItem(b,l,pos);
+        if ( (obj==nullptr)||(obj->getObjectType()!=STACK_OBJECT_TABLE) )
+        {
+            delete obj;
+            obj=new CInterfaceStackTable();
+        }
+        _table=(CInterfaceStackTable*)obj;
+        _ownsTable=true;
+        _openTables.assign(1,_table);
+        _cbor.clear();
+        _isCbor=false;
+    }
+}
+
+void CEventData::toCbor()
+{
+    if (!_isCbor)
+    {
+        _cbor.clear();
+        _table->addCborObjectData(&_cbor);
+        if (_ownsTable)
+            delete _table;
+        _table=nullptr;
+        _openTables.clear();
+        _openCborContainers=0;
+        _isCbor=true;
+    }
+}
+
+CInterfaceStackTable* CEventData::getTable() const
+{
+    return(_table);
+}
+
+CInterfaceStackTable* CEventData::detachTable()
+{
+    _ownsTable=false;
+    return(_table);
+}
+
+void CEventData::setTable(CInterfaceStackTable* table)
+{
+    if (_isCbor)
+    {
+        _cbor.clear();
+        table->addCborObjectData(&_cbor);
+        _openCborContainers=0;
+        delete table;
+    }
+    else
+    {
+        if (_ownsTable)
+            delete _table;
+        _table=table;
+        _ownsTable=true;
+        _openTables.assign(1,_table);
+    }
+}
+
+const unsigned char* CEventData::getCbor(size_t& l)
+{
+    const unsigned char* retVal=nullptr;
+    l=0;
+    if (_isCbor)
+    {
+        close();
+        retVal=_cbor.getBuff(l);
+    }
+    return(retVal);
+}
+
+void CEventData::addCborObjectData(CCbor* cborObj)
+{
+    if (_isCbor)
+    {
+        size_t l;
+        const unsigned char* b=getCbor(l);
+        cborObj->appendRaw(b,l);
+    }
+    else
+        _table->addCborObjectData(cborObj);
+}
+
+void CEventData::mergeFromOlder(CEventData* older,const std::string& dataSubtype)
+{ // older is emptied in the process
+    if (_isCbor)
+    {
+        older->toCbor();
+        size_t newerL,olderL;
+        const unsigned char* newer=getCbor(newerL);
+        const unsigned char* old=older->getCbor(olderL);
+        CCbor merged(nullptr,0);
+        if (_mergeCborMaps(merged,newer,newerL,0,old,olderL,0,dataSubtype))
+            _cbor=merged;
+        older->_cbor.clear();
+    }
+    else
+    {
+        older->toTable();
+        mergeTables(_table,older->_table,dataSubtype);
+    }
+}
+
+void CEventData::mergeTables(CInterfaceStackTable* newerData,CInterfaceStackTable* olderData,const std::string& dataSubtype)
+{ // fields of the newer event always win. Fields only present in the older event are moved over. The dataSubtype sub-table
+  // (e.g. "shape") is merged key by key, whichever of the two events it came with
+    std::vector<CInterfaceStackObject*> allObjs;
+    olderData->getAllObjectsAndClearTable(allObjs);
+    for (size_t k=0;k<allObjs.size()/2;k++)
+    {
+        CInterfaceStackObject* key=allObjs[2*k+0];
+        CInterfaceStackObject* val=allObjs[2*k+1];
+        CInterfaceStackObject* existing=nullptr;
+        if (key->getObjectType()==STACK_OBJECT_STRING)
+            existing=newerData->getMapObject(((CInterfaceStackString*)key)->getValue(nullptr));
+        if (existing==nullptr)
+            newerData->appendArrayOrMapObject(key,val);
+        else
+        {
+            if ( (dataSubtype.size()>0)&&(dataSubtype.compare(((CInterfaceStackString*)key)->getValue(nullptr))==0)&&(existing->getObjectType()==STACK_OBJECT_TABLE)&&(val->getObjectType()==STACK_OBJECT_TABLE) )
+                mergeTables((CInterfaceStackTable*)existing,(CInterfaceStackTable*)val,"");
+            delete key;
+            delete val;
+        }
+    }
+}
+
+void CEventData::appendMapObject_stringBool(const char* key,bool value)
+{
+    if (_isCbor)
+    {
+        _cbor.appendString(key);
+        _cbor.appendBool(value);
+    }
+    else
+        _openTables.back()->appendMapObject_stringBool(key,value);
+}
+
+void CEventData::appendMapObject_stringFloat(const char* key,float value)
+{
+    if (_isCbor)
+    {
+        _cbor.appendString(key);
+        _cbor.appendDouble(double(value)); // as CInterfaceStackNumber
+    }
+    else
+        _openTables.back()->appendMapObject_stringFloat(key,value);
+}
+
+void CEventData::appendMapObject_stringInt32(const char* key,int value)
+{
+    if (_isCbor)
+    {
+        _cbor.appendString(key);
+        _cbor.appendInt(value);
+    }
+    else
+        _openTables.back()->appendMapObject_stringInt32(key,value);
+}
+
+void CEventData::appendMapObject_stringInt64(const char* key,long long int value)
+{
+    if (_isCbor)
+    {
+        _cbor.appendString(key);
+        _cbor.appendInt(value);
+    }
+    else
+        _openTables.back()->appendMapObject_stringInt64(key,value);
+}
+
+void CEventData::appendMapObject_stringString(const char* key,const char* value,size_t l,bool cborCoded/*=false*/)
+{ // l==0: value is zero-terminated, as for CInterfaceStackString
+    if (_isCbor)
+    {
+        _cbor.appendString(key);
+        if (l==0)
+            l=strlen(value);
+        if (cborCoded)
+            _cbor.appendRaw((const unsigned char*)value,l);
+        else
+            _cbor.appendLuaString(std::string(value,value+l));
+    }
+    else
+        _openTables.back()->appendMapObject_stringString(key,value,l,cborCoded);
+}
+
+void CEventData::appendMapObject_stringInt32Array(const char* key,const int* arr,size_t l)
+{
+    if (_isCbor)
+    { // integers use the shortest encoding, as for packed tables
+        _cbor.appendString(key);
+        _cbor.appendArray(l);
+        for (size_t i=0;i<l;i++)
+            _cbor.appendInt(arr[i]);
+        _cbor.appendBreakIfApplicable();
+    }
+    else
+        _openTables.back()->appendMapObject_stringInt32Array(key,arr,l);
+}
+
+void CEventData::appendMapObject_stringFloatArray(const char* key,const float* arr,size_t l)
+{
+    if (_isCbor)
+    {
+        _cbor.appendString(key);
+        _cbor.appendFloatArray(arr,l);
+    }
+    else
+        _openTables.back()->appendMapObject_stringFloatArray(key,arr,l);
+}
+
+void CEventData::appendMapObject_stringDoubleArray(const char* key,const double* arr,size_t l)
+{
+    if (_isCbor)
+    {
+        _cbor.appendString(key);
+        _cbor.appendDoubleArray(arr,l);
+    }
+    else
+        _openTables.back()->appendMapObject_stringDoubleArray(key,arr,l);
+}
+
+void CEventData::appendArrayObject_floatArray(const float* arr,size_t l)
+{
+    if (_isCbor)
+        _cbor.appendFloatArray(arr,l);
+    else
+        _openTables.back()->appendArrayObject_floatArray(arr,l);
+}
+
+void CEventData::openMapObject_stringMap(const char* key)
+{
+    if (_isCbor)
+    {
+        _cbor.appendString(key);
+        _cbor.appendMap(0);
+        _openCborContainers++;
+    }
+    else
+    {
+        CInterfaceStackTable* table=new CInterfaceStackTable();
+        _openTables.back()->appendMapObject_stringObject(key,table);
+        _openTables.push_back(table);
+    }
+}
+
+void CEventData::openMapObject_stringArray(const char* key)
+{
+    if (_isCbor)
+    {
+        _cbor.appendString(key);
+        _cbor.appendArray(0);
+        _openCborContainers++;
+    }
+    else
+    {
+        CInterfaceStackTable* table=new CInterfaceStackTable();
+        _openTables.back()->appendMapObject_stringObject(key,table);
+        _openTables.push_back(table);
+    }
+}
+
+void CEventData::openArrayObject_map()
+{
+    if (_isCbor)
+    {
+        _cbor.appendMap(0);
+        _openCborContainers++;
+    }
+    else
+    {
+        CInterfaceStackTable* table=new CInterfaceStackTable();
+        _openTables.back()->appendArrayObject(table);
+        _openTables.push_back(table);
+    }
+}
+
+void CEventData::closeObject()
+{ // the root map is only closed with close
+    if (_isCbor)
+    {
+        if (_openCborContainers>1)
+        {
+            _cbor.appendBreakIfApplicable();
+            _openCborContainers--;
+        }
+    }
+    else
+    {
+        if (_openTables.size()>1)
+            _openTables.pop_back();
+    }
+}
+
+bool CEventData::_readCborHead(const unsigned char* b,size_t l,size_t& pos,int& major,int& info,unsigned long long int& value)
+{ // value is the argument (count, length, integer, or the raw bits of a float)
+    if (pos>=l)
+        return(false);
+    major=b[pos]>>5;
+    info=b[pos]&31;
+    pos++;
+    value=(unsigned long long int)info;
+    size_t n=0;
+    if (info==24)
+        n=1;
+    else if (info==25)
+        n=2;
+    else if (info==26)
+        n=4;
+    else if (info==27)
+        n=8;
+    else if ( (info>27)&&(info<31) )
+        return(false);
+    if (n>l-pos)
+        return(false);
+    if (n>0)
+    {
+        value=0;
+        for (size_t i=0;i<n;i++)
+            value=(value<<8)|b[pos+i];
+        pos+=n;
+    }
+    return(true);
+}
+
+bool CEventData::_skipCborItem(const unsigned char* b,size_t l,size_t& pos)
+{
+    int major,info;
+    unsigned long long int v;
+    if (!_readCborHead(b,l,pos,major,info,v))
+        return(false);
+    if (info==31)
+    { // indefinite length
+        if ( (major==0)||(major==1)||(major==6)||(major==7) )
+            return(false); // invalid, or a break
+        while (true)
+        {
+            if (pos>=l)
+                return(false);
+            if (b[pos]==255)
+            {
+                pos++;
+                return(true);
+            }
+            if (!_skipCborItem(b,l,pos))
+                return(false);
+            if ( (major==5)&&(!_skipCborItem(b,l,pos)) )
+                return(false);
+        }
+    }
+    if ( (major==2)||(major==3) )
+    {
+        if (v>l-pos)
+            return(false);
+        pos+=size_t(v);
+    }
+    else if ( (major==4)||(major==5) )
+    {
+        if (major==5)
+            v*=2;
+        for (unsigned long long int i=0;i<v;i++)
+        {
+            if (!_skipCborItem(b,l,pos))
+                return(false);
+        }
+    }
+    else if (major==6)
+        return(_skipCborItem(b,l,pos));
+    return(true);
+}
+
+bool CEventData::_getCborMapFields(const unsigned char* b,size_t l,size_t pos,std::vector<SCborField>& fields)
+{
+    int major,info;
+    unsigned long long int v;
+    if ( (!_readCborHead(b,l,pos,major,info,v))||(major!=5) )
+        return(false);
+    for (unsigned long long int i=0;(info==31)||(i<v);i++)
+    {
+        if (pos>=l)
+            return(false);
+        if ( (info==31)&&(b[pos]==255) )
+            break;
+        SCborField field;
+        field.key=pos;
+        if (!_skipCborItem(b,l,pos))
+            return(false);
+        field.value=pos;
+        if (!_skipCborItem(b,l,pos))
+            return(false);
+        field.end=pos;
+        fields.push_back(field);
+    }
+    return(true);
+}
+
+bool CEventData::_mergeCborMaps(CCbor& dest,const unsigned char* newer,size_t newerL,size_t newerPos,const unsigned char* older,size_t olderL,size_t olderPos,const std::string& dataSubtype)
+{ // same as mergeTables, on encoded maps. Keys are compared in their encoded form
+    std::vector<SCborField> newerFields;
+    std::vector<SCborField> olderFields;
+    if ( (!_getCborMapFields(newer,newerL,newerPos,newerFields))||(!_getCborMapFields(older,olderL,olderPos,olderFields)) )
+        return(false);
+    CCbor subtypeKey(nullptr,0);
+    subtypeKey.appendString(dataSubtype.c_str(),int(dataSubtype.size()));
+    size_t subtypeKeyL;
+    const unsigned char* subtypeKeyB=subtypeKey.getBuff(subtypeKeyL);
+    std::vector<bool> olderOverridden(olderFields.size(),false);
+    dest.appendMap(newerFields.size()+olderFields.size());
+    for (size_t i=0;i<newerFields.size();i++)
+    {
+        const SCborField& nf=newerFields[i];
+        size_t keyL=nf.value-nf.key;
+        bool merged=false;
+        for (size_t j=0;j<olderFields.size();j++)
+        {
+            const SCborField& of=olderFields[j];
+            if ( (of.value-of.key==keyL)&&(memcmp(newer+nf.key,older+of.key,keyL)==0) )
+            {
+                olderOverridden[j]=true;
+                bool subtype=(dataSubtype.size()>0)&&(keyL==subtypeKeyL)&&(memcmp(newer+nf.key,subtypeKeyB,keyL)==0);
+                if ( subtype&&((newer[nf.value]>>5)==5)&&((older[of.value]>>5)==5) )
+                {
+                    dest.appendRaw(newer+nf.key,keyL);
+                    if (!_mergeCborMaps(dest,newer,newerL,nf.value,older,olderL,of.value,""))
+                        return(false);
+                    merged=true;
+                }
+            }
+        }
+        if (!merged)
+            dest.appendRaw(newer+nf.key,nf.end-nf.key);
+    }
+    for (size_t j=0;j<olderFields.size();j++)
+    {
+        if (!olderOverridden[j])
+            dest.appendRaw(older+olderFields[j].key,olderFields[j].end-olderFields[j].key);
+    }
+    dest.appendBreakIfApplicable();
+    return(true);
+}
+
+CInterfaceStackObject* CEventData::_decodeCborItem(const unsigned char* b,size_t l,size_t& pos)
+{ // returns nullptr if not supported or invalid
+    CInterfaceStackObject* retVal=nullptr;
+    int major,info;
+    unsigned long long int v;
+    if (!_readCborHead(b,l,pos,major,info,v))
+        return(nullptr);
+    if (major==0)
+        retVal=new CInterfaceStackInteger((long long int)v);
+    else if (major==1)
+        retVal=new CInterfaceStackInteger(-1-(long long int)v);
+    else if ( (major==2)||(major==3) )
+    {
+        if ( (info!=31)&&(v<=l-pos) )
+        {
+            if (v==0)
+                retVal=new CInterfaceStackString("",0); // 0 would otherwise mean zero-terminated
+            else
+                retVal=new CInterfaceStackString((const char*)b+pos,size_t(v));
+            pos+=size_t(v);
+        }
+    }
+    else if ( (major==4)||(major==5) )
+    {
+        CInterfaceStackTable* table=new CInterfaceStackTable();
+        retVal=table;
+        for (unsigned long long int i=0;(info==31)||(i<v);i++)
+        {
+            if (pos>=l)
+            {
+                delete table;
+                return(nullptr);
+            }
+            if ( (info==31)&&(b[pos]==255) )
+            {
+                pos++;
+                break;
+            }
+            CInterfaceStackObject* key=nullptr;
+            if (major==5)
+            {
+                key=_decodeCborItem(b,l,pos);
+                if (key==nullptr)
+                {
+                    delete table;
+                    return(nullptr);
+                }
+            }
+            CInterfaceStackObject* val=_decodeCborItem(b,l,pos);
+            if (val==nullptr)
+            {
+                delete key;
+                delete table;
+                return(nullptr);
+            }
+            if (key==nullptr)
+                table->appendArrayObject(val);
+            else
+                table->appendArrayOrMapObject(key,val);
+        }
+    }
+    else if (major==6)
+        retVal=_decodeCborItem(b,l,pos); // tags are ignored
+    else if (major==7)
+    {
+        if (info==20)
+            retVal=new CInterfaceStackBool(false);
+        else if (info==21)
+            retVal=new CInterfaceStackBool(true);
+        else if ( (info==22)||(info==23) )
+            retVal=new CInterfaceStackNull();
+        else if (info==26)
+        {
+            unsigned int bits=(unsigned int)v;
+            float f;
+            memcpy(&f,&bits,sizeof(f));
+            retVal=new CInterfaceStackNumber(double(f));
+        }
+        else if (info==27)
+        {
+            double d;
+            memcpy(&d,&v,sizeof(d));
+            retVal=new CInterfaceStackNumber(d);
+        }
+    }
+    return(retVal);
+}
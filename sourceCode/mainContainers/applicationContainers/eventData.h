@@ -0,0 +1,66 @@
+#pragma once
+
+#include <interfaceStackTable.h>
+#include <cbor.h>
+#include <vector>
+#include <string>
+
+struct SCborField
+{ // a key/value pair of a CBOR map: offsets of key, value, and end of value
+    size_t key;
+    size_t value;
+    size_t end;
+};
+
+class CEventData
+{ // The data part of an event, as filled by the event producers. Built as a stack table, or, in CBOR streaming mode (see
+  // CWorldContainer::setCborEventStream), directly encoded as a CBOR map, i.e. without a single stack object.
+  // Sub-maps and arrays are opened with open..., filled, then closed with closeObject
+public:
+    CEventData(bool cbor);
+    CEventData(CInterfaceStackTable* table); // table mode, takes ownership
+    virtual ~CEventData();
+
+    CEventData* copyYourself() const;
+    bool isCbor() const;
+    void close(); // closes all open sub-maps and arrays. Nothing can be appended anymore after that
+    void toTable(); // e.g. an event prepared in streaming mode that ends up in a buffer that is not streamed
+    void toCbor();
+    CInterfaceStackTable* getTable() const; // nullptr in CBOR mode
+    CInterfaceStackTable* detachTable(); // the table then belongs to the caller, but stays accessible via getTable
+    void setTable(CInterfaceStackTable* table); // takes ownership. Encoded right away in CBOR mode
+    const unsigned char* getCbor(size_t& l); // nullptr in table mode
+    void addCborObjectData(CCbor* cborObj);
+    void mergeFromOlder(CEventData* older,const std::string& dataSubtype); // newer fields win, see mergeTables
+
+    static void mergeTables(CInterfaceStackTable* newerData,CInterfaceStackTable* olderData,const std::string& dataSubtype);
+
+    // Same as the CInterfaceStackTable functions, applied to the innermost open map or array:
+    void appendMapObject_stringBool(const char* key,bool value);
+    void appendMapObject_stringFloat(const char* key,float value);
+    void appendMapObject_stringInt32(const char* key,int value);
+    void appendMapObject_stringInt64(const char* key,long long int value);
+    void appendMapObject_stringString(const char* key,const char* value,size_t l,bool cborCoded=false);
+    void appendMapObject_stringInt32Array(const char* key,const int* arr,size_t l);
+    void appendMapObject_stringFloatArray(const char* key,const float* arr,size_t l);
+    void appendMapObject_stringDoubleArray(const char* key,const double* arr,size_t l);
+    void appendArrayObject_floatArray(const float* arr,size_t l);
+    void openMapObject_stringMap(const char* key);
+    void openMapObject_stringArray(const char* key);
+    void openArrayObject_map();
+    void closeObject();
+
+protected:
+    static bool _readCborHead(const unsigned char* b,size_t l,size_t& pos,int& major,int& info,unsigned long long int& value);
+    static bool _skipCborItem(const unsigned char* b,size_t l,size_t& pos);
+    static bool _getCborMapFields(const unsigned char* b,size_t l,size_t pos,std::vector<SCborField>& fields);
+    static bool _mergeCborMaps(CCbor& dest,const unsigned char* newer,size_t newerL,size_t newerPos,const unsigned char* older,size_t olderL,size_t olderPos,const std::string& dataSubtype);
+    static CInterfaceStackObject* _decodeCborItem(const unsigned char* b,size_t l,size_t& pos);
+
+    bool _isCbor;
+    CInterfaceStackTable* _table;
+    bool _ownsTable;
+    std::vector<CInterfaceStackTable*> _openTables; // table mode: root first
+    CCbor _cbor;
+    size_t _openCborContainers; // CBOR mode: including the root map
+};
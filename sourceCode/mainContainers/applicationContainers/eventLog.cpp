@@ -0,0 +1,182 @@
+#include <eventLog.h>
+#include <vDateTime.h>
+#include <vFile.h>
+#include <string.h>
+#include <stdio.h>
+
+#define EVENTLOG_MAGIC "SIMEVLG1"
+#define EVENTLOG_MAGIC_SIZE 8
+#define EVENTLOG_RECORD_HEADER_SIZE 12
+
+CEventLogWriter::CEventLogWriter()
+{
+    _segment=nullptr;
+    _segmentSize=0;
+    _segmentIndex=0;
+    _writePos=0;
+    _recordCount=0;
+    _startTime=0;
+}
+
+CEventLogWriter::~CEventLogWriter()
+{
+    stop();
+}
+
+bool CEventLogWriter::start(const char* prefix,size_t segmentSize)
+{
+    stop();
+    _prefix=prefix;
+    _segmentSize=segmentSize;
+    _segmentIndex=0;
+    _recordCount=0;
+    _startTime=VDateTime::getTimeInMs();
+    return(_openSegment(0));
+}
+
+void CEventLogWriter::stop()
+{
+    _closeSegment();
+}
+
+bool CEventLogWriter::appendRecord(const unsigned char* payload,size_t payloadSize)
+{
+    if ( (_segment==nullptr)||(payloadSize==0)||(payloadSize>0xffffffff) )
+        return(false);
+    size_t recSize=EVENTLOG_RECORD_HEADER_SIZE+payloadSize;
+    if (_writePos+recSize>_segment->getCapacity())
+    { // rotate
+        _closeSegment();
+        _segmentIndex++;
+        if (!_openSegment(recSize))
+            return(false);
+    }
+    unsigned int l=(unsigned int)payloadSize;
+    unsigned long long int t=(unsigned long long int)(VDateTime::getTimeInMs()-_startTime);
+    unsigned char* d=_segment->getData()+_writePos;
+    memcpy(d+4,&t,8);
+    memcpy(d+EVENTLOG_RECORD_HEADER_SIZE,payload,payloadSize);
+    memcpy(d,&l,4); // written last: a reader of a crashed log never sees a partial record
+    _writePos+=recSize;
+    _recordCount++;
+    return(true);
+}
+
+size_t CEventLogWriter::getRecordCount() const
+{
+    return(_recordCount);
+}
+
+size_t CEventLogWriter::getSegmentCount() const
+{
+    size_t retVal=_segmentIndex;
+    if (_segment!=nullptr)
+        retVal++;
+    return(retVal);
+}
+
+std::string CEventLogWriter::getSegmentFilename(const char* prefix,size_t segmentIndex)
+{
+    char b[16];
+    snprintf(b,sizeof(b),"_%05i",int(segmentIndex));
+    return(std::string(prefix)+b+".simevents");
+}
+
+bool CEventLogWriter::_openSegment(size_t minCapacity)
+{
+    size_t capacity=_segmentSize;
+    if (capacity<EVENTLOG_MAGIC_SIZE+minCapacity)
+        capacity=EVENTLOG_MAGIC_SIZE+minCapacity;
+    _segment=new VMappedFile();
+    if (!_segment->openForWriting(getSegmentFilename(_prefix.c_str(),_segmentIndex).c_str(),capacity))
+    {
+        delete _segment;
+        _segment=nullptr;
+        return(false);
+    }
+    memcpy(_segment->getData(),EVENTLOG_MAGIC,EVENTLOG_MAGIC_SIZE);
+    _writePos=EVENTLOG_MAGIC_SIZE;
+    return(true);
+}
+
+void CEventLogWriter::_closeSegment()
+{
+    if (_segment!=nullptr)
+    {
+        _segment->close(_writePos);
+        delete _segment;
+        _segment=nullptr;
+    }
+}
+
+CEventLogReader::CEventLogReader()
+{
+    _segment=nullptr;
+    _segmentIndex=0;
+    _readPos=0;
+}
+
+CEventLogReader::~CEventLogReader()
+{
+    close();
+}
+
+bool CEventLogReader::open(const char* prefix)
+{
+    close();
+    _prefix=prefix;
+    return(_openSegment(0));
+}
+
+void CEventLogReader::close()
+{
+    if (_segment!=nullptr)
+    {
+        _segment->close(0);
+        delete _segment;
+        _segment=nullptr;
+    }
+}
+
+bool CEventLogReader::getNextRecord(const unsigned char*& payload,size_t& payloadSize,unsigned long long int& timeInMs)
+{
+    while (_segment!=nullptr)
+    {
+        const unsigned char* d=_segment->getData();
+        size_t cap=_segment->getCapacity();
+        if (_readPos+EVENTLOG_RECORD_HEADER_SIZE<=cap)
+        {
+            unsigned int l;
+            memcpy(&l,d+_readPos,4);
+            if ( (l>0)&&(_readPos+EVENTLOG_RECORD_HEADER_SIZE+l<=cap) )
+            {
+                memcpy(&timeInMs,d+_readPos+4,8);
+                payload=d+_readPos+EVENTLOG_RECORD_HEADER_SIZE;
+                payloadSize=l;
+                _readPos+=EVENTLOG_RECORD_HEADER_SIZE+l;
+                return(true);
+            }
+        }
+        // end of this segment. Move to the next one:
+        close();
+        _openSegment(_segmentIndex+1);
+    }
+    return(false);
+}
+
+bool CEventLogReader::_openSegment(size_t segmentIndex)
+{
+    _segmentIndex=segmentIndex;
+    std::string filename(CEventLogWriter::getSegmentFilename(_prefix.c_str(),segmentIndex));
+    if (!VFile::doesFileExist(filename.c_str()))
+        return(false);
+    _segment=new VMappedFile();
+    if ( (!_segment->openForReading(filename.c_str()))||(_segment->getCapacity()<EVENTLOG_MAGIC_SIZE)||(memcmp(_segment->getData(),EVENTLOG_MAGIC,EVENTLOG_MAGIC_SIZE)!=0) )
+    {
+        delete _segment;
+        _segment=nullptr;
+        return(false);
+    }
+    _readPos=EVENTLOG_MAGIC_SIZE;
+    return(true);
+}
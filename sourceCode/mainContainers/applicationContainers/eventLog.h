@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vMappedFile.h>
+#include <string>
+
+// Event log layout: a sequence of segment files <prefix>_00000.simevents, <prefix>_00001.simevents, etc.
+// Each segment starts with an 8 byte magic, followed by records: payload size (uint32), time in ms since
+// recording start (uint64), payload (a CBOR-encoded event batch, as passed to sysCall_event).
+// A zero payload size (or the end of the file) terminates a segment.
+
+class CEventLogWriter
+{
+public:
+    CEventLogWriter();
+    virtual ~CEventLogWriter();
+
+    bool start(const char* prefix,size_t segmentSize);
+    void stop();
+    bool appendRecord(const unsigned char* payload,size_t payloadSize);
+
+    size_t getRecordCount() const;
+    size_t getSegmentCount() const;
+
+    static std::string getSegmentFilename(const char* prefix,size_t segmentIndex);
+
+private:
+    bool _openSegment(size_t minCapacity);
+    void _closeSegment();
+
+    std::string _prefix;
+    VMappedFile* _segment;
+    size_t _segmentSize;
+    size_t _segmentIndex;
+    size_t _writePos;
+    size_t _recordCount;
+    long long int _startTime;
+};
+
+class CEventLogReader
+{
+public:
+    CEventLogReader();
+    virtual ~CEventLogReader();
+
+    bool open(const char* prefix);
+    void close();
+    bool getNextRecord(const unsigned char*& payload,size_t& payloadSize,unsigned long long int& timeInMs);
+
+private:
+    bool _openSegment(size_t segmentIndex);
+
+    std::string _prefix;
+    VMappedFile* _segment;
+    size_t _segmentIndex;
+    size_t _readPos;
+};
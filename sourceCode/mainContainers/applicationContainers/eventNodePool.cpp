@@ -0,0 +1,92 @@
+#include <eventNodePool.h>
+#include <worldContainer.h>
+
+CEventNodePool::CEventNodePool()
+{
+    _freeList=0;
+    for (size_t i=0;i<EVENTNODEPOOL_MAXCHUNKS;i++)
+        _chunks[i]=nullptr;
+    _chunkCnt=0;
+}
+
+CEventNodePool::~CEventNodePool()
+{ // nodes still in use are freed too
+    for (size_t i=0;i<_chunkCnt.load();i++)
+        delete[] _chunks[i].load();
+}
+
+SEventQueueNode* CEventNodePool::getNode()
+{
+    SEventQueueNode* retVal=nullptr;
+    while (retVal==nullptr)
+    {
+        unsigned long long int head=_freeList.load(std::memory_order_acquire);
+        while ( (retVal==nullptr)&&((head&0xffffffff)!=0) )
+        {
+            SEventQueueNode* node=_getNodeFromIndex((unsigned int)(head&0xffffffff)-1);
+            unsigned long long int next=(((head>>32)+1)<<32)|node->nextFreeNode.load(std::memory_order_relaxed); // nodes are never freed, reading is safe
+            if (_freeList.compare_exchange_weak(head,next,std::memory_order_acquire,std::memory_order_acquire))
+                retVal=node;
+        }
+        if (retVal==nullptr)
+            retVal=_addChunk(); // nullptr if another thread just filled the free list
+    }
+    return(retVal);
+}
+
+void CEventNodePool::releaseNode(SEventQueueNode* node)
+{
+    if (node->poolIndex==-1)
+        delete node;
+    else
+    {
+        unsigned long long int head=_freeList.load(std::memory_order_relaxed);
+        unsigned long long int next;
+        do
+        {
+            node->nextFreeNode.store((unsigned int)(head&0xffffffff),std::memory_order_relaxed);
+            next=(((head>>32)+1)<<32)|(unsigned long long int)(node->poolIndex+1);
+        }
+        while (!_freeList.compare_exchange_weak(head,next,std::memory_order_release,std::memory_order_relaxed));
+    }
+}
+
+size_t CEventNodePool::getAllocatedNodeCount() const
+{
+    return(size_t(_chunkCnt.load())*EVENTNODEPOOL_CHUNKSIZE);
+}
+
+SEventQueueNode* CEventNodePool::_getNodeFromIndex(unsigned int index) const
+{
+    return(_chunks[index/EVENTNODEPOOL_CHUNKSIZE].load(std::memory_order_acquire)+index%EVENTNODEPOOL_CHUNKSIZE);
+}
+
+SEventQueueNode* CEventNodePool::_addChunk()
+{ // returns the first node of the new chunk, the others go to the free list. Returns nullptr if the free list is not empty
+    SEventQueueNode* retVal=nullptr;
+    _chunkMutex.lock_simple("CEventNodePool::_addChunk");
+    if ((_freeList.load()&0xffffffff)!=0)
+    {
+        _chunkMutex.unlock_simple();
+        return(nullptr);
+    }
+    unsigned int chunk=_chunkCnt.load();
+    if (chunk<EVENTNODEPOOL_MAXCHUNKS)
+    {
+        SEventQueueNode* nodes=new SEventQueueNode[EVENTNODEPOOL_CHUNKSIZE];
+        for (size_t i=0;i<EVENTNODEPOOL_CHUNKSIZE;i++)
+            nodes[i].poolIndex=int(chunk*EVENTNODEPOOL_CHUNKSIZE+i);
+        _chunks[chunk].store(nodes,std::memory_order_release);
+        _chunkCnt=chunk+1;
+        retVal=nodes;
+        for (size_t i=1;i<EVENTNODEPOOL_CHUNKSIZE;i++)
+            releaseNode(nodes+i);
+    }
+    _chunkMutex.unlock_simple();
+    if (retVal==nullptr)
+    {
+        retVal=new SEventQueueNode;
+        retVal->poolIndex=-1;
+    }
+    return(retVal);
+}
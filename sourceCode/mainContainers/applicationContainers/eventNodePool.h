@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vMutex.h>
+#include <atomic>
+
+struct SEventQueueNode;
+
+#define EVENTNODEPOOL_CHUNKSIZE 1024
+#define EVENTNODEPOOL_MAXCHUNKS 4096
+
+class CEventNodePool
+{ // Recycles the nodes of the event queue, so that pushing an event does not allocate. Lock-free: any thread can get
+  // a node, any thread can release one. Nodes are allocated by chunk, and only freed with the pool. The free list is
+  // a stack of node indices, tagged against ABA. Once EVENTNODEPOOL_MAXCHUNKS chunks are used up, nodes are simply
+  // allocated and deleted
+public:
+    CEventNodePool();
+    virtual ~CEventNodePool();
+
+    SEventQueueNode* getNode();
+    void releaseNode(SEventQueueNode* node);
+    size_t getAllocatedNodeCount() const;
+
+private:
+    SEventQueueNode* _getNodeFromIndex(unsigned int index) const;
+    SEventQueueNode* _addChunk();
+
+    std::atomic<unsigned long long int> _freeList; // tag in the upper 32 bits, index+1 of the first free node in the lower
+    std::atomic<SEventQueueNode*> _chunks[EVENTNODEPOOL_MAXCHUNKS];
+    std::atomic<unsigned int> _chunkCnt;
+    VMutex _chunkMutex;
+};
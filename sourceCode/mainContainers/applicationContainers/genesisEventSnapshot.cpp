@@ -0,0 +1,267 @@
+#include <genesisEventSnapshot.h>
+#include <worldContainer.h>
+#include <interfaceStackString.h>
+#include <algorithm>
+
+#define SNAPSHOT_MAX_CHANGE_EVENTS_PER_OBJECT 16
+
+CGenesisEventSnapshot::CGenesisEventSnapshot()
+{
+    _nextOrder=0;
+    _joinCnt=0;
+    _size=0;
+    _maxSize=256*1024*1024;
+    _valid=false;
+    _canBuild=true;
+}
+
+CGenesisEventSnapshot::~CGenesisEventSnapshot()
+{
+    clear(true);
+}
+
+void CGenesisEventSnapshot::clear(bool allowRebuild)
+{
+    for (auto it=_entities.begin();it!=_entities.end();it++)
+    {
+        _clearEvent(it->second.addEvent);
+        _clearChangeEvents(it->second);
+    }
+    _entities.clear();
+    _entityOrderFromUid.clear();
+    _nextOrder=0;
+    _size=0;
+    _valid=false;
+    _canBuild=allowRebuild;
+}
+
+void CGenesisEventSnapshot::release()
+{ // nobody receives events anymore, i.e. nobody could join late
+    clear(true);
+    _joinCnt=0;
+}
+
+bool CGenesisEventSnapshot::registerJoin()
+{ // call when a joiner could not be served from the snapshot. Returns true if the snapshot should be built now: the
+  // first joiner since the last release is not a late one, the next ones are
+    _joinCnt++;
+    return(_canBuild&&(_joinCnt>1));
+}
+
+bool CGenesisEventSnapshot::isValid() const
+{
+    return(_valid);
+}
+
+void CGenesisEventSnapshot::setMaxSize(size_t bytes)
+{
+    _maxSize=bytes;
+    _checkSize();
+}
+
+size_t CGenesisEventSnapshot::getMaxSize() const
+{
+    return(_maxSize);
+}
+
+size_t CGenesisEventSnapshot::getSize() const
+{
+    return(_size);
+}
+
+void CGenesisEventSnapshot::build(const std::vector<SEventInfo>& genesisEvents)
+{ // genesisEvents is the output of CWorldContainer::pushGenesisEvents. Only scene objects are kept
+    clear(true);
+    _valid=true;
+    for (size_t i=0;i<genesisEvents.size();i++)
+        applyEvent(genesisEvents[i]);
+    _checkSize();
+}
+
+void CGenesisEventSnapshot::applyEvent(const SEventInfo& event)
+{
+    if (!_valid)
+        return;
+    if (event.event==EVENTTYPE_OBJECTADDED)
+    {
+        auto it=_entityOrderFromUid.find(event.uid);
+        if (it==_entityOrderFromUid.end())
+        {
+            SSnapshotEntity& entity=_entities[_nextOrder];
+            _entityOrderFromUid[event.uid]=_nextOrder++;
+            entity.dirty=false;
+            _setEvent(entity.addEvent,event,true);
+        }
+        else
+        { // e.g. a refreshed object. Keep its position
+            SSnapshotEntity& entity=_entities[it->second];
+            _clearEvent(entity.addEvent);
+            _clearChangeEvents(entity);
+            entity.dirty=false;
+            _setEvent(entity.addEvent,event,true);
+        }
+    }
+    else if (event.event==EVENTTYPE_OBJECTREMOVED)
+    {
+        auto it=_entityOrderFromUid.find(event.uid);
+        if (it!=_entityOrderFromUid.end())
+        {
+            SSnapshotEntity& entity=_entities[it->second];
+            _clearEvent(entity.addEvent);
+            _clearChangeEvents(entity);
+            _entities.erase(it->second);
+            _entityOrderFromUid.erase(it);
+        }
+    }
+    else if (event.event==EVENTTYPE_OBJECTCHANGED)
+    {
+        auto it=_entityOrderFromUid.find(event.uid);
+        if (it!=_entityOrderFromUid.end())
+        {
+            SSnapshotEntity& entity=_entities[it->second];
+            if (!entity.dirty)
+            {
+                if ( event.mergeable&&(entity.changeEvents.size()>0)&&entity.changeEvents[entity.changeEvents.size()-1].mergeable )
+                { // coalesce with the previous change, newer fields win. As in CWorldContainer::_mergeEvents, the object-type
+                    // sub-table is merged key by key, whichever of the two events carried it
+                    SSnapshotEvent& last=entity.changeEvents[entity.changeEvents.size()-1];
+                    SEventInfo merged(event);
+                    if (merged.dataSubtype.size()==0)
+                        merged.dataSubtype=last.dataSubtype;
+                    merged.eventData=event.eventData->copyYourself();
+                    CEventData::mergeTables(merged.eventData->getTable(),last.data,merged.dataSubtype);
+                    _clearEvent(last);
+                    _setEvent(last,merged,false);
+                    delete merged.eventData;
+                }
+                else
+                {
+                    entity.changeEvents.push_back(SSnapshotEvent());
+                    _setEvent(entity.changeEvents[entity.changeEvents.size()-1],event,true);
+                }
+                if (entity.changeEvents.size()>SNAPSHOT_MAX_CHANGE_EVENTS_PER_OBJECT)
+                {
+                    _clearChangeEvents(entity);
+                    entity.dirty=true;
+                }
+            }
+        }
+    }
+    _checkSize();
+}
+
+void CGenesisEventSnapshot::getDirtyObjectUids(std::vector<long long int>& uids) const
+{
+    uids.clear();
+    for (auto it=_entities.begin();it!=_entities.end();it++)
+    {
+        if (it->second.dirty)
+            uids.push_back(it->second.addEvent.uid);
+    }
+}
+
+void CGenesisEventSnapshot::getEvents(std::vector<SEventInfo>& events) const
+{ // all add events in insertion order (i.e. parents first), then all change events in their original order.
+    // The event data is a copy, that the caller takes ownership of
+    events.clear();
+    std::vector<const SSnapshotEvent*> changes;
+    for (auto it=_entities.begin();it!=_entities.end();it++)
+    {
+        events.push_back(_getEventInfo(it->second.addEvent));
+        for (size_t i=0;i<it->second.changeEvents.size();i++)
+            changes.push_back(&it->second.changeEvents[i]);
+    }
+    std::sort(changes.begin(),changes.end(),[](const SSnapshotEvent* a,const SSnapshotEvent* b){return(a->seq<b->seq);});
+    for (size_t i=0;i<changes.size();i++)
+        events.push_back(_getEventInfo(changes[i][0]));
+}
+
+size_t CGenesisEventSnapshot::estimateSize(const CInterfaceStackObject* obj)
+{
+    size_t retVal=sizeof(CInterfaceStackObject)+sizeof(void*);
+    int t=obj->getObjectType();
+    if (t==STACK_OBJECT_STRING)
+    {
+        size_t l;
+        ((CInterfaceStackString*)obj)->getValue(&l);
+        retVal+=l;
+    }
+    if (t==STACK_OBJECT_TABLE)
+    {
+        const CInterfaceStackTable* table=(const CInterfaceStackTable*)obj;
+        if (table->getPackedType()!=STACK_PACKED_NONE)
+            retVal+=table->getArraySize()*sizeof(double);
+        else if (table->isTableArray())
+        { // not packed: getArrayItemAtIndex does not modify the table
+            for (size_t i=0;i<table->getArraySize();i++)
+                retVal+=estimateSize(((CInterfaceStackTable*)table)->getArrayItemAtIndex(i));
+        }
+        else
+        {
+            std::string stringKey;
+            double numberKey;
+            long long int integerKey;
+            bool boolKey;
+            int keyType;
+            for (size_t i=0;i<table->getMapEntryCount();i++)
+            {
+                CInterfaceStackObject* val=table->getMapItemAtIndex(i,stringKey,numberKey,integerKey,boolKey,keyType);
+                retVal+=sizeof(CInterfaceStackObject)+sizeof(void*)+stringKey.size()+estimateSize(val);
+            }
+        }
+    }
+    return(retVal);
+}
+
+SEventInfo CGenesisEventSnapshot::_getEventInfo(const SSnapshotEvent& ev)
+{
+    SEventInfo retVal;
+    retVal.event=ev.event;
+    retVal.subEvent=ev.subEvent;
+    retVal.dataSubtype=ev.dataSubtype;
+    retVal.handle=ev.handle;
+    retVal.uid=ev.uid;
+    retVal.seq=ev.seq;
+    retVal.mergeable=ev.mergeable;
+    retVal.eventTable=nullptr;
+    retVal.eventData=new CEventData((CInterfaceStackTable*)ev.data->copyYourself());
+    return(retVal);
+}
+
+void CGenesisEventSnapshot::_setEvent(SSnapshotEvent& dest,const SEventInfo& source,bool copyData)
+{
+    dest.event=source.event;
+    dest.subEvent=source.subEvent;
+    dest.dataSubtype=source.dataSubtype;
+    dest.handle=source.handle;
+    dest.uid=source.uid;
+    dest.seq=source.seq;
+    dest.mergeable=source.mergeable;
+    if (copyData)
+        dest.data=(CInterfaceStackTable*)source.eventData->getTable()->copyYourself();
+    else
+        dest.data=source.eventData->detachTable();
+    dest.size=estimateSize(dest.data)+sizeof(SSnapshotEvent);
+    _size+=dest.size;
+}
+
+void CGenesisEventSnapshot::_clearEvent(SSnapshotEvent& ev)
+{
+    _size-=ev.size;
+    ev.size=0;
+    delete ev.data;
+    ev.data=nullptr;
+}
+
+void CGenesisEventSnapshot::_clearChangeEvents(SSnapshotEntity& entity)
+{
+    for (size_t i=0;i<entity.changeEvents.size();i++)
+        _clearEvent(entity.changeEvents[i]);
+    entity.changeEvents.clear();
+}
+
+void CGenesisEventSnapshot::_checkSize()
+{
+    if (_valid&&(_size>_maxSize))
+        clear(false); // too large. No rebuild until the next clear(true) (e.g. scene switch)
+}
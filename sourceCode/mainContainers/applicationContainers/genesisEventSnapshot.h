@@ -0,0 +1,69 @@
+#pragma once
+
+#include <interfaceStackTable.h>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <string>
+
+struct SEventInfo;
+
+struct SSnapshotEvent
+{
+    std::string event;
+    std::string subEvent;
+    std::string dataSubtype;
+    int handle;
+    long long int uid;
+    long long int seq;
+    bool mergeable;
+    CInterfaceStackTable* data;
+    size_t size; // estimated memory footprint
+};
+
+struct SSnapshotEntity
+{
+    SSnapshotEvent addEvent;
+    std::vector<SSnapshotEvent> changeEvents; // coalesced changes that happened after addEvent
+    bool dirty; // changes could not be tracked anymore: the object needs to be re-serialized
+};
+
+class CGenesisEventSnapshot
+{ // Incrementally maintained copy of the scene object genesis events, patched with the live change events. Only built
+  // once late joiners are known to exist, since maintaining it means copying every live event. Not maintained in CBOR
+  // streaming mode
+public:
+    CGenesisEventSnapshot();
+    virtual ~CGenesisEventSnapshot();
+
+    void clear(bool allowRebuild);
+    void release();
+    bool registerJoin();
+    bool isValid() const;
+    void setMaxSize(size_t bytes);
+    size_t getMaxSize() const;
+    size_t getSize() const;
+
+    void build(const std::vector<SEventInfo>& genesisEvents);
+    void applyEvent(const SEventInfo& event);
+    void getDirtyObjectUids(std::vector<long long int>& uids) const;
+    void getEvents(std::vector<SEventInfo>& events) const;
+
+    static size_t estimateSize(const CInterfaceStackObject* obj);
+
+protected:
+    static SEventInfo _getEventInfo(const SSnapshotEvent& ev);
+    void _setEvent(SSnapshotEvent& dest,const SEventInfo& source,bool copyData);
+    void _clearEvent(SSnapshotEvent& ev);
+    void _clearChangeEvents(SSnapshotEntity& entity);
+    void _checkSize();
+
+    std::map<unsigned long long int,SSnapshotEntity> _entities; // insertion order --> entity
+    std::unordered_map<long long int,unsigned long long int> _entityOrderFromUid;
+    unsigned long long int _nextOrder;
+    size_t _joinCnt; // joins served without snapshot, since the last release
+    size_t _size;
+    size_t _maxSize;
+    bool _valid;
+    bool _canBuild;
+};
@@ -1,47 +1,43 @@
-
 #include <global.h>
 #include <interfaceStackContainer.h>
 
+#define INTERFACESTACK_MAX_STACKS size_t(SIM_IDEND_INTERFACESTACK-SIM_IDSTART_INTERFACESTACK)
+
 CInterfaceStackContainer::CInterfaceStackContainer()
 {
 }
 
 CInterfaceStackContainer::~CInterfaceStackContainer()
 {
-    for (size_t i=0;i<_allStacks.size();i++)
-        delete _allStacks[i];
+    for (size_t i=0;i<_slots.size();i++)
+        delete _slots[i];
+    for (size_t i=0;i<_recycledStacks.size();i++)
+        delete _recycledStacks[i];
 }
 
 CInterfaceStack* CInterfaceStackContainer::createStack()
 {
-    CInterfaceStack* stack=new CInterfaceStack(1,1,"");
-    int id=SIM_IDSTART_INTERFACESTACK;
-    while (getStack(id)!=nullptr)
-        id++;
-    _allStacks.push_back(stack);
-    stack->setId(id);
+    CInterfaceStack* stack=_getRecycledStack();
+    _addStack(stack);
     return(stack);
 }
 
 CInterfaceStack* CInterfaceStackContainer::createStackCopy(CInterfaceStack* original)
 {
-    int id=SIM_IDSTART_INTERFACESTACK;
-    while (getStack(id)!=nullptr)
-        id++;
-    CInterfaceStack* copy=original->copyYourself();
-    _allStacks.push_back(copy);
-    copy->setId(id);
+    CInterfaceStack* copy=_getRecycledStack();
+    copy->copyFrom(original);
+    _addStack(copy);
     return(copy);
 }
 
 bool CInterfaceStackContainer::destroyStack(CInterfaceStack* stack)
 {
-    for (size_t i=0;i<_allStacks.size();i++)
+    if (stack->hasId())
     {
-        if (_allStacks[i]==stack)
+        int slotIndex=_getSlotIndex(stack->getId());
+        if ( (slotIndex>=0)&&(_slots[slotIndex]==stack) )
         {
-            delete stack;
-            _allStacks.erase(_allStacks.begin()+i);
+            _removeStack(slotIndex);
             return(true);
         }
     }
@@ -50,24 +46,85 @@ bool CInterfaceStackContainer::destroyStack(CInterfaceStack* stack)
 
 bool CInterfaceStackContainer::destroyStack(int id)
 {
-    for (size_t i=0;i<_allStacks.size();i++)
+    int slotIndex=_getSlotIndex(id);
+    if (slotIndex>=0)
     {
-        if (_allStacks[i]->getId()==id)
-        {
-            delete _allStacks[i];
-            _allStacks.erase(_allStacks.begin()+i);
-            return(true);
-        }
+        _removeStack(slotIndex);
+        return(true);
     }
     return(false);
 }
 
 CInterfaceStack* CInterfaceStackContainer::getStack(int id)
 {
-    for (size_t i=0;i<_allStacks.size();i++)
+    int slotIndex=_getSlotIndex(id);
+    if (slotIndex>=0)
+        return(_slots[slotIndex]);
+    return(nullptr);
+}
+
+CInterfaceStack* CInterfaceStackContainer::_getRecycledStack()
+{
+    CInterfaceStack* retVal;
+    if (_recycledStacks.size()>0)
     {
-        if (_allStacks[i]->getId()==id)
-            return(_allStacks[i]);
+        retVal=_recycledStacks[_recycledStacks.size()-1];
+        _recycledStacks.pop_back();
     }
-    return(nullptr);
+    else
+        retVal=new CInterfaceStack(1,1,"");
+    return(retVal);
+}
+
+void CInterfaceStackContainer::_addStack(CInterfaceStack* stack)
+{ // handles stay in the reserved range. Fresh slots are used first, then freed slots, oldest first
+    int slotIndex;
+    if (_slots.size()<INTERFACESTACK_MAX_STACKS)
+    {
+        slotIndex=int(_slots.size());
+        _slots.push_back(nullptr);
+    }
+    else
+    {
+        if (_freeSlots.size()==0)
+        {
+            printf("CInterfaceStackContainer::_addStack(): too many stacks! Crashing now...");
+            abort();
+        }
+        slotIndex=_freeSlots.front();
+        _freeSlots.pop_front();
+    }
+    int id=SIM_IDSTART_INTERFACESTACK+slotIndex;
+    if ( (id<SIM_IDSTART_INTERFACESTACK)||(id>=SIM_IDEND_INTERFACESTACK) )
+    {
+        printf("CInterfaceStackContainer::_addStack(): stack handle out of range! Crashing now...");
+        abort();
+    }
+    _slots[slotIndex]=stack;
+    stack->setId(id);
+}
+
+int CInterfaceStackContainer::_getSlotIndex(int id) const
+{ // returns -1 for invalid handles, or handles of destroyed stacks
+    if ( (id<SIM_IDSTART_INTERFACESTACK)||(id>=SIM_IDEND_INTERFACESTACK) )
+        return(-1);
+    size_t slotIndex=size_t(id-SIM_IDSTART_INTERFACESTACK);
+    if ( (slotIndex>=_slots.size())||(_slots[slotIndex]==nullptr) )
+        return(-1);
+    return(int(slotIndex));
+}
+
+void CInterfaceStackContainer::_removeStack(int slotIndex)
+{
+    CInterfaceStack* stack=_slots[slotIndex];
+    _slots[slotIndex]=nullptr;
+    _freeSlots.push_back(slotIndex);
+    if (_recycledStacks.size()<INTERFACESTACK_MAX_RECYCLED)
+    {
+        stack->clear();
+        stack->setId(-1);
+        _recycledStacks.push_back(stack);
+    }
+    else
+        delete stack;
 }
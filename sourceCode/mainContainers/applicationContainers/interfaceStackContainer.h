@@ -1,7 +1,9 @@
-
 #pragma once
 
 #include <interfaceStack.h>
+#include <deque>
+
+#define INTERFACESTACK_MAX_RECYCLED 64
 
 class CInterfaceStackContainer
 {
@@ -16,5 +18,12 @@ public:
     CInterfaceStack* getStack(int id);
 
 protected:
-    std::vector<CInterfaceStack*> _allStacks;
+    CInterfaceStack* _getRecycledStack();
+    void _addStack(CInterfaceStack* stack);
+    int _getSlotIndex(int id) const;
+    void _removeStack(int slotIndex);
+
+    std::vector<CInterfaceStack*> _slots; // a handle is SIM_IDSTART_INTERFACESTACK+slotIndex. nullptr when free
+    std::deque<int> _freeSlots; // FIFO, so that the handle of a destroyed stack is reused as late as possible
+    std::vector<CInterfaceStack*> _recycledStacks; // cleared stacks, ready for reuse
 };
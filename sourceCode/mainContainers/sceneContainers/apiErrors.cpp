@@ -6,6 +6,7 @@
 #include <iostream>
 
 std::string CApiErrors::_lastWarningOrError;
+static VMutex _lastWarningOrErrorMutex; // errors are also set from worker threads, e.g. by isolated scripts
 
 CApiErrors::CApiErrors()
 {
@@ -32,7 +33,9 @@ void CApiErrors::setLastWarningOrError(const char* functionName,const char* errM
     if (funcName.size()>0)
         msg+=" ("+funcName+")";
 
+    _lastWarningOrErrorMutex.lock("CApiErrors::setLastWarningOrError");
     _lastWarningOrError=msg;
+    _lastWarningOrErrorMutex.unlock();
 
     // Old:
     setThreadBasedFirstCapiError_old(errMsg);
@@ -40,8 +43,10 @@ void CApiErrors::setLastWarningOrError(const char* functionName,const char* errM
 
 std::string CApiErrors::getAndClearLastWarningOrError()
 {
-    std::string retVal=_lastWarningOrError;
-    _lastWarningOrError.clear();
+    _lastWarningOrErrorMutex.lock("CApiErrors::getAndClearLastWarningOrError");
+    std::string retVal;
+    retVal.swap(_lastWarningOrError);
+    _lastWarningOrErrorMutex.unlock();
     return(retVal);
 }
 
@@ -50,29 +55,33 @@ std::string CApiErrors::getAndClearLastWarningOrError()
 VMutex _threadBasedFirstCapiErrorAndWarningMutex_old;
 std::vector<SThreadAndMsg_old> CApiErrors::_threadBasedFirstCapiWarning_old;
 std::vector<SThreadAndMsg_old> CApiErrors::_threadBasedFirstCapiError_old;
+std::atomic<int> CApiErrors::_threadBasedFirstCapiWarningCnt_old(0);
+std::atomic<int> CApiErrors::_threadBasedFirstCapiErrorCnt_old(0);
 void CApiErrors::clearThreadBasedFirstCapiErrorAndWarning_old()
 {
-    _clearThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiWarning_old);
-    _clearThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiError_old);
+    _clearThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiWarning_old,_threadBasedFirstCapiWarningCnt_old);
+    _clearThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiError_old,_threadBasedFirstCapiErrorCnt_old);
 }
 void CApiErrors::setThreadBasedFirstCapiWarning_old(const char* msg)
 {
-    _setThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiWarning_old,msg);
+    _setThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiWarning_old,_threadBasedFirstCapiWarningCnt_old,msg);
 }
 std::string CApiErrors::getAndClearThreadBasedFirstCapiWarning_old()
 {
-    return(_getAndClearThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiWarning_old));
+    return(_getAndClearThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiWarning_old,_threadBasedFirstCapiWarningCnt_old));
 }
 void CApiErrors::setThreadBasedFirstCapiError_old(const char* msg)
 {
-    _setThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiError_old,msg);
+    _setThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiError_old,_threadBasedFirstCapiErrorCnt_old,msg);
 }
 std::string CApiErrors::getAndClearThreadBasedFirstCapiError_old()
 {
-    return(_getAndClearThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiError_old));
+    return(_getAndClearThreadBasedFirstCapiMsg_old(_threadBasedFirstCapiError_old,_threadBasedFirstCapiErrorCnt_old));
 }
-void CApiErrors::_clearThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect)
-{
+void CApiErrors::_clearThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect,std::atomic<int>& cnt)
+{ // entries are only added by their own thread: if cnt is zero, there is nothing for this thread
+    if (cnt==0)
+        return;
     VTHREAD_ID_TYPE threadId=VThread::getCurrentThreadId();
     _threadBasedFirstCapiErrorAndWarningMutex_old.lock("");
     for (size_t i=0;i<vect.size();i++)
@@ -80,12 +89,13 @@ void CApiErrors::_clearThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old
         if (vect[i].threadId==threadId)
         {
             vect.erase(vect.begin()+i);
+            cnt--;
             break;
         }
     }
     _threadBasedFirstCapiErrorAndWarningMutex_old.unlock();
 }
-void CApiErrors::_setThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect,const char* msg)
+void CApiErrors::_setThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect,std::atomic<int>& cnt,const char* msg)
 {
     VTHREAD_ID_TYPE threadId=VThread::getCurrentThreadId();
     int index=-1;
@@ -104,12 +114,15 @@ void CApiErrors::_setThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>&
         v.threadId=threadId;
         v.message=msg;
         vect.push_back(v);
+        cnt++;
     }
     _threadBasedFirstCapiErrorAndWarningMutex_old.unlock();
 }
-std::string CApiErrors::_getAndClearThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect)
+std::string CApiErrors::_getAndClearThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect,std::atomic<int>& cnt)
 {
     std::string retVal;
+    if (cnt==0)
+        return(retVal);
     VTHREAD_ID_TYPE threadId=VThread::getCurrentThreadId();
     int index=-1;
     _threadBasedFirstCapiErrorAndWarningMutex_old.lock("");
@@ -125,6 +138,7 @@ std::string CApiErrors::_getAndClearThreadBasedFirstCapiMsg_old(std::vector<SThr
     {
         retVal=vect[size_t(index)].message;
         vect.erase(vect.begin()+size_t(index));
+        cnt--;
     }
     _threadBasedFirstCapiErrorAndWarningMutex_old.unlock();
     return(retVal);
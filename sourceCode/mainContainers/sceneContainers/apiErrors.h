@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 
 // Old:
 // ************************
@@ -92,6 +93,7 @@ struct SThreadAndMsg_old
 #define SIM_ERROR_CUSTOM_LUA_VAR_COULD_NOT_BE_REGISTERED            "custom variable could not be registered."
 #define SIM_ERROR_MAIN_WINDOW_NOT_INITIALIZED           "main window not initialized."
 #define SIM_ERROR_OPERATION_FAILED          "operation failed."
+#define SIM_ERROR_EVENT_FILTERS_IN_STREAMING_MODE           "event filters are not supported in CBOR event streaming mode."
 #define SIM_ERROR_INVALID_PARAMETER             "invalid parameter."
 #define SIM_ERROR_INVALID_FORMAT             "invalid format."
 #define SIM_ERROR_INVALID_ARGUMENT          "invalid argument."
@@ -200,9 +202,11 @@ private:
     static std::string _lastWarningOrError; // warnings start with "warning@"
 
     // Old:
-    static void _clearThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect);
-    static void _setThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect,const char* msg);
-    static std::string _getAndClearThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect);
+    static void _clearThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect,std::atomic<int>& cnt);
+    static void _setThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect,std::atomic<int>& cnt,const char* msg);
+    static std::string _getAndClearThreadBasedFirstCapiMsg_old(std::vector<SThreadAndMsg_old>& vect,std::atomic<int>& cnt);
     static std::vector<SThreadAndMsg_old> _threadBasedFirstCapiWarning_old;
     static std::vector<SThreadAndMsg_old> _threadBasedFirstCapiError_old;
+    static std::atomic<int> _threadBasedFirstCapiWarningCnt_old; // lets the (very frequent) calls with nothing to clear or get skip the mutex
+    static std::atomic<int> _threadBasedFirstCapiErrorCnt_old;
 };
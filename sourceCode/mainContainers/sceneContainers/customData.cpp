@@ -237,8 +237,8 @@ void CCustomData::serializeData(CSer &ar,const char* objectName)
     }
 }
 
-void CCustomData::appendEventData(CInterfaceStackTable* table) const
+void CCustomData::appendEventData(CEventData* data) const
 {
     for (size_t i=0;i<_data.size();i++)
-        table->appendMapObject_stringString(_data[i].tag.c_str(),_data[i].data.c_str(),_data[i].data.size());
+        data->appendMapObject_stringString(_data[i].tag.c_str(),_data[i].data.c_str(),_data[i].data.size());
 }
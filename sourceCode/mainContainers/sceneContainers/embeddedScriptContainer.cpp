@@ -7,9 +7,16 @@
 #include <simStrings.h>
 #include <app.h>
 #include <vDateTime.h>
+#include <luaStatePool.h>
+#include <scriptIsolation.h>
+#include <algorithm>
+
+std::atomic<unsigned long long int> CEmbeddedScriptContainer::_scriptsToExecuteGeneration(1);
 
 CEmbeddedScriptContainer::CEmbeddedScriptContainer()
 {
+    _scriptsToExecuteRebuilds=0;
+    _scriptsToExecuteRebuilds_lastStep=0;
     _sysFuncAndHookCnt_event=0;
     _sysFuncAndHookCnt_dyn=0;
     _sysFuncAndHookCnt_contact=0;
@@ -73,6 +80,7 @@ void CEmbeddedScriptContainer::simulationEnded()
     for (size_t i=0;i<_callbackStructureToDestroyAtEndOfSimulation_old.size();i++)
         delete _callbackStructureToDestroyAtEndOfSimulation_old[i];
     _callbackStructureToDestroyAtEndOfSimulation_old.clear();
+    CLuaStatePool::getDefaultPool()->refill(); // prepare the Lua states for the next simulation start
 //  if (_initialValuesInitialized&&App::currentWorld->simulation->getResetSceneAtSimulationEnd())
 //  {
 //  }
@@ -94,7 +102,9 @@ void CEmbeddedScriptContainer::addCallbackStructureObjectToDestroyAtTheEndOfSimu
 }
 
 void CEmbeddedScriptContainer::resetScriptFlagCalledInThisSimulationStep()
-{
+{ // called at the beginning of a simulation step
+    _scriptsToExecuteRebuilds_lastStep=_scriptsToExecuteRebuilds;
+    _scriptsToExecuteRebuilds=0;
     for (size_t i=0;i<allScripts.size();i++)
         allScripts[i]->resetCalledInThisSimulationStep();
 }
@@ -138,7 +148,12 @@ int CEmbeddedScriptContainer::removeDestroyedScripts(int scriptType)
                 it->resetScript(); // should not be done in the destructor!
                 allScripts.erase(allScripts.begin()+i);
                 i--;
+                _scriptIndexMutex.lock_simple("CEmbeddedScriptContainer::removeDestroyedScripts");
+                _unindexAttachment(it);
+                _scriptsFromHandle.erase(it->getScriptHandle());
+                _scriptIndexMutex.unlock_simple();
                 CScriptObject::destroy(it,true);
+                invalidateScriptsToExecute();
             }
         }
     }
@@ -155,6 +170,12 @@ void CEmbeddedScriptContainer::removeAllScripts()
         allScripts.erase(allScripts.begin());
         CScriptObject::destroy(it,true);
     }
+    _scriptIndexMutex.lock_simple("CEmbeddedScriptContainer::removeAllScripts");
+    _scriptsFromHandle.clear();
+    _scriptsFromAttachedObject.clear();
+    _attachmentKeys.clear();
+    _scriptIndexMutex.unlock_simple();
+    invalidateScriptsToExecute();
 }
 
 void CEmbeddedScriptContainer::killAllSimulationLuaStates()
@@ -206,7 +227,12 @@ bool CEmbeddedScriptContainer::removeScript(int scriptHandle)
             CScriptObject* it=allScripts[i];
             it->resetScript(); // should not be done in the destructor!
             allScripts.erase(allScripts.begin()+i);
+            _scriptIndexMutex.lock_simple("CEmbeddedScriptContainer::removeScript");
+            _unindexAttachment(it);
+            _scriptsFromHandle.erase(scriptHandle);
+            _scriptIndexMutex.unlock_simple();
             CScriptObject::destroy(it,true);
+            invalidateScriptsToExecute();
             App::worldContainer->setModificationFlag(16384);
             break;
         }
@@ -218,14 +244,11 @@ bool CEmbeddedScriptContainer::removeScript(int scriptHandle)
 CScriptObject* CEmbeddedScriptContainer::getScriptFromHandle(int scriptHandle) const
 {
     CScriptObject* retVal=nullptr;
-    for (size_t i=0;i<allScripts.size();i++)
-    {
-        if (allScripts[i]->getScriptHandle()==scriptHandle)
-        {
-            retVal=allScripts[i];
-            break;
-        }
-    }
+    _scriptIndexMutex.lock_simple("CEmbeddedScriptContainer::getScriptFromHandle");
+    auto it=_scriptsFromHandle.find(scriptHandle);
+    if (it!=_scriptsFromHandle.end())
+        retVal=it->second;
+    _scriptIndexMutex.unlock_simple();
     return(retVal);
 }
 
@@ -238,22 +261,33 @@ int CEmbeddedScriptContainer::getObjectHandleFromScriptHandle(int scriptHandle)
 }
 
 CScriptObject* CEmbeddedScriptContainer::getScriptFromObjectAttachedTo(int scriptType,int objectHandle) const
-{
+{ // scriptType -1: the child script if there is one, otherwise the customization script
     CScriptObject* retVal=nullptr;
     if (objectHandle>=0)
     {
-        for (size_t i=0;i<allScripts.size();i++)
+        _scriptIndexMutex.lock_simple("CEmbeddedScriptContainer::getScriptFromObjectAttachedTo");
+        if (scriptType!=-1)
+            retVal=_getIndexedAttachment(scriptType,objectHandle);
+        else
         {
-            if (allScripts[i]->getObjectHandleThatScriptIsAttachedTo(scriptType)==objectHandle)
-            {
-                retVal=allScripts[i];
-                break;
-            }
+            retVal=_getIndexedAttachment(sim_scripttype_childscript,objectHandle);
+            if (retVal==nullptr)
+                retVal=_getIndexedAttachment(sim_scripttype_customizationscript,objectHandle);
         }
+        _scriptIndexMutex.unlock_simple();
     }
     return(retVal);
 }
 
+CScriptObject* CEmbeddedScriptContainer::_getIndexedAttachment(int scriptType,int objectHandle) const
+{ // call with _scriptIndexMutex locked
+    CScriptObject* retVal=nullptr;
+    auto it=_scriptsFromAttachedObject.find((((long long int)objectHandle)<<32)|(unsigned int)scriptType);
+    if (it!=_scriptsFromAttachedObject.end())
+        retVal=it->second[0];
+    return(retVal);
+}
+
 int CEmbeddedScriptContainer::getScriptsFromObjectAttachedTo(int objectHandle,std::vector<CScriptObject*>& scripts) const
 {
     scripts.clear();
@@ -279,6 +313,11 @@ CScriptObject* CEmbeddedScriptContainer::getMainScript() const
 int CEmbeddedScriptContainer::insertScript(CScriptObject* script)
 {
     allScripts.push_back(script);
+    _scriptIndexMutex.lock_simple("CEmbeddedScriptContainer::insertScript");
+    _scriptsFromHandle[script->getScriptHandle()]=script;
+    _indexAttachment(script);
+    _scriptIndexMutex.unlock_simple();
+    invalidateScriptsToExecute();
     App::worldContainer->setModificationFlag(8192);
     return(script->getScriptHandle());
 }
@@ -470,8 +509,78 @@ void CEmbeddedScriptContainer::sceneOrModelAboutToBeSaved_old(int modelBase)
     }
 }
 
+void CEmbeddedScriptContainer::invalidateScriptsToExecute()
+{ // global: objects and scripts do not always know which world they belong to. A spurious rebuild is harmless
+    _scriptsToExecuteGeneration++;
+}
+
+void CEmbeddedScriptContainer::announceScriptAttachmentChanged(CScriptObject* script)
+{ // scripts that are not (yet) part of this container are indexed when inserted
+    _scriptIndexMutex.lock_simple("CEmbeddedScriptContainer::announceScriptAttachmentChanged");
+    auto it=_scriptsFromHandle.find(script->getScriptHandle());
+    if ( (it!=_scriptsFromHandle.end())&&(it->second==script) )
+    {
+        _unindexAttachment(script);
+        _indexAttachment(script);
+    }
+    _scriptIndexMutex.unlock_simple();
+}
+
+void CEmbeddedScriptContainer::_indexAttachment(CScriptObject* script)
+{ // call with _scriptIndexMutex locked
+    int objectHandle=script->getObjectHandleThatScriptIsAttachedTo(-1);
+    if (objectHandle>=0)
+    {
+        long long int key=(((long long int)objectHandle)<<32)|(unsigned int)script->getScriptType();
+        _attachmentKeys[script->getScriptHandle()]=key;
+        _scriptsFromAttachedObject[key].push_back(script); // with duplicates, the first script stays the attached one
+    }
+}
+
+void CEmbeddedScriptContainer::_unindexAttachment(CScriptObject* script)
+{ // call with _scriptIndexMutex locked
+    auto k=_attachmentKeys.find(script->getScriptHandle());
+    if (k!=_attachmentKeys.end())
+    {
+        auto it=_scriptsFromAttachedObject.find(k->second);
+        if (it!=_scriptsFromAttachedObject.end())
+        {
+            std::vector<CScriptObject*>& scripts=it->second; // almost always just one
+            scripts.erase(std::remove(scripts.begin(),scripts.end(),script),scripts.end());
+            if (scripts.size()==0)
+                _scriptsFromAttachedObject.erase(it);
+        }
+        _attachmentKeys.erase(k);
+    }
+}
+
+size_t CEmbeddedScriptContainer::getScriptsToExecuteRebuildCount(bool lastStep) const
+{
+    if (lastStep)
+        return(_scriptsToExecuteRebuilds_lastStep);
+    return(_scriptsToExecuteRebuilds);
+}
+
 size_t CEmbeddedScriptContainer::_getScriptsToExecute(std::vector<int>& scriptHandles,int scriptType) const
 { // returns all non-disabled scripts, from leaf to root. With scriptType==-1, returns child and customization scripts
+  // The list is cached, and only rebuilt after a call to invalidateScriptsToExecute or when the simulation state changes
+    unsigned long long int generation=_scriptsToExecuteGeneration;
+    bool simStopped=App::currentWorld->simulation->isSimulationStopped();
+    SScriptsToExecuteCache& cache=_scriptsToExecuteCache[scriptType];
+    if ( (cache.generation!=generation)||(cache.simulationStopped!=simStopped) )
+    {
+        cache.generation=generation;
+        cache.simulationStopped=simStopped;
+        cache.scriptHandles.clear();
+        _getScriptsToExecute_noCache(cache.scriptHandles,scriptType);
+        _scriptsToExecuteRebuilds++;
+    }
+    scriptHandles.insert(scriptHandles.end(),cache.scriptHandles.begin(),cache.scriptHandles.end());
+    return(scriptHandles.size());
+}
+
+size_t CEmbeddedScriptContainer::_getScriptsToExecute_noCache(std::vector<int>& scriptHandles,int scriptType) const
+{
     std::vector<CSceneObject*> objects;
     std::vector<CSceneObject*> objectsNormalPriority;
     std::vector<CSceneObject*> objectsLastPriority;
@@ -547,12 +656,15 @@ int CEmbeddedScriptContainer::callChildAndEmbeddedScripts(int scriptType,int cal
         if (CScriptObject::isSystemCallbackInReverseOrder(callTypeOrResumeLocation))
             std::reverse(scriptHandles.begin(),scriptHandles.end());
         bool canInterrupt=CScriptObject::isSystemCallbackInterruptible(callTypeOrResumeLocation);
+        std::vector<int> isolatedScriptHandles;
         for (size_t i=0;i<scriptHandles.size();i++)
         {
             CScriptObject* script=getScriptFromHandle(scriptHandles[i]);
             if (script!=nullptr)
             { // the script could have been erased in the mean time
-                if (script->getThreadedExecution_oldThreads())
+                if ( (callTypeOrResumeLocation==sim_syscb_sensing)&&(App::userSettings->isolatedScriptThreads>=0)&&script->canRunSensingIsolated() )
+                    isolatedScriptHandles.push_back(scriptHandles[i]); // runs below, concurrently with other isolated scripts
+                else if (script->getThreadedExecution_oldThreads())
                 { // is an old, threaded script
                     if (callTypeOrResumeLocation==sim_scriptthreadresume_launch)
                     {
@@ -591,6 +703,19 @@ int CEmbeddedScriptContainer::callChildAndEmbeddedScripts(int scriptType,int cal
                 }
             }
         }
+        std::vector<CScriptObject*> isolatedScripts;
+        for (size_t i=0;i<isolatedScriptHandles.size();i++)
+        {
+            CScriptObject* script=getScriptFromHandle(isolatedScriptHandles[i]);
+            if ( (script!=nullptr)&&script->canRunSensingIsolated() )
+                isolatedScripts.push_back(script); // the script could have been erased in the mean time
+        }
+        if (isolatedScripts.size()>0)
+        {
+            for (size_t i=0;i<App::currentWorld->sceneObjects->getObjectCount();i++)
+                App::currentWorld->sceneObjects->getObjectFromIndex(i)->getFullCumulativeTransformation(); // fills the transformation caches, which workers only read
+            cnt+=CScriptIsolation::runSensing(isolatedScripts);
+        }
     }
     else
     { // old routine
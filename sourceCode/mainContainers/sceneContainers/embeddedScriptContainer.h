@@ -3,9 +3,19 @@
 #include <scriptObject.h>
 #include <broadcastDataContainer.h>
 #include <simInternal.h>
+#include <atomic>
+#include <map>
+#include <unordered_map>
 
 class CSceneObject;
 
+struct SScriptsToExecuteCache
+{
+    unsigned long long int generation;
+    bool simulationStopped;
+    std::vector<int> scriptHandles;
+};
+
 class CEmbeddedScriptContainer
 {
 public:
@@ -47,12 +57,17 @@ public:
     void sceneOrModelAboutToBeSaved_old(int modelBase);
     int getEquivalentScriptExecPriority_old(int objectHandle) const;
 
+    static void invalidateScriptsToExecute(); // call when the hierarchy, script attachments or exec priorities change
+    size_t getScriptsToExecuteRebuildCount(bool lastStep) const;
+    void announceScriptAttachmentChanged(CScriptObject* script); // call when a script gets attached to another object, or detached
+
     std::vector<CScriptObject*> allScripts;
 
     CBroadcastDataContainer broadcastDataContainer;
 
 protected:
     size_t _getScriptsToExecute(std::vector<int>& scriptHandles,int scriptType) const;
+    size_t _getScriptsToExecute_noCache(std::vector<int>& scriptHandles,int scriptType) const;
     int _getScriptsToExecute_old(int scriptType,std::vector<CScriptObject*>& scripts,std::vector<int>& uniqueIds) const;
 
     int _sysFuncAndHookCnt_event;
@@ -61,4 +76,18 @@ protected:
     int _sysFuncAndHookCnt_joint;
     std::vector<SScriptCallBack*> _callbackStructureToDestroyAtEndOfSimulation_new;
     std::vector<SLuaCallBack*> _callbackStructureToDestroyAtEndOfSimulation_old;
+
+    mutable std::map<int,SScriptsToExecuteCache> _scriptsToExecuteCache; // key is the script type
+    mutable size_t _scriptsToExecuteRebuilds;
+    size_t _scriptsToExecuteRebuilds_lastStep;
+    static std::atomic<unsigned long long int> _scriptsToExecuteGeneration;
+
+    // The indices below are maintained by the simulation thread, and read from any thread. Always accessed under _scriptIndexMutex:
+    void _indexAttachment(CScriptObject* script);
+    void _unindexAttachment(CScriptObject* script);
+    CScriptObject* _getIndexedAttachment(int scriptType,int objectHandle) const;
+    std::unordered_map<int,CScriptObject*> _scriptsFromHandle;
+    std::unordered_map<long long int,std::vector<CScriptObject*>> _scriptsFromAttachedObject; // key is (objectHandle<<32)|scriptType. In insertion order
+    std::unordered_map<int,long long int> _attachmentKeys; // script handle --> key in _scriptsFromAttachedObject
+    mutable VMutex _scriptIndexMutex;
 };
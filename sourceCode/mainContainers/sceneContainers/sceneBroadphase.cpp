@@ -0,0 +1,244 @@
+#include <sceneBroadphase.h>
+#include <sceneObject.h>
+#include <shape.h>
+#include <octree.h>
+#include <pointCloud.h>
+#include <algorithm>
+#include <cmath>
+
+#define SCENEBROADPHASE_MIN_REMOVED_FOR_REBUILD 64
+
+CSceneBroadphase::CSceneBroadphase()
+{
+    _rebuildCount=0;
+    _refitCount=0;
+    clear();
+    CSceneObject::trackSpatialChanges(true);
+}
+
+CSceneBroadphase::~CSceneBroadphase()
+{
+    CSceneObject::trackSpatialChanges(false);
+}
+
+void CSceneBroadphase::clear()
+{
+    _tree.clear();
+    _objects.clear();
+    _proxies.clear();
+    _unboundedIds.clear();
+    _uidIds.clear();
+    _removedCount=0;
+    _spatialChangesTake=0;
+}
+
+void CSceneBroadphase::rebuild(const std::vector<CSceneObject*>& objects,const std::vector<C7Vector>* transformations/*=nullptr*/)
+{
+    clear();
+    std::vector<long long int> uids;
+    CSceneObject::takeSpatialChanges(_spatialChangesTake,uids); // take first: changes during the rebuild trigger a refit
+    for (size_t i=0;i<objects.size();i++)
+    {
+        if (transformations!=nullptr)
+            addObject(objects[i],&transformations->at(i));
+        else
+            addObject(objects[i]);
+    }
+    _rebuildCount++;
+}
+
+void CSceneBroadphase::addObject(CSceneObject* obj,const C7Vector* transformation/*=nullptr*/)
+{
+    if (obj->isPotentiallyCollidable()||obj->isPotentiallyMeasurable()||obj->isPotentiallyDetectable())
+    {
+        int id=int(_objects.size());
+        _objects.push_back(obj);
+        _uidIds.insert(obj->getObjectUid(),id);
+        C7Vector tr;
+        C3Vector halfSize;
+        if (getObjectBox(obj,tr,halfSize,transformation))
+        {
+            C3Vector boxMin,boxMax;
+            _getWorldBox(tr,halfSize,0.0,boxMin,boxMax);
+            _proxies.push_back(_tree.createProxy(boxMin,boxMax,id));
+        }
+        else
+        {
+            _proxies.push_back(-1);
+            _unboundedIds.push_back(id);
+        }
+    }
+}
+
+void CSceneBroadphase::removeObject(CSceneObject* obj)
+{
+    const int* it=_uidIds.find(obj->getObjectUid());
+    if ( (it!=nullptr)&&(_objects[*it]==obj) )
+    {
+        int id=*it;
+        _uidIds.erase(obj->getObjectUid());
+        if (_proxies[id]!=-1)
+            _tree.destroyProxy(_proxies[id]);
+        else
+            _unboundedIds.erase(std::find(_unboundedIds.begin(),_unboundedIds.end(),id));
+        _objects[id]=nullptr;
+        _proxies[id]=-1;
+        _removedCount++;
+        if ( (_removedCount>=SCENEBROADPHASE_MIN_REMOVED_FOR_REBUILD)&&(2*_removedCount>=_objects.size()) )
+        { // compact the ids
+            std::vector<CSceneObject*> objects;
+            for (size_t i=0;i<_objects.size();i++)
+            {
+                if (_objects[i]!=nullptr)
+                    objects.push_back(_objects[i]);
+            }
+            rebuild(objects);
+        }
+    }
+}
+
+void CSceneBroadphase::refit()
+{ // proxies only move in the tree when they leave their enlarged box
+    std::vector<long long int> uids;
+    if (CSceneObject::takeSpatialChanges(_spatialChangesTake,uids))
+    {
+        if (uids.size()>0)
+        {
+            for (size_t i=0;i<uids.size();i++)
+            {
+                const int* it=_uidIds.find(uids[i]);
+                if (it!=nullptr)
+                    _refitObject(*it);
+            }
+            _refitCount++;
+        }
+    }
+    else
+    { // e.g. the broadphase of another scene took some changes
+        for (size_t i=0;i<_objects.size();i++)
+            _refitObject(int(i));
+        _refitCount++;
+    }
+}
+
+void CSceneBroadphase::getCandidates(const std::vector<CSceneObject*>& objects,double margin,std::vector<CSceneObject*>& candidates) const
+{ // candidates whose bounding box is within margin of the bounding box of one of the objects. Objects without bounding box
+  // overlap everything
+    std::vector<int> ids;
+    for (size_t i=0;i<objects.size();i++)
+    {
+        C7Vector tr;
+        C3Vector halfSize;
+        if (!getObjectBox(objects[i],tr,halfSize))
+        {
+            candidates.clear();
+            for (size_t j=0;j<_objects.size();j++)
+            {
+                if (_objects[j]!=nullptr)
+                    candidates.push_back(_objects[j]);
+            }
+            return;
+        }
+        C3Vector boxMin,boxMax;
+        _getWorldBox(tr,halfSize,margin,boxMin,boxMax);
+        _tree.query(boxMin,boxMax,ids);
+    }
+    _getCandidatesFromIds(ids,candidates);
+}
+
+void CSceneBroadphase::getCandidates(const C7Vector& boxTr,const C3Vector& boxHalfSize,double margin,std::vector<CSceneObject*>& candidates) const
+{
+    C3Vector boxMin,boxMax;
+    _getWorldBox(boxTr,boxHalfSize,margin,boxMin,boxMax);
+    std::vector<int> ids;
+    _tree.query(boxMin,boxMax,ids);
+    _getCandidatesFromIds(ids,candidates);
+}
+
+size_t CSceneBroadphase::getProxyCount() const
+{
+    return(_tree.getProxyCount());
+}
+
+int CSceneBroadphase::getTreeHeight() const
+{
+    return(_tree.getHeight());
+}
+
+size_t CSceneBroadphase::getRebuildCount() const
+{
+    return(_rebuildCount);
+}
+
+size_t CSceneBroadphase::getRefitCount() const
+{
+    return(_refitCount);
+}
+
+bool CSceneBroadphase::getObjectBox(const CSceneObject* obj,C7Vector& tr,C3Vector& halfSize,const C7Vector* objTr/*=nullptr*/)
+{ // same boxes as in the collision, distance and proximity sensor routines. objTr: obj's full cumulative transformation, if already known
+    bool retVal=true;
+    if (obj->getObjectType()==sim_object_shape_type)
+    {
+        halfSize=((const CShape*)obj)->getBoundingBoxHalfSizes();
+        if (objTr!=nullptr)
+            tr=*objTr;
+        else
+            tr=obj->getFullCumulativeTransformation();
+    }
+    else if (obj->getObjectType()==sim_object_dummy_type)
+    {
+        halfSize=C3Vector(0.0001,0.0001,0.0001);
+        if (objTr!=nullptr)
+            tr=*objTr;
+        else
+            tr=obj->getFullCumulativeTransformation();
+    }
+    else if (obj->getObjectType()==sim_object_octree_type)
+        ((const COctree*)obj)->getTransfAndHalfSizeOfBoundingBox(tr,halfSize);
+    else if (obj->getObjectType()==sim_object_pointcloud_type)
+        ((const CPointCloud*)obj)->getTransfAndHalfSizeOfBoundingBox(tr,halfSize);
+    else
+        retVal=false;
+    return(retVal);
+}
+
+void CSceneBroadphase::_getWorldBox(const C7Vector& tr,const C3Vector& halfSize,double margin,C3Vector& boxMin,C3Vector& boxMax)
+{ // axis-aligned box enclosing the oriented box
+    C4X4Matrix m(tr.getMatrix());
+    for (size_t i=0;i<3;i++)
+    {
+        double extent=margin;
+        for (size_t j=0;j<3;j++)
+            extent+=fabs(m.M.axis[j](i))*halfSize(j);
+        boxMin(i)=m.X(i)-extent;
+        boxMax(i)=m.X(i)+extent;
+    }
+}
+
+void CSceneBroadphase::_getObjectWorldBox(const CSceneObject* obj,double margin,C3Vector& boxMin,C3Vector& boxMax) const
+{
+    C7Vector tr;
+    C3Vector halfSize;
+    getObjectBox(obj,tr,halfSize);
+    _getWorldBox(tr,halfSize,margin,boxMin,boxMax);
+}
+
+void CSceneBroadphase::_refitObject(int id)
+{
+    if (_proxies[id]!=-1)
+    {
+        C3Vector boxMin,boxMax;
+        _getObjectWorldBox(_objects[id],0.0,boxMin,boxMax);
+        _tree.moveProxy(_proxies[id],boxMin,boxMax);
+    }
+}
+
+void CSceneBroadphase::_getCandidatesFromIds(std::vector<int>& ids,std::vector<CSceneObject*>& candidates) const
+{ // candidates are returned in container order, as without broadphase
+    ids.insert(ids.end(),_unboundedIds.begin(),_unboundedIds.end());
+    std::sort(ids.begin(),ids.end());
+    ids.erase(std::unique(ids.begin(),ids.end()),ids.end());
+    for (size_t i=0;i<ids.size();i++)
+        candidates.push_back(_objects[ids[i]]);
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <aabbTree.h>
+#include <flatHashMap.h>
+#include <simMath/7Vector.h>
+#include <vector>
+
+class CSceneObject;
+
+class CSceneBroadphase
+{ // Dynamic AABB tree over the potentially collidable, measurable or detectable objects of a scene (see the sceneBroadphase user setting).
+  // The collision, distance and proximity sensor routines use it when checking against all objects, so that they only visit nearby
+  // objects. It is conservative: candidates still go through the routines' own bounding box and exact checks
+public:
+    CSceneBroadphase();
+    virtual ~CSceneBroadphase();
+
+    void clear();
+    void rebuild(const std::vector<CSceneObject*>& objects,const std::vector<C7Vector>* transformations=nullptr); // objects in container order. transformations: their full cumulative transformations, if already known
+    void addObject(CSceneObject* obj,const C7Vector* transformation=nullptr); // obj was appended to the container
+    void removeObject(CSceneObject* obj);
+    void refit(); // objects that moved or were resized since the last rebuild or refit
+    void getCandidates(const std::vector<CSceneObject*>& objects,double margin,std::vector<CSceneObject*>& candidates) const;
+    void getCandidates(const C7Vector& boxTr,const C3Vector& boxHalfSize,double margin,std::vector<CSceneObject*>& candidates) const;
+
+    size_t getProxyCount() const;
+    int getTreeHeight() const;
+    size_t getRebuildCount() const;
+    size_t getRefitCount() const;
+
+    static bool getObjectBox(const CSceneObject* obj,C7Vector& tr,C3Vector& halfSize,const C7Vector* objTr=nullptr); // false if the object has no bounding box
+
+private:
+    static void _getWorldBox(const C7Vector& tr,const C3Vector& halfSize,double margin,C3Vector& boxMin,C3Vector& boxMax);
+    void _getObjectWorldBox(const CSceneObject* obj,double margin,C3Vector& boxMin,C3Vector& boxMax) const;
+    void _getCandidatesFromIds(std::vector<int>& ids,std::vector<CSceneObject*>& candidates) const;
+    void _refitObject(int id);
+
+    CAabbTree _tree;
+    std::vector<CSceneObject*> _objects; // id --> object, nullptr for removed objects. Ids follow the container order
+    std::vector<int> _proxies; // id --> proxy, -1 for objects without bounding box
+    std::vector<int> _unboundedIds; // objects without bounding box are always candidates
+    CFlatHashMap<long long int,int> _uidIds; // object uid --> id
+    size_t _removedCount; // ids of removed objects are not reused, until the next rebuild
+    unsigned long long int _spatialChangesTake; // see CSceneObject::takeSpatialChanges
+    size_t _rebuildCount;
+    size_t _refitCount;
+};
@@ -11,6 +11,9 @@
 #include <iostream>
 #include <simFlavor.h>
 
+static VMutex _broadphaseMutex;
+static VMutex _worldTransformStoreMutex;
+
 CSceneObjectContainer::CSceneObjectContainer()
 {
     _objectActualizationEnabled=true;
@@ -18,11 +21,16 @@ CSceneObjectContainer::CSceneObjectContainer()
     _objectCreationCounter=0;
     _objectDestructionCounter=0;
     _hierarchyChangeCounter=0;
+    _worldTransformStore=nullptr;
+    _lastWorldTransformationUpdateCount=0;
+    _broadphase=nullptr;
 }
 
 CSceneObjectContainer::~CSceneObjectContainer()
 { // beware, the current world could be nullptr
     eraseAllObjects(false); // should already have been done
+    delete _worldTransformStore;
+    delete _broadphase;
 }
 
 void CSceneObjectContainer::simulationAboutToStart()
@@ -415,6 +423,151 @@ int CSceneObjectContainer::getHierarchyChangeCounter() const
     return(_hierarchyChangeCounter);
 }
 
+void CSceneObjectContainer::updateWorldTransformations()
+{ // simulation thread only. Updates all dirty world poses in one linear sweep, if the world transformation store is enabled
+    _worldTransformStoreMutex.lock_simple("CSceneObjectContainer::updateWorldTransformations");
+    _updateWorldTransformStore();
+    _worldTransformStoreMutex.unlock_simple();
+}
+
+void CSceneObjectContainer::getWorldTransformations(const std::vector<CSceneObject*>& objects,std::vector<C7Vector>& transformations)
+{ // batch read, from the world transformation store if enabled and current. Other threads than the simulation thread do not update it
+    transformations.resize(objects.size());
+    bool done=false;
+    if (App::userSettings->worldTransformStore)
+    {
+        _worldTransformStoreMutex.lock_simple("CSceneObjectContainer::getWorldTransformations");
+        bool current=false;
+        if (VThread::isCurrentThreadTheMainSimulationThread())
+            current=_updateWorldTransformStore();
+        else
+            current=( (_worldTransformStore!=nullptr)&&_worldTransformStore->isCurrent(_getStructure()) );
+        if (current)
+        {
+            const C7Vector* poses=_worldTransformStore->getWorldPoses();
+            for (size_t i=0;i<objects.size();i++)
+            {
+                int slot=_worldTransformStore->getSlot(objects[i]->getObjectUid());
+                if (slot>=0)
+                    transformations[i]=poses[slot];
+                else
+                    transformations[i]=objects[i]->getFullCumulativeTransformation();
+            }
+            done=true;
+        }
+        _worldTransformStoreMutex.unlock_simple();
+    }
+    if (!done)
+    {
+        for (size_t i=0;i<objects.size();i++)
+            transformations[i]=objects[i]->getFullCumulativeTransformation();
+    }
+}
+
+bool CSceneObjectContainer::getWorldTransformStoreStats(size_t& slots,size_t& rebuilds,size_t& recomputed)
+{ // recomputed is the number of world poses recomputed by the last update
+    _worldTransformStoreMutex.lock_simple("CSceneObjectContainer::getWorldTransformStoreStats");
+    bool retVal=(_worldTransformStore!=nullptr);
+    if (retVal)
+    {
+        slots=_worldTransformStore->getSlotCount();
+        rebuilds=_worldTransformStore->getRebuildCount();
+        recomputed=_lastWorldTransformationUpdateCount;
+    }
+    _worldTransformStoreMutex.unlock_simple();
+    return(retVal);
+}
+
+bool CSceneObjectContainer::_updateWorldTransformStore()
+{ // simulation thread only. Returns true if the store is enabled and current
+    if (App::userSettings->worldTransformStore)
+    {
+        if (_worldTransformStore==nullptr)
+            _worldTransformStore=new CWorldTransformStore();
+        long long int structure=_getStructure();
+        if (_worldTransformStore->getStructure()!=structure)
+        {
+            std::vector<CSceneObject*> objects;
+            getObjects_hierarchyOrder(objects);
+            _worldTransformStore->rebuild(objects,structure);
+        }
+        if (!_worldTransformStore->isCurrent(structure))
+            _lastWorldTransformationUpdateCount=_worldTransformStore->update();
+        return(true);
+    }
+    delete _worldTransformStore;
+    _worldTransformStore=nullptr;
+    return(false);
+}
+
+long long int CSceneObjectContainer::_getStructure() const
+{ // changes when objects are added or removed, or when the hierarchy changes
+    return((long long int)_objectCreationCounter+(long long int)_objectDestructionCounter+(long long int)_hierarchyChangeCounter);
+}
+
+bool CSceneObjectContainer::_updateBroadphase()
+{ // call with _broadphaseMutex locked
+    if (App::userSettings->sceneBroadphase)
+    {
+        if (_broadphase==nullptr)
+        { // then kept up to date by _addObject and _removeObject
+            _broadphase=new CSceneBroadphase();
+            std::vector<CSceneObject*> objects;
+            for (size_t i=0;i<getObjectCount();i++)
+                objects.push_back(getObjectFromIndex(i));
+            if (App::userSettings->worldTransformStore)
+            {
+                std::vector<C7Vector> transformations;
+                getWorldTransformations(objects,transformations); // batch read
+                _broadphase->rebuild(objects,&transformations);
+            }
+            else
+                _broadphase->rebuild(objects);
+        }
+        else
+            _broadphase->refit();
+        return(true);
+    }
+    delete _broadphase;
+    _broadphase=nullptr;
+    return(false);
+}
+
+bool CSceneObjectContainer::getBroadphaseCandidates(const std::vector<CSceneObject*>& objects,double margin,std::vector<CSceneObject*>& candidates)
+{ // candidates whose bounding box is within margin of one of the objects' bounding box, in container order
+    _broadphaseMutex.lock_simple("CSceneObjectContainer::getBroadphaseCandidates");
+    bool retVal=_updateBroadphase();
+    if (retVal)
+        _broadphase->getCandidates(objects,margin,candidates);
+    _broadphaseMutex.unlock_simple();
+    return(retVal);
+}
+
+bool CSceneObjectContainer::getBroadphaseCandidates(const C7Vector& boxTr,const C3Vector& boxHalfSize,double margin,std::vector<CSceneObject*>& candidates)
+{ // candidates whose bounding box is within margin of the box, in container order
+    _broadphaseMutex.lock_simple("CSceneObjectContainer::getBroadphaseCandidates");
+    bool retVal=_updateBroadphase();
+    if (retVal)
+        _broadphase->getCandidates(boxTr,boxHalfSize,margin,candidates);
+    _broadphaseMutex.unlock_simple();
+    return(retVal);
+}
+
+bool CSceneObjectContainer::getBroadphaseStats(size_t& proxies,int& height,size_t& rebuilds,size_t& refits)
+{
+    _broadphaseMutex.lock_simple("CSceneObjectContainer::getBroadphaseStats");
+    bool retVal=(_broadphase!=nullptr);
+    if (retVal)
+    {
+        proxies=_broadphase->getProxyCount();
+        height=_broadphase->getTreeHeight();
+        rebuilds=_broadphase->getRebuildCount();
+        refits=_broadphase->getRefitCount();
+    }
+    _broadphaseMutex.unlock_simple();
+    return(retVal);
+}
+
 void CSceneObjectContainer::setTextureDependencies()
 { // here we cannot use shapeList, because that list may not yet be actualized (e.g. during a scene/model load operation)!!
     for (size_t i=0;i<getObjectCount();i++)
@@ -468,11 +621,18 @@ void CSceneObjectContainer::pushGenesisEvents() const
         orderedObjects[i]->pushObjectCreationEvent();
 }
 
-void CSceneObjectContainer::getAllCollidableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects)
+void CSceneObjectContainer::getAllCollidableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects,const std::vector<CSceneObject*>* candidates/*=nullptr*/)
 {
-    for (size_t i=0;i<getObjectCount();i++)
-    {
-        CSceneObject* it=getObjectFromIndex(i);
+    size_t cnt=getObjectCount();
+    if (candidates!=nullptr)
+        cnt=candidates->size();
+    for (size_t i=0;i<cnt;i++)
+    {
+        CSceneObject* it;
+        if (candidates!=nullptr)
+            it=candidates->at(i);
+        else
+            it=getObjectFromIndex(i);
         if (it->isPotentiallyCollidable())
         {
             if (it->getCumulativeObjectSpecialProperty()&sim_objectspecialproperty_collidable)
@@ -496,11 +656,18 @@ void CSceneObjectContainer::getAllCollidableObjectsFromSceneExcept(const std::ve
     }
 }
 
-void CSceneObjectContainer::getAllMeasurableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects)
+void CSceneObjectContainer::getAllMeasurableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects,const std::vector<CSceneObject*>* candidates/*=nullptr*/)
 {
-    for (size_t i=0;i<getObjectCount();i++)
-    {
-        CSceneObject* it=getObjectFromIndex(i);
+    size_t cnt=getObjectCount();
+    if (candidates!=nullptr)
+        cnt=candidates->size();
+    for (size_t i=0;i<cnt;i++)
+    {
+        CSceneObject* it;
+        if (candidates!=nullptr)
+            it=candidates->at(i);
+        else
+            it=getObjectFromIndex(i);
         if (it->isPotentiallyMeasurable())
         {
             if (it->getCumulativeObjectSpecialProperty()&sim_objectspecialproperty_measurable)
@@ -524,11 +691,18 @@ void CSceneObjectContainer::getAllMeasurableObjectsFromSceneExcept(const std::ve
     }
 }
 
-void CSceneObjectContainer::getAllDetectableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects,int detectableMask)
+void CSceneObjectContainer::getAllDetectableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects,int detectableMask,const std::vector<CSceneObject*>* candidates/*=nullptr*/)
 {
-    for (size_t i=0;i<getObjectCount();i++)
-    {
-        CSceneObject* it=getObjectFromIndex(i);
+    size_t cnt=getObjectCount();
+    if (candidates!=nullptr)
+        cnt=candidates->size();
+    for (size_t i=0;i<cnt;i++)
+    {
+        CSceneObject* it;
+        if (candidates!=nullptr)
+            it=candidates->at(i);
+        else
+            it=getObjectFromIndex(i);
         if (it->isPotentiallyDetectable())
         {
             if ( (it->getCumulativeObjectSpecialProperty()&detectableMask)||(detectableMask==-1) )
@@ -1270,7 +1444,8 @@ bool CSceneObjectContainer::setSelectedObjectHandles(const std::vector<int>* v)
 }
 
 void CSceneObjectContainer::_handleOrderIndexOfOrphans()
-{
+{ // called after each change of the orphan list
+    CEmbeddedScriptContainer::invalidateScriptsToExecute();
     std::map<std::string,int> nameMap;
     std::vector<int> co(getOrphanCount());
     for (size_t i=0;i<getOrphanCount();i++)
@@ -2214,6 +2389,10 @@ void CSceneObjectContainer::_addObject(CSceneObject* object)
         object->buildUpdateAndPopulateSynchronizationObject(nullptr);
 
     _objectCreationCounter++;
+    _broadphaseMutex.lock_simple("CSceneObjectContainer::_addObject");
+    if (_broadphase!=nullptr)
+        _broadphase->addObject(object);
+    _broadphaseMutex.unlock_simple();
 }
 
 void CSceneObjectContainer::_removeObject(CSceneObject* object)
@@ -2229,6 +2408,14 @@ void CSceneObjectContainer::_removeObject(CSceneObject* object)
     App::setRebuildHierarchyFlag();
 
     _objectDestructionCounter++;
+    _worldTransformStoreMutex.lock_simple("CSceneObjectContainer::_removeObject");
+    if (_worldTransformStore!=nullptr)
+        _worldTransformStore->clear(); // no dangling pointers until the next rebuild
+    _worldTransformStoreMutex.unlock_simple();
+    _broadphaseMutex.lock_simple("CSceneObjectContainer::_removeObject");
+    if (_broadphase!=nullptr)
+        _broadphase->removeObject(object);
+    _broadphaseMutex.unlock_simple();
 }
 
 void CSceneObjectContainer::buildUpdateAndPopulateSynchronizationObjects()
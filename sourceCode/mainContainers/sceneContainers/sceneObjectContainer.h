@@ -14,6 +14,8 @@
 #include <sceneObject.h>
 #include <jointObject.h>
 #include <_sceneObjectContainer_.h>
+#include <worldTransformStore.h>
+#include <sceneBroadphase.h>
 
 struct SSimpleXmlSceneObject
 {
@@ -58,6 +60,12 @@ public:
     int getObjectCreationCounter() const;
     int getObjectDestructionCounter() const;
     int getHierarchyChangeCounter() const;
+    void updateWorldTransformations(); // once per simulation step
+    void getWorldTransformations(const std::vector<CSceneObject*>& objects,std::vector<C7Vector>& transformations); // full cumulative transformations
+    bool getWorldTransformStoreStats(size_t& slots,size_t& rebuilds,size_t& recomputed);
+    bool getBroadphaseCandidates(const std::vector<CSceneObject*>& objects,double margin,std::vector<CSceneObject*>& candidates); // false if the broadphase is disabled
+    bool getBroadphaseCandidates(const C7Vector& boxTr,const C3Vector& boxHalfSize,double margin,std::vector<CSceneObject*>& candidates);
+    bool getBroadphaseStats(size_t& proxies,int& height,size_t& rebuilds,size_t& refits);
 
     void setTextureDependencies();
     void removeSceneDependencies();
@@ -65,9 +73,9 @@ public:
     void checkObjectIsInstanciated(CSceneObject* obj,const char* location) const;
     void pushGenesisEvents() const;
 
-    void getAllCollidableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects);
-    void getAllMeasurableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects);
-    void getAllDetectableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects,int detectableMask);
+    void getAllCollidableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects,const std::vector<CSceneObject*>* candidates=nullptr); // candidates: e.g. from the broadphase, otherwise all objects
+    void getAllMeasurableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects,const std::vector<CSceneObject*>* candidates=nullptr);
+    void getAllDetectableObjectsFromSceneExcept(const std::vector<CSceneObject*>* exceptionObjects,std::vector<CSceneObject*>& objects,int detectableMask,const std::vector<CSceneObject*>* candidates=nullptr);
 
     CSceneObject* readSceneObject(CSer& ar,const char* name,bool& noHit);
     void writeSceneObject(CSer& ar,CSceneObject* it);
@@ -120,6 +128,14 @@ private:
     int _objectCreationCounter;
     int _objectDestructionCounter;
     int _hierarchyChangeCounter;
+
+    bool _updateWorldTransformStore(); // call with _worldTransformStoreMutex locked
+    long long int _getStructure() const;
+    CWorldTransformStore* _worldTransformStore;
+    size_t _lastWorldTransformationUpdateCount;
+
+    bool _updateBroadphase();
+    CSceneBroadphase* _broadphase;
 };
 
 
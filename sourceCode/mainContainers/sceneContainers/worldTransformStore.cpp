@@ -0,0 +1,119 @@
+#include <worldTransformStore.h>
+#include <sceneObject.h>
+
+CWorldTransformStore::CWorldTransformStore()
+{
+    _rebuildCount=0;
+    clear();
+}
+
+CWorldTransformStore::~CWorldTransformStore()
+{
+}
+
+void CWorldTransformStore::clear()
+{
+    _objects.clear();
+    _parentSlots.clear();
+    _localPoses.clear();
+    _worldPoses.clear();
+    _slots.clear();
+    _structure=-1;
+    _transformationGeneration=0;
+}
+
+void CWorldTransformStore::rebuild(const std::vector<CSceneObject*>& objectsInHierarchyOrder,long long int structure)
+{
+    clear();
+    _objects.assign(objectsInHierarchyOrder.begin(),objectsInHierarchyOrder.end());
+    _parentSlots.resize(_objects.size(),-1);
+    _localPoses.resize(_objects.size());
+    _worldPoses.resize(_objects.size());
+    for (size_t i=0;i<_objects.size();i++)
+    {
+        _slots.insert(_objects[i]->getObjectUid(),int(i));
+        CSceneObject* parent=_objects[i]->getParent();
+        if (parent!=nullptr)
+            _parentSlots[i]=getSlot(parent->getObjectUid()); // parents come first
+        _localPoses[i].setIdentity();
+        _worldPoses[i].setIdentity();
+    }
+    _structure=structure;
+    _rebuildCount++;
+}
+
+size_t CWorldTransformStore::update()
+{
+    size_t retVal=0;
+    _transformationGeneration=CSceneObject::getTransformationGeneration(); // read first: changes during the sweep make the store not current
+    for (size_t i=0;i<_objects.size();i++)
+    {
+        CSceneObject* obj=_objects[i];
+        _localPoses[i]=obj->getFullLocalTransformation();
+        if (obj->isFullCumulativeTransformationCached())
+            _worldPoses[i]=obj->getFullCumulativeTransformation();
+        else
+        { // dirty
+            int p=_parentSlots[i];
+            if (p==-1)
+                _worldPoses[i]=_localPoses[i];
+            else
+                _worldPoses[i]=_worldPoses[p]*_localPoses[i];
+            obj->setFullCumulativeTransformationCache(_worldPoses[i]);
+            retVal++;
+        }
+    }
+    return(retVal);
+}
+
+bool CWorldTransformStore::isCurrent(long long int structure) const
+{
+    return( (_structure==structure)&&(_transformationGeneration==CSceneObject::getTransformationGeneration()) );
+}
+
+long long int CWorldTransformStore::getStructure() const
+{
+    return(_structure);
+}
+
+size_t CWorldTransformStore::getSlotCount() const
+{
+    return(_objects.size());
+}
+
+int CWorldTransformStore::getSlot(long long int objectUid) const
+{
+    int retVal=-1;
+    const int* it=_slots.find(objectUid);
+    if (it!=nullptr)
+        retVal=*it;
+    return(retVal);
+}
+
+CSceneObject* CWorldTransformStore::getObject(size_t slot) const
+{
+    CSceneObject* retVal=nullptr;
+    if (slot<_objects.size())
+        retVal=_objects[slot];
+    return(retVal);
+}
+
+const int* CWorldTransformStore::getParentSlots() const
+{
+    return(_parentSlots.data());
+}
+
+const C7Vector* CWorldTransformStore::getLocalPoses() const
+{
+    return(_localPoses.data());
+}
+
+const C7Vector* CWorldTransformStore::getWorldPoses() const
+{
+    return(_worldPoses.data());
+}
+
+size_t CWorldTransformStore::getRebuildCount() const
+{
+    return(_rebuildCount);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <simMath/7Vector.h>
+#include <flatHashMap.h>
+#include <vector>
+
+class CSceneObject;
+
+class CWorldTransformStore
+{ // Optional structure-of-arrays store of the local and world poses of all scene objects (see the worldTransformStore user setting).
+  // Slots are dense and in topological order (a parent's slot precedes its children's), so that world poses are updated in one
+  // linear sweep, and can be read as contiguous arrays by the collision, proximity sensor and rendering routines
+public:
+    CWorldTransformStore();
+    virtual ~CWorldTransformStore();
+
+    void clear();
+    void rebuild(const std::vector<CSceneObject*>& objectsInHierarchyOrder,long long int structure);
+    size_t update(); // simulation thread only. Returns the number of recomputed world poses
+    bool isCurrent(long long int structure) const; // if no pose changed since the last update
+    long long int getStructure() const;
+
+    size_t getSlotCount() const;
+    int getSlot(long long int objectUid) const; // -1 if not there
+    CSceneObject* getObject(size_t slot) const;
+    const int* getParentSlots() const; // -1 for orphans
+    const C7Vector* getLocalPoses() const; // full local transformations
+    const C7Vector* getWorldPoses() const; // full cumulative transformations, as of the last update
+    size_t getRebuildCount() const;
+
+private:
+    std::vector<CSceneObject*> _objects;
+    std::vector<int> _parentSlots;
+    std::vector<C7Vector> _localPoses;
+    std::vector<C7Vector> _worldPoses;
+    CFlatHashMap<long long int,int> _slots; // object uid --> slot
+    long long int _structure; // as passed at the last rebuild
+    unsigned long long int _transformationGeneration; // as of the last update
+    size_t _rebuildCount;
+};
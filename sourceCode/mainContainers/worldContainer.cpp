@@ -6,6 +6,18 @@
 #include <ttUtil.h>
 #include <interfaceStackString.h>
 #include <interfaceStackInteger.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <set>
+#include <chrono>
+#include <atomic>
+#include <vDateTime.h>
+#include <vThread.h>
+#include <luaStatePool.h>
+#include <scriptIsolation.h>
+
+#define EVENTBENCHMARK_UIDBASE 0x4000000000000000LL // no object uid gets that large. Benchmark events are above
 
 CWorldContainer::CWorldContainer()
 {
@@ -28,6 +40,8 @@ CWorldContainer::CWorldContainer()
     serialPortContainer=nullptr;
 #endif
     _currentWorldIndex=-1;
+    _eventQueue=nullptr;
+    _queuedEventCnt=0;
     App::currentWorld=nullptr;
 }
 
@@ -122,6 +136,7 @@ int CWorldContainer::createNewWorld()
     currentWorld->initializeWorld();
 
     // Inform scripts about performed switch to new world:
+    _genesisSnapshot->clear(true);
     pushGenesisEvents();
 
     callScripts(sim_syscb_afterinstanceswitch,nullptr,nullptr);
@@ -203,6 +218,7 @@ int CWorldContainer::destroyCurrentWorld()
         App::currentWorld=currentWorld;
 
         // Inform scripts about performed world switch:
+        _genesisSnapshot->clear(true);
         pushGenesisEvents();
 
         callScripts(sim_syscb_afterinstanceswitch,nullptr,nullptr);
@@ -252,11 +268,16 @@ void CWorldContainer::initialize()
     calcInfo=new CCalculationInfo();
     addOnScriptContainer=new CAddOnScriptContainer();
 
-    _bufferedEvents=new SBufferedEvents;
-    _bufferedEvents->eventsStack=interfaceStackContainer->createStack();
-    _bufferedEvents->eventsStack->pushTableOntoStack();
     _cborEvents=false;
+    _cborEventStream=false;
     _mergeTheEvents=false;
+    _subscribedPluginCnt=0;
+    _bufferedEvents=_createBufferedEvents(nullptr,_cborEventStream);
+    _bufferedEvents->liveBuffer=true;
+    _genesisSnapshot=new CGenesisEventSnapshot();
+    _eventLogWriter=nullptr;
+    _eventLogReplay=nullptr;
+    _eventLogReplayId=0;
 
     initializeRendering();
     createNewWorld();
@@ -265,8 +286,15 @@ void CWorldContainer::initialize()
 void CWorldContainer::deinitialize()
 {
     TRACE_INTERNAL;
-    interfaceStackContainer->destroyStack(_bufferedEvents->eventsStack);
-    delete _bufferedEvents;
+    stopEventLogReplay();
+    stopEventRecording(); // dispatches the last events, before the event buffer goes
+    _eventMutex.lock();
+    _drainEventQueue(_bufferedEvents);
+    _eventMutex.unlock();
+    _destroyBufferedEvents(_bufferedEvents,true);
+    delete _genesisSnapshot;
+    CLuaStatePool::getDefaultPool()->clear();
+    CScriptIsolation::stopWorkers();
 
     copyBuffer->clearBuffer();
     while (_worlds.size()!=0)
@@ -330,6 +358,7 @@ bool CWorldContainer::_switchToWorld(int newWorldIndex)
     App::currentWorld=currentWorld;
 
     // Inform scripts about performed world switch:
+    _genesisSnapshot->clear(true);
     pushGenesisEvents();
 
     callScripts(sim_syscb_afterinstanceswitch,nullptr,nullptr);
@@ -436,8 +465,8 @@ void CWorldContainer::broadcastMsg(CInterfaceStack* inStack,int options)
     callScripts(sim_syscb_msg,inStack,nullptr);
 }
 
-long long int CWorldContainer::_eventSeq=0;
-long long int CWorldContainer::_mergedEventSeq=0;
+std::atomic<long long int> CWorldContainer::_eventSeq(0);
+std::atomic<long long int> CWorldContainer::_mergedEventSeq(0); // also incremented outside of _eventMutex, when dispatching
 
 void CWorldContainer::pushSceneObjectRemoveEvent(const CSceneObject* object)
 {
@@ -448,7 +477,7 @@ void CWorldContainer::pushSceneObjectRemoveEvent(const CSceneObject* object)
     }
 }
 
-std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::prepareSceneObjectAddEvent(const CSceneObject* object)
+std::tuple<SEventInfo,CEventData*> CWorldContainer::prepareSceneObjectAddEvent(const CSceneObject* object)
 {
     if (getEventsEnabled())
     {
@@ -459,7 +488,7 @@ std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::prepareSceneObject
     return {d,nullptr};
 }
 
-std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::prepareSceneObjectChangedEvent(int sceneObjectHandle,bool isCommonObjectData,const char* fieldName,bool mergeable)
+std::tuple<SEventInfo,CEventData*> CWorldContainer::prepareSceneObjectChangedEvent(int sceneObjectHandle,bool isCommonObjectData,const char* fieldName,bool mergeable)
 {
     if (getEventsEnabled())
     {
@@ -471,7 +500,7 @@ std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::prepareSceneObject
     return {d,nullptr};
 }
 
-std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::prepareSceneObjectChangedEvent(const CSceneObject* object,bool isCommonObjectData,const char* fieldName,bool mergeable)
+std::tuple<SEventInfo,CEventData*> CWorldContainer::prepareSceneObjectChangedEvent(const CSceneObject* object,bool isCommonObjectData,const char* fieldName,bool mergeable)
 {
     if (getEventsEnabled())
     {
@@ -519,7 +548,7 @@ std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::prepareSceneObject
     return {d,nullptr};
 }
 
-std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::prepareNakedEvent(const char* event,int handle,long long int uid,bool mergeable)
+std::tuple<SEventInfo,CEventData*> CWorldContainer::prepareNakedEvent(const char* event,int handle,long long int uid,bool mergeable)
 {
     if (getEventsEnabled())
     {
@@ -530,7 +559,7 @@ std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::prepareNakedEvent(
     return {d,nullptr};
 }
 
-std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::prepareEvent(const char* event,long long int uid,const char* fieldName,bool mergeable)
+std::tuple<SEventInfo,CEventData*> CWorldContainer::prepareEvent(const char* event,long long int uid,const char* fieldName,bool mergeable)
 {
     if (getEventsEnabled())
     {
@@ -541,9 +570,9 @@ std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::prepareEvent(const
     return {d,nullptr};
 }
 
-std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::_prepareGeneralEvent(const char* event,int objectHandle,long long int uid,const char* objType,const char* fieldName,bool mergeable)
-{
-    _eventMutex.lock();
+std::tuple<SEventInfo,CEventData*> CWorldContainer::_prepareGeneralEvent(const char* event,int objectHandle,long long int uid,const char* objType,const char* fieldName,bool mergeable)
+{ // the event header (event, seq, handle, uid) is only built once the event reaches the event buffer. The seq number
+  // is assigned there too, in push order. In streaming mode, the producer directly CBOR-encodes the event data
     SEventInfo eventInfo;
     eventInfo.event=event;
     if (fieldName!=nullptr)
@@ -551,38 +580,195 @@ std::tuple<SEventInfo,CInterfaceStackTable*> CWorldContainer::_prepareGeneralEve
     if (objType!=nullptr)
         eventInfo.dataSubtype=objType;
     eventInfo.uid=uid;
+    eventInfo.handle=objectHandle;
+    eventInfo.seq=-1;
     eventInfo.mergeable=mergeable;
-
-    eventInfo.eventTable=new CInterfaceStackTable();
-    eventInfo.eventTable->appendMapObject_stringString("event",event,0);
-    eventInfo.eventTable->appendMapObject_stringInt64("seq",_eventSeq++);
-    if (objectHandle!=-1)
-        eventInfo.eventTable->appendMapObject_stringInt32("handle",objectHandle);
-    if (uid!=-1)
-        eventInfo.eventTable->appendMapObject_stringInt64("uid",uid);
-    CInterfaceStackTable* data=new CInterfaceStackTable();
-    eventInfo.eventTable->appendMapObject_stringObject("data",data);
+    eventInfo.eventTable=nullptr;
+    eventInfo.eventData=new CEventData(_cborEventStream);
     if (objType!=nullptr)
+        eventInfo.eventData->openMapObject_stringMap(objType); // closed in pushEvent
+    return {eventInfo,eventInfo.eventData};
+}
+
+void CWorldContainer::pushEvent(SEventInfo& event)
+{ // lock-free, can be called from any thread. Events are moved to the event buffer in _drainEventQueue
+    event.eventData->close();
+    SEventQueueNode* node=_eventNodePool.getNode();
+    node->event=event;
+    _pushEventNode(_eventQueue,node);
+    bool dispatchNow=(_queuedEventCnt.fetch_add(1,std::memory_order_relaxed)+1>10000);
+    if ( dispatchNow&&VThread::isCurrentThreadTheMainSimulationThread() )
+        dispatchEvents(); // some actions in specfic situations can trigger a very very large number of events (that normally can be merged). Other threads leave that to the simulation thread, since dispatching runs the scripts
+}
+
+void CWorldContainer::_drainEventQueue(SBufferedEvents* events,SBufferedEvents* benchmarkEvents/*=nullptr*/)
+{ // single consumer, call with _eventMutex locked. Events are appended in push order, and get their seq number here.
+  // Events of the benchmark uid range go to benchmarkEvents, if not nullptr
+    std::vector<SEventQueueNode*> nodes;
+    _popEventNodes(_eventQueue,nodes);
+    if (nodes.size()==0)
+        return;
+    _queuedEventCnt.fetch_sub(nodes.size(),std::memory_order_relaxed);
+    for (size_t i=0;i<nodes.size();i++)
     {
-        CInterfaceStackTable* subC=new CInterfaceStackTable();
-        data->appendMapObject_stringObject(objType,subC);
-        data=subC;
+        nodes[i]->event.seq=_eventSeq.fetch_add(1);
+        if ( (benchmarkEvents!=nullptr)&&(nodes[i]->event.uid>=EVENTBENCHMARK_UIDBASE) )
+            _appendEventToBuffer(benchmarkEvents,nodes[i]->event);
+        else
+            _appendEventToBuffer(events,nodes[i]->event);
+        _eventNodePool.releaseNode(nodes[i]);
     }
-    _eventMutex.unlock();
-    return {eventInfo,data};
 }
 
-void CWorldContainer::pushEvent(SEventInfo& event)
+void CWorldContainer::_pushEventNode(std::atomic<SEventQueueNode*>& queue,SEventQueueNode* node)
 {
-    _eventMutex.lock();
-    CInterfaceStackTable* buff=(CInterfaceStackTable*)_bufferedEvents->eventsStack->getStackObjectFromIndex(0);
-    buff->appendArrayObject(event.eventTable);
-    _bufferedEvents->eventDescriptions.push_back(event);
+    node->next=queue.load(std::memory_order_relaxed);
+    while (!queue.compare_exchange_weak(node->next,node,std::memory_order_release,std::memory_order_relaxed));
+}
 
-    bool dispatchNow=_bufferedEvents->eventDescriptions.size()>10000;
-    _eventMutex.unlock();
-    if (dispatchNow)
-        dispatchEvents(); // some actions in specfic situations can trigger a very very large number of events (that normally can be merged)
+void CWorldContainer::_popEventNodes(std::atomic<SEventQueueNode*>& queue,std::vector<SEventQueueNode*>& nodes)
+{ // takes all queued nodes at once. The queue is a stack, reversing it gives the push order (per thread, and overall
+  // the order in which the pushes succeeded)
+    size_t firstNode=nodes.size();
+    SEventQueueNode* node=queue.exchange(nullptr,std::memory_order_acquire);
+    while (node!=nullptr)
+    {
+        nodes.push_back(node);
+        node=node->next;
+    }
+    std::reverse(nodes.begin()+firstNode,nodes.end());
+}
+
+void CWorldContainer::_appendEventToBuffer(SBufferedEvents* events,SEventInfo& event) const
+{ // events prepared in the other mode (e.g. just before the streaming mode was toggled) are converted first
+    if (events->cborStream!=nullptr)
+    {
+        event.eventData->toCbor();
+        if ( events->liveBuffer&&_genesisSnapshot->isValid() )
+            _genesisSnapshot->release(); // the snapshot cannot follow streamed events. Joiners get the full genesis events
+        _streamEvent(events,event);
+    }
+    else
+    {
+        event.eventData->toTable();
+        if (events->liveBuffer)
+            _genesisSnapshot->applyEvent(event);
+        event.eventTable=new CInterfaceStackTable();
+        event.eventTable->appendMapObject_stringString("event",event.event.c_str(),0);
+        event.eventTable->appendMapObject_stringInt64("seq",event.seq);
+        if (event.handle!=-1)
+            event.eventTable->appendMapObject_stringInt32("handle",event.handle);
+        if (event.uid!=-1)
+            event.eventTable->appendMapObject_stringInt64("uid",event.uid);
+        event.eventTable->appendMapObject_stringObject("data",event.eventData->detachTable()); // the wrapper is deleted with the buffer
+        CInterfaceStackTable* buff=(CInterfaceStackTable*)events->eventsStack->getStackObjectFromIndex(0);
+        buff->appendArrayObject(event.eventTable);
+        events->eventDescriptions.push_back(event);
+    }
+}
+
+void CWorldContainer::_streamEvent(SBufferedEvents* events,SEventInfo& event) const
+{ // Streaming mode: the event is CBOR-encoded right away. When merging, mergeable events are held back in a small
+    // side index (one event per uid and event type), and merged at push time
+    if (_mergeTheEvents)
+    {
+        std::vector<SEventInfo>& pending=events->pendingMergeable[event.uid];
+        if (event.mergeable)
+        {
+            for (size_t i=0;i<pending.size();i++)
+            {
+                if (pending[i].event==event.event)
+                {
+                    event.eventData->mergeFromOlder(pending[i].eventData,_getMergedDataSubtype(event,pending[i]));
+                    if (event.dataSubtype.size()==0)
+                        event.dataSubtype=pending[i].dataSubtype; // the merged event now also carries that sub-table
+                    delete pending[i].eventData;
+                    pending.erase(pending.begin()+i);
+                    events->pendingEventCnt--;
+                    break;
+                }
+            }
+            pending.push_back(event);
+            events->pendingEventCnt++;
+            return;
+        }
+        // A non-mergeable event must come after the pending changes of that same object:
+        for (size_t i=0;i<pending.size();i++)
+        {
+            _encodeEvent(events,pending[i],_mergedEventSeq++);
+            delete pending[i].eventData;
+        }
+        events->pendingEventCnt-=pending.size();
+        events->pendingMergeable.erase(event.uid);
+        _encodeEvent(events,event,_mergedEventSeq++);
+    }
+    else
+        _encodeEvent(events,event,event.seq);
+    delete event.eventData;
+    event.eventData=nullptr;
+}
+
+void CWorldContainer::_encodeEvent(SBufferedEvents* events,const SEventInfo& event,long long int seq)
+{ // keys in same order as CInterfaceStackTable::addCborObjectData would output them
+    CCbor* cbor=events->cborStream;
+    size_t cnt=3;
+    if (event.handle!=-1)
+        cnt++;
+    if (event.uid!=-1)
+        cnt++;
+    cbor->appendMap(cnt);
+    cbor->appendString("data");
+    event.eventData->addCborObjectData(cbor);
+    cbor->appendString("event");
+    cbor->appendLuaString(event.event);
+    if (event.handle!=-1)
+    {
+        cbor->appendString("handle");
+        cbor->appendInt(event.handle);
+    }
+    cbor->appendString("seq");
+    cbor->appendInt(seq);
+    if (event.uid!=-1)
+    {
+        cbor->appendString("uid");
+        cbor->appendInt(event.uid);
+    }
+    cbor->appendBreakIfApplicable();
+    events->streamedEventCnt++;
+}
+
+SBufferedEvents* CWorldContainer::_createBufferedEvents(CInterfaceStack* stack,bool cborStream) const
+{
+    SBufferedEvents* retVal=new SBufferedEvents;
+    if (stack==nullptr)
+        stack=interfaceStackContainer->createStack();
+    retVal->eventsStack=stack;
+    retVal->eventsStack->pushTableOntoStack();
+    retVal->cborStream=nullptr;
+    retVal->streamedEventCnt=0;
+    retVal->pendingEventCnt=0;
+    retVal->liveBuffer=false;
+    if (cborStream)
+    {
+        retVal->cborStream=new CCbor(nullptr,0);
+        retVal->cborStream->appendArray(0); // indefinite length, closed in _prepareEventsForDispatch
+    }
+    return(retVal);
+}
+
+void CWorldContainer::_destroyBufferedEvents(SBufferedEvents* events,bool destroyStack) const
+{
+    if (destroyStack)
+        interfaceStackContainer->destroyStack(events->eventsStack);
+    for (size_t i=0;i<events->eventDescriptions.size();i++)
+        delete events->eventDescriptions[i].eventData; // the data table itself is part of the stack
+    for (auto it=events->pendingMergeable.begin();it!=events->pendingMergeable.end();it++)
+    {
+        for (size_t i=0;i<it->second.size();i++)
+            delete it->second[i].eventData;
+    }
+    delete events->cborStream;
+    delete events;
 }
 
 bool CWorldContainer::getCborEvents() const
@@ -600,57 +786,140 @@ void CWorldContainer::setMergeEvents(bool b)
     _mergeTheEvents=b;
 }
 
+bool CWorldContainer::getCborEventStream() const
+{
+    return(_cborEventStream);
+}
+
+bool CWorldContainer::setCborEventStream(bool b)
+{ // takes effect with the next event buffer, i.e. after the next dispatch. Streamed events are encoded at push time, and
+  // cannot be filtered per subscriber
+    if (b)
+    {
+        for (auto it=_eventFilters.begin();it!=_eventFilters.end();it++)
+        {
+            if (!it->second.isEmpty())
+                return(false);
+        }
+    }
+    _cborEventStream=b;
+    return(true);
+}
+
 bool CWorldContainer::getEventsEnabled() const
 {
-    return(getSysFuncAndHookCnt(sim_syscb_event)>0);
+    return( (getSysFuncAndHookCnt(sim_syscb_event)>0)||(_subscribedPluginCnt>0)||(_eventLogWriter!=nullptr) );
 }
 
 void CWorldContainer::getGenesisEvents(CInterfaceStack* stack)
 {
-    // Dispatch events in the pipeline:
+    // Dispatch events in the pipeline (this also brings the genesis snapshot up to date):
     dispatchEvents();
 
-    // Swap event buffer:
-    SBufferedEvents* tmpEvents=new SBufferedEvents;
-    tmpEvents->eventsStack=stack;
-    tmpEvents->eventsStack->pushTableOntoStack();
-    SBufferedEvents* savedEvents=swapBufferedEvents(tmpEvents);
+    SBufferedEvents* tmpEvents=_createBufferedEvents(stack,_cborEventStream);
+    if (_genesisSnapshot->isValid())
+    { // Scene objects come from the snapshot. Only the ones it could not keep track of are re-serialized:
+        _refreshDirtyGenesisSnapshotObjects();
 
-    // Push all initial events:
-    pushGenesisEvents();
+        SBufferedEvents* savedEvents=swapBufferedEvents(tmpEvents);
+        _pushAppGenesisEvents();
+        currentWorld->simulation->pushGenesisEvents();
+        currentWorld->environment->pushGenesisEvents();
+        swapBufferedEvents(savedEvents);
 
-    // Restore event buffer:
-    swapBufferedEvents(savedEvents);
+        std::vector<SEventInfo> objectEvents;
+        _genesisSnapshot->getEvents(objectEvents);
+        for (size_t i=0;i<objectEvents.size();i++)
+        {
+            objectEvents[i].seq=_eventSeq.fetch_add(1);
+            _appendEventToBuffer(tmpEvents,objectEvents[i]);
+        }
+
+        savedEvents=swapBufferedEvents(tmpEvents);
+        currentWorld->drawingCont->pushGenesisEvents();
+        currentWorld->pointCloudCont->pushGenesisEvents();
+        swapBufferedEvents(savedEvents);
+    }
+    else
+    {
+        SBufferedEvents* savedEvents=swapBufferedEvents(tmpEvents);
+        pushGenesisEvents();
+        swapBufferedEvents(savedEvents);
+        if ( (tmpEvents->cborStream==nullptr)&&_genesisSnapshot->registerJoin() )
+            _genesisSnapshot->build(tmpEvents->eventDescriptions);
+    }
 
     // Condition events
     _prepareEventsForDispatch(tmpEvents);
-    delete tmpEvents;
+    _destroyBufferedEvents(tmpEvents,false);
 }
 
-void CWorldContainer::pushGenesisEvents()
+void CWorldContainer::_refreshDirtyGenesisSnapshotObjects()
 {
-    if (getEventsEnabled())
+    std::vector<long long int> dirtyUids;
+    _genesisSnapshot->getDirtyObjectUids(dirtyUids);
+    if (dirtyUids.size()>0)
     {
+        SBufferedEvents* refreshEvents=_createBufferedEvents(nullptr,false);
+        SBufferedEvents* savedEvents=swapBufferedEvents(refreshEvents);
+        for (size_t i=0;i<dirtyUids.size();i++)
         {
-            auto [event,data]=_prepareGeneralEvent(EVENTTYPE_APPSESSION,-1,-1,nullptr,nullptr,false);
-            data->appendMapObject_stringString("sessionId",_sessionId.c_str(),0);
-            pushEvent(event);
+            CSceneObject* obj=currentWorld->sceneObjects->getObjectFromUid(dirtyUids[i]);
+            if (obj!=nullptr)
+                obj->pushObjectCreationEvent();
         }
-
+        swapBufferedEvents(savedEvents);
+        for (size_t i=0;i<refreshEvents->eventDescriptions.size();i++)
         {
-            auto [event,data]=_prepareGeneralEvent(EVENTTYPE_APPSETTINGSCHANGED,-1,-1,nullptr,nullptr,false);
-            data->appendMapObject_stringFloat("defaultTranslationStepSize",App::userSettings->getTranslationStepSize());
-            data->appendMapObject_stringFloat("defaultRotationStepSize",App::userSettings->getRotationStepSize());
-            pushEvent(event);
+            SEventInfo& ev=refreshEvents->eventDescriptions[i];
+            if ( (ev.event==EVENTTYPE_OBJECTADDED)&&(std::find(dirtyUids.begin(),dirtyUids.end(),ev.uid)!=dirtyUids.end()) )
+                _genesisSnapshot->applyEvent(ev);
+            else
+            { // an event from another thread that landed in the refresh buffer: push it again (it gets a new seq)
+                SEventInfo again(ev);
+                again.eventTable=nullptr;
+                again.eventData=ev.eventData->copyYourself();
+                pushEvent(again);
+            }
         }
+        _destroyBufferedEvents(refreshEvents,true);
+    }
+}
 
+void CWorldContainer::pushGenesisEvents()
+{
+    if (getEventsEnabled())
+    {
+        _pushAppGenesisEvents();
         currentWorld->pushGenesisEvents();
     }
 }
 
+void CWorldContainer::_pushAppGenesisEvents()
+{
+    {
+        auto [event,data]=_prepareGeneralEvent(EVENTTYPE_APPSESSION,-1,-1,nullptr,nullptr,false);
+        data->appendMapObject_stringString("sessionId",_sessionId.c_str(),0);
+        pushEvent(event);
+    }
+
+    {
+        auto [event,data]=_prepareGeneralEvent(EVENTTYPE_APPSETTINGSCHANGED,-1,-1,nullptr,nullptr,false);
+        data->appendMapObject_stringFloat("defaultTranslationStepSize",App::userSettings->getTranslationStepSize());
+        data->appendMapObject_stringFloat("defaultRotationStepSize",App::userSettings->getRotationStepSize());
+        pushEvent(event);
+    }
+}
+
+void CWorldContainer::setGenesisSnapshotMaxSize(size_t bytes)
+{
+    _genesisSnapshot->setMaxSize(bytes);
+}
+
 SBufferedEvents* CWorldContainer::swapBufferedEvents(SBufferedEvents* newBuffer)
 {
     _eventMutex.lock();
+    _drainEventQueue(_bufferedEvents);
     SBufferedEvents* retVal=_bufferedEvents;
     _bufferedEvents=newBuffer;
     _eventMutex.unlock();
@@ -666,116 +935,402 @@ void CWorldContainer::dispatchEvents()
 
         // Swap the event buffer:
         _eventMutex.lock();
+        _drainEventQueue(_bufferedEvents);
+        if (!getEventsEnabled())
+            _genesisSnapshot->release(); // changes from now on are not pushed, the snapshot could not follow them
         CInterfaceStackTable* buff=(CInterfaceStackTable*)_bufferedEvents->eventsStack->getStackObjectFromIndex(0);
-        if (buff->isEmpty())
+        if ( buff->isEmpty()&&(_bufferedEvents->streamedEventCnt+_bufferedEvents->pendingEventCnt==0) )
         {
             _eventMutex.unlock();
             return;
         }
         SBufferedEvents* tmpEvents=_bufferedEvents;
-        _bufferedEvents=new SBufferedEvents;
-        _bufferedEvents->eventsStack=interfaceStackContainer->createStack();
-        _bufferedEvents->eventsStack->pushTableOntoStack();
+        _bufferedEvents=_createBufferedEvents(nullptr,_cborEventStream);
+        _bufferedEvents->liveBuffer=true;
         _eventMutex.unlock();
 
-        _prepareEventsForDispatch(tmpEvents);
+        std::map<SEventSubscriber,SFilteredEventBatch*> filteredBatches;
+        _prepareEventsForDispatch(tmpEvents,&filteredBatches);
+        if (_eventLogWriter!=nullptr)
+            _recordEventBatch(tmpEvents->eventsStack);
 
-        // Dispatch events:
+        // Dispatch events (subscribers with an event filter will pick their own batch via getEventBatchForSubscriber):
+        _filteredEventBatches.swap(filteredBatches);
         callScripts(sim_syscb_event,tmpEvents->eventsStack,nullptr);
+        _dispatchEventsToPlugins(tmpEvents->eventsStack);
+        _filteredEventBatches.swap(filteredBatches);
+        std::set<SFilteredEventBatch*> sharedBatches;
+        for (auto it=filteredBatches.begin();it!=filteredBatches.end();it++)
+            sharedBatches.insert(it->second);
+        for (auto it=sharedBatches.begin();it!=sharedBatches.end();it++)
+            _destroyFilteredEventBatch(*it); // before the full batch, since it might borrow its events
+
+        _destroyBufferedEvents(tmpEvents,true);
+    }
+}
 
-        interfaceStackContainer->destroyStack(tmpEvents->eventsStack);
-        delete tmpEvents;
+bool CWorldContainer::startEventRecording(const char* filePrefix,size_t segmentSize)
+{ // records every dispatched event batch (CBOR-encoded) to a segmented, memory-mapped log
+    stopEventRecording();
+    dispatchEvents(); // what was produced so far is not part of the recording
+    CEventLogWriter* writer=new CEventLogWriter();
+    bool retVal=writer->start(filePrefix,segmentSize);
+    if (retVal)
+    {
+        _eventLogWriter=writer;
+        // a replay must be able to start from scratch:
+        CInterfaceStack* stack=interfaceStackContainer->createStack();
+        getGenesisEvents(stack);
+        _recordEventBatch(stack);
+        interfaceStackContainer->destroyStack(stack);
+        App::logMsg(sim_verbosity_infos,"recording events to '%s'...",CEventLogWriter::getSegmentFilename(filePrefix,0).c_str());
     }
+    else
+        delete writer;
+    return(retVal);
 }
 
-void CWorldContainer::_combineDuplicateEvents(SBufferedEvents* events) const
+void CWorldContainer::stopEventRecording()
 {
-    CInterfaceStackTable* buff=(CInterfaceStackTable*)events->eventsStack->getStackObjectFromIndex(0);
-    std::vector<SEventInfo>* evSum=&events->eventDescriptions;
-    if (!buff->isEmpty())
+    if (_eventLogWriter!=nullptr)
     {
-        std::map<std::string,bool> map;
-        for (int i=int(buff->getArraySize())-1;i>=0;i--)
+        dispatchEvents();
+        CEventLogWriter* writer=_eventLogWriter.exchange(nullptr);
+        App::logMsg(sim_verbosity_infos,"recorded %i event batches in %i segment(s).",int(writer->getRecordCount()),int(writer->getSegmentCount()));
+        delete writer;
+    }
+}
+
+void CWorldContainer::_recordEventBatch(CInterfaceStack* batch)
+{ // the writer is only created and destroyed by the simulation thread, i.e. the thread that dispatches
+    CEventLogWriter* writer=_eventLogWriter;
+    CInterfaceStackObject* obj=batch->getStackObjectFromIndex(0);
+    if ( (writer!=nullptr)&&(obj!=nullptr) )
+    {
+        if (obj->getObjectType()==STACK_OBJECT_STRING)
+        { // already CBOR-encoded
+            size_t l;
+            const char* b=((CInterfaceStackString*)obj)->getValue(&l);
+            writer->appendRecord((const unsigned char*)b,l);
+        }
+        else
         {
-            std::string c(evSum->at(i).event+evSum->at(i).subEvent+evSum->at(i).dataSubtype+std::to_string(evSum->at(i).uid));
-            std::map<std::string,bool>::iterator it=map.find(c);
-            if (it==map.end()||(!evSum->at(i).mergeable))
-                map[c]=true;
-            else
+            std::string cbor=batch->getCborEncodedBufferFromTable(0);
+            writer->appendRecord((const unsigned char*)cbor.c_str(),cbor.size());
+        }
+    }
+}
+
+int CWorldContainer::replayEventLog(const char* filePrefix,double speed)
+{ // feeds a recorded event log to the sysCall_event subscribers. Batches are always passed CBOR-encoded.
+    // speed<=0: everything is replayed right away, and the number of replayed batches is returned.
+    // Otherwise the original timing is reproduced, scaled by speed. That replay is paced by the simulation thread loop
+    // (see handleEventLogReplay), i.e. the simulation thread never sleeps, and 0 is returned.
+    // Returns -1 if the log cannot be opened
+    stopEventLogReplay();
+    SEventLogReplay* replay=new SEventLogReplay();
+    if (!replay->reader.open(filePrefix))
+    {
+        delete replay;
+        return(-1);
+    }
+    dispatchEvents(); // pending events go out before the replay
+    replay->speed=speed;
+    replay->startTime=VDateTime::getTimeInMs();
+    replay->payload=nullptr;
+    replay->replayedBatchCnt=0;
+    _eventLogReplay=replay;
+    _eventLogReplayId++;
+    if (speed>0.0)
+        return(0);
+    return(handleEventLogReplay());
+}
+
+int CWorldContainer::handleEventLogReplay()
+{ // called once per simulation thread loop pass. Replays the records that are due, and returns their count
+    int retVal=0;
+    SEventLogReplay* replay=_eventLogReplay;
+    while (replay!=nullptr)
+    {
+        if (replay->payload==nullptr)
+        {
+            if (!replay->reader.getNextRecord(replay->payload,replay->payloadSize,replay->recordTime))
             {
-                buff->removeArrayItemAtIndex(i);
-                evSum->erase(evSum->begin()+i);
+                App::logMsg(sim_verbosity_infos,"replayed %i event batches.",replay->replayedBatchCnt);
+                stopEventLogReplay();
+                break;
             }
         }
+        if ( (replay->speed>0.0)&&((long long int)(double(replay->recordTime)/replay->speed)>VDateTime::getTimeInMs()-replay->startTime) )
+            break; // not yet due
+        CInterfaceStack* stack=interfaceStackContainer->createStack();
+        stack->pushStringOntoStack((const char*)replay->payload,replay->payloadSize);
+        replay->payload=nullptr;
+        replay->replayedBatchCnt++;
+        retVal++;
+        int replayId=_eventLogReplayId;
+        callScripts(sim_syscb_event,stack,nullptr);
+        interfaceStackContainer->destroyStack(stack);
+        if (replayId!=_eventLogReplayId)
+            break; // a script stopped or restarted the replay
     }
+    return(retVal);
 }
 
-void CWorldContainer::_mergeEvents(SBufferedEvents* events) const
+void CWorldContainer::stopEventLogReplay()
 {
+    if (_eventLogReplay!=nullptr)
+    {
+        delete _eventLogReplay;
+        _eventLogReplay=nullptr;
+        _eventLogReplayId++;
+    }
+}
+
+const std::string& CWorldContainer::_getMergedDataSubtype(const SEventInfo& newer,const SEventInfo& older)
+{ // events of one uid have at most one data subtype (the object type), but a merged event may have collected it from an older one
+    if (older.dataSubtype.size()>0)
+        return(older.dataSubtype);
+    return(newer.dataSubtype);
+}
+
+void CWorldContainer::_mergeEvents(SBufferedEvents* events) const
+{ // Single pass from newest to oldest event, with two hash indices, i.e. linear in the number of events:
+    // - a mergeable event that has the same event/field/subtype/uid as a newer event is superseded and dropped
+    // - otherwise, a mergeable event is merged into the newest mergeable event of same uid and event type, in place
     CInterfaceStackTable* buff=(CInterfaceStackTable*)events->eventsStack->getStackObjectFromIndex(0);
     std::vector<SEventInfo>* evSum=&events->eventDescriptions;
-    for (int i=int(buff->getArraySize())-1;i>=0;i--)
+    if (buff->isEmpty())
+        return;
+    std::vector<bool> removed(evSum->size(),false);
+    std::unordered_map<std::string,int> stringIds; // event types, field names and subtypes are few: compared as ids
+    std::unordered_set<SEventMergeKey,SEventMergeKeyHash> newerDescriptors; // uid/event/field/subtype of newer events
+    std::unordered_map<SEventMergeKey,size_t,SEventMergeKeyHash> mergeTargets; // uid/event --> newest kept mergeable event
+    newerDescriptors.reserve(evSum->size());
+    for (int i=int(evSum->size())-1;i>=0;i--)
     {
-        if (evSum->at(i).mergeable)
+        SEventInfo& ev=evSum->at(i);
+        SEventMergeKey key;
+        key.uid=ev.uid;
+        key.event=stringIds.try_emplace(ev.event,int(stringIds.size())).first->second;
+        key.field=stringIds.try_emplace(ev.subEvent,int(stringIds.size())).first->second;
+        key.subtype=stringIds.try_emplace(ev.dataSubtype,int(stringIds.size())).first->second;
+        bool newerDuplicate=!newerDescriptors.insert(key).second;
+        if (ev.mergeable)
         {
-            CInterfaceStackTable* data=(CInterfaceStackTable*)((CInterfaceStackTable*)buff->getArrayItemAtIndex(i))->getMapObject("data");
-            CInterfaceStackTable* sub=nullptr;
-            if (evSum->at(i).dataSubtype.size()>0)
-                sub=(CInterfaceStackTable*)data->getMapObject(evSum->at(i).dataSubtype.c_str());
-            for (int j=i-1;j>=0;j--)
+            if (newerDuplicate)
+                removed[i]=true;
+            else
             {
-                if ( (evSum->at(j).mergeable)&&(evSum->at(i).uid==evSum->at(j).uid)&&(evSum->at(i).event.compare(evSum->at(j).event)==0) )
+                key.field=-1;
+                key.subtype=-1;
+                auto it=mergeTargets.find(key);
+                if (it==mergeTargets.end())
+                    mergeTargets[key]=size_t(i);
+                else
                 {
-                    CInterfaceStackTable* data2=(CInterfaceStackTable*)((CInterfaceStackTable*)buff->getArrayItemAtIndex(j))->getMapObject("data");
-                    CInterfaceStackTable* sub2=nullptr;
-                    if (evSum->at(j).dataSubtype.size()>0)
-                        sub2=(CInterfaceStackTable*)data2->getMapObject(evSum->at(j).dataSubtype.c_str());
+                    evSum->at(it->second).eventData->mergeFromOlder(ev.eventData,_getMergedDataSubtype(evSum->at(it->second),ev));
+                    removed[i]=true;
+                }
+            }
+        }
+    }
 
-                    if ( (sub!=nullptr)&&(sub2!=nullptr) )
-                    {
-                        std::vector<CInterfaceStackObject*> allObjs;
-                        sub2->getAllObjectsAndClearTable(allObjs);
-                        for (size_t k=0;k<allObjs.size()/2;k++)
-                        {
-                            if (sub->containsKey(((CInterfaceStackString*)allObjs[2*k+0])->getValue(nullptr)))
-                            {
-                                delete allObjs[2*k+0];
-                                delete allObjs[2*k+1];
-                            }
-                            else
-                                sub->appendArrayOrMapObject(allObjs[2*k+0],allObjs[2*k+1]);
-                        }
-                    }
+    // Rebuild the event array in a single go:
+    std::vector<CInterfaceStackObject*> allEvents;
+    buff->getAllObjectsAndClearTable(allEvents);
+    std::vector<SEventInfo> keptDescriptions;
+    keptDescriptions.reserve(evSum->size());
+    for (size_t i=0;i<allEvents.size();i++)
+    {
+        if (removed[i])
+        {
+            delete allEvents[i];
+            delete evSum->at(i).eventData;
+        }
+        else
+        {
+            buff->appendArrayObject(allEvents[i]);
+            keptDescriptions.push_back(evSum->at(i));
+        }
+    }
+    evSum->swap(keptDescriptions);
+}
 
-                    std::vector<CInterfaceStackObject*> allObjs;
-                    data2->getAllObjectsAndClearTable(allObjs);
-                    for (size_t k=0;k<allObjs.size()/2;k++)
-                    {
-                        if (data->containsKey(((CInterfaceStackString*)allObjs[2*k+0])->getValue(nullptr)))
-                        {
-                            delete allObjs[2*k+0];
-                            delete allObjs[2*k+1];
-                        }
-                        else
-                            data->appendArrayOrMapObject(allObjs[2*k+0],allObjs[2*k+1]);
-                    }
-                    buff->removeArrayItemAtIndex(j);
-                    evSum->erase(evSum->begin()+j);
-                    i--;
+void CWorldContainer::benchmarkEventMerging(size_t eventCount,size_t uidCount,bool mergeable,double& pushMs,double& mergeMs,size_t& keptEvents)
+{ // eventCount pose changes spread over uidCount uids, prepared and pushed like CSceneObject::setLocalTransformation does,
+  // then drained into a separate (non-streamed) buffer, every 1000 events. Not dispatched
+    dispatchEvents(); // events produced so far go out first
+    SBufferedEvents* events=_createBufferedEvents(nullptr,false);
+    auto start=std::chrono::steady_clock::now();
+    for (size_t i=0;i<eventCount;i++)
+    {
+        long long int uid=EVENTBENCHMARK_UIDBASE+(long long int)(i%std::max<size_t>(1,uidCount));
+        auto [event,data]=_prepareGeneralEvent(EVENTTYPE_OBJECTCHANGED,-1,uid,nullptr,"pose",mergeable);
+        double p[7]={double(i),0.0,0.0,0.0,0.0,0.0,1.0};
+        data->appendMapObject_stringDoubleArray("pose",p,7);
+        pushEvent(event);
+        if ( ((i+1)%1000==0)||(i+1==eventCount) )
+        {
+            _eventMutex.lock();
+            _drainEventQueue(_bufferedEvents,events);
+            _eventMutex.unlock();
+        }
+    }
+    pushMs=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+    start=std::chrono::steady_clock::now();
+    _mergeEvents(events);
+    mergeMs=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+    keptEvents=events->eventDescriptions.size();
+    _destroyBufferedEvents(events,true);
+}
 
-                    if ( (sub==nullptr)&&(sub2!=nullptr) )
-                        sub=sub2;
-                }
-            }
+static std::atomic<int> _benchmarkNextThreadIndex(0);
+static std::atomic<size_t> _benchmarkFinishedThreads(0);
+static size_t _benchmarkEventsPerThread=0;
+
+VTHREAD_RETURN_TYPE CWorldContainer::_eventPushBenchmarkWorker(VTHREAD_ARGUMENT_TYPE lpData)
+{
+    int threadIndex=_benchmarkNextThreadIndex.fetch_add(1);
+    for (size_t i=0;i<_benchmarkEventsPerThread;i++)
+    {
+        auto [event,data]=App::worldContainer->_prepareGeneralEvent(EVENTTYPE_OBJECTCHANGED,threadIndex,EVENTBENCHMARK_UIDBASE+(long long int)i,nullptr,"pose",false);
+        double p[7]={double(i),0.0,0.0,0.0,0.0,0.0,1.0};
+        data->appendMapObject_stringDoubleArray("pose",p,7);
+        App::worldContainer->pushEvent(event);
+    }
+    _benchmarkFinishedThreads.fetch_add(1);
+    VThread::endThread();
+    return(VTHREAD_RETURN_VAL);
+}
+
+void CWorldContainer::benchmarkEventPush(size_t threadCnt,size_t eventsPerThread,double& pushMs,bool& orderOk)
+{ // threadCnt producers prepare and push eventsPerThread pose change events each via pushEvent, while the calling thread
+  // keeps draining the queue (seq numbers included) into a separate buffer, as _drainEventQueue does at dispatch.
+  // orderOk is false if the events of one producer come out of order, or if the seq numbers are not increasing
+    static VMutex benchmarkMutex; // one benchmark at a time, the state is static
+    benchmarkMutex.lock_simple("CWorldContainer::benchmarkEventPush");
+    _benchmarkNextThreadIndex=0;
+    _benchmarkFinishedThreads=0;
+    _benchmarkEventsPerThread=eventsPerThread;
+    std::vector<long long int> nextUid(threadCnt,EVENTBENCHMARK_UIDBASE);
+    long long int lastSeq=-1;
+    orderOk=true;
+    auto start=std::chrono::steady_clock::now();
+    for (size_t i=0;i<threadCnt;i++)
+        VThread::launchThread(_eventPushBenchmarkWorker,false);
+    while (true)
+    {
+        bool finished=(_benchmarkFinishedThreads.load()==threadCnt); // read before the last drain
+        SBufferedEvents* events=_createBufferedEvents(nullptr,false);
+        _eventMutex.lock();
+        _drainEventQueue(_bufferedEvents,events);
+        _eventMutex.unlock();
+        size_t cnt=events->eventDescriptions.size();
+        for (size_t i=0;i<cnt;i++)
+        {
+            const SEventInfo& ev=events->eventDescriptions[i];
+            if ( (ev.uid!=nextUid[ev.handle]++)||(ev.seq<=lastSeq) )
+                orderOk=false;
+            lastSeq=ev.seq;
         }
+        _destroyBufferedEvents(events,true);
+        if (finished)
+            break;
+        if (cnt==0)
+            VThread::switchThread();
     }
+    pushMs=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+    for (size_t i=0;i<threadCnt;i++)
+        orderOk=orderOk&&(nextUid[i]==EVENTBENCHMARK_UIDBASE+(long long int)eventsPerThread);
+    benchmarkMutex.unlock_simple();
 }
 
-void CWorldContainer::_prepareEventsForDispatch(SBufferedEvents* events) const
+bool CWorldContainer::testEventMerging(std::string& errorString)
+{ // regression test: shape{color} --> common{pose} --> shape{visible} for one uid must merge into a single event that
+  // still has all three fields, in buffered and in streaming mode. Events are not pushed
+    bool retVal=true;
+    const char* fields[3]={"color","pose","visible"};
+    _eventMutex.lock();
+    bool mergeTheEvents=_mergeTheEvents;
+    _mergeTheEvents=true;
+    for (size_t mode=0;mode<2;mode++)
+    {
+        SBufferedEvents* events=_createBufferedEvents(nullptr,mode==1);
+        for (size_t i=0;i<3;i++)
+        {
+            SEventInfo ev;
+            ev.event=EVENTTYPE_OBJECTCHANGED;
+            ev.subEvent=fields[i];
+            if (i!=1)
+                ev.dataSubtype="shape";
+            ev.uid=1;
+            ev.handle=-1;
+            ev.seq=(long long int)i;
+            ev.mergeable=true;
+            ev.eventData=new CEventData(mode==1);
+            if (ev.dataSubtype.size()>0)
+                ev.eventData->openMapObject_stringMap(ev.dataSubtype.c_str());
+            ev.eventData->appendMapObject_stringInt32(fields[i],int(i));
+            ev.eventData->close();
+            _appendEventToBuffer(events,ev);
+        }
+        std::vector<SEventInfo>* merged=&events->pendingMergeable[1];
+        if (mode==0)
+        {
+            _mergeEvents(events);
+            merged=&events->eventDescriptions;
+        }
+        bool ok=(merged->size()==1);
+        if (ok)
+        {
+            merged->at(0).eventData->toTable();
+            CInterfaceStackTable* data=merged->at(0).eventData->getTable();
+            CInterfaceStackObject* shape=data->getMapObject("shape");
+            ok=(data->getMapObject(fields[1])!=nullptr)&&(shape!=nullptr)&&(shape->getObjectType()==STACK_OBJECT_TABLE);
+            ok=ok&&(((CInterfaceStackTable*)shape)->getMapObject(fields[0])!=nullptr)&&(((CInterfaceStackTable*)shape)->getMapObject(fields[2])!=nullptr);
+        }
+        if (!ok)
+        {
+            retVal=false;
+            if (mode==0)
+                errorString+="buffered mode: fields lost while merging. ";
+            else
+                errorString+="streaming mode: fields lost while merging. ";
+        }
+        _destroyBufferedEvents(events,true);
+    }
+    _mergeTheEvents=mergeTheEvents;
+    _eventMutex.unlock();
+    return(retVal);
+}
+
+void CWorldContainer::_prepareEventsForDispatch(SBufferedEvents* events,std::map<SEventSubscriber,SFilteredEventBatch*>* filteredBatches/*=nullptr*/) const
 {
+    if (events->cborStream!=nullptr)
+    { // Streaming mode: flush the held-back mergeable events in their original order, and close the array.
+        // Event filters do not apply to streamed events (all subscribers get the full batch)
+        std::vector<SEventInfo> pending;
+        for (auto it=events->pendingMergeable.begin();it!=events->pendingMergeable.end();it++)
+            pending.insert(pending.end(),it->second.begin(),it->second.end());
+        events->pendingMergeable.clear();
+        events->pendingEventCnt=0;
+        std::sort(pending.begin(),pending.end(),[](const SEventInfo& a,const SEventInfo& b){return(a.seq<b.seq);});
+        for (size_t i=0;i<pending.size();i++)
+        {
+            _encodeEvent(events,pending[i],_mergedEventSeq++);
+            delete pending[i].eventData;
+        }
+        events->cborStream->appendBreakIfApplicable();
+        size_t l;
+        const unsigned char* b=events->cborStream->getBuff(l);
+        events->eventsStack->clear();
+        events->eventsStack->pushStringOntoStack((const char*)b,l);
+        return;
+    }
+
     if (_mergeTheEvents)
     {
-        _combineDuplicateEvents(events);
         _mergeEvents(events);
 
         // adjust the seq number:
@@ -791,6 +1346,27 @@ void CWorldContainer::_prepareEventsForDispatch(SBufferedEvents* events) const
         }
     }
 
+    if ( (filteredBatches!=nullptr)&&(_eventFilters.size()>0) )
+    { // subscribers with identical filters share the same batch. Subscribers without filter get the full batch:
+        std::map<std::string,SFilteredEventBatch*> batchesPerFilter;
+        std::vector<std::string> cborEncodedEvents; // CBOR mode: events that are not pruned are encoded once for all batches
+        for (auto it=_eventFilters.begin();it!=_eventFilters.end();it++)
+        {
+            if (it->second.isEmpty())
+                continue;
+            std::string sig=_getEventFilterSignature(it->second);
+            auto b=batchesPerFilter.find(sig);
+            if (b==batchesPerFilter.end())
+            {
+                SFilteredEventBatch* batch=_buildFilteredEventBatch(events,it->second,cborEncodedEvents);
+                batchesPerFilter[sig]=batch;
+                (*filteredBatches)[it->first]=batch;
+            }
+            else
+                (*filteredBatches)[it->first]=b->second;
+        }
+    }
+
     if (_cborEvents)
     {
         std::string cbor=events->eventsStack->getCborEncodedBufferFromTable(0);
@@ -799,6 +1375,264 @@ void CWorldContainer::_prepareEventsForDispatch(SBufferedEvents* events) const
     }
 }
 
+bool CWorldContainer::setEventFilter(const SEventSubscriber& subscriber,const SEventFilter* filter)
+{ // filter=nullptr removes the subscriber. A plugin subscriber also needs its event callback set, and is then
+  // dispatched events as long as it is listed here
+    if (filter==nullptr)
+    {
+        if ( (_eventFilters.erase(subscriber)>0)&&(subscriber.type==eventsubscriber_plugin) )
+            _subscribedPluginCnt--;
+    }
+    else
+    {
+        if (_cborEventStream&&(!filter->isEmpty()))
+            return(false);
+        if ( (_eventFilters.find(subscriber)==_eventFilters.end())&&(subscriber.type==eventsubscriber_plugin) )
+            _subscribedPluginCnt++;
+        _eventFilters[subscriber]=filter[0];
+    }
+    return(true);
+}
+
+void CWorldContainer::getEventFilterFromTable(const CInterfaceStackTable* table,SEventFilter& filter)
+{ // table: {eventTypes={..},handles={..},uids={..},fields={..}}
+    const char* keys[4]={"eventTypes","handles","uids","fields"};
+    for (size_t k=0;k<4;k++)
+    {
+        CInterfaceStackObject* obj=table->getMapObject(keys[k]);
+        if ( (obj!=nullptr)&&(obj->getObjectType()==STACK_OBJECT_TABLE) )
+        {
+            CInterfaceStackTable* arr=(CInterfaceStackTable*)obj;
+            for (size_t i=0;i<arr->getArraySize();i++)
+            {
+                CInterfaceStackObject* item=arr->getArrayItemAtIndex(i);
+                if (item->getObjectType()==STACK_OBJECT_STRING)
+                {
+                    std::string str(((CInterfaceStackString*)item)->getValue(nullptr));
+                    if (k==0)
+                        filter.eventTypes.insert(str);
+                    if (k==3)
+                        filter.fieldNames.insert(str);
+                }
+                long long int v=0;
+                bool isNumber=false;
+                if (item->getObjectType()==STACK_OBJECT_INTEGER)
+                {
+                    v=((CInterfaceStackInteger*)item)->getValue();
+                    isNumber=true;
+                }
+                if (item->getObjectType()==STACK_OBJECT_NUMBER)
+                {
+                    v=(long long int)((CInterfaceStackNumber*)item)->getValue();
+                    isNumber=true;
+                }
+                if (isNumber)
+                {
+                    if (k==1)
+                        filter.handles.insert(int(v));
+                    if (k==2)
+                        filter.uids.insert(v);
+                }
+            }
+        }
+    }
+}
+
+CInterfaceStack* CWorldContainer::getEventBatchForSubscriber(const SEventSubscriber& subscriber,CInterfaceStack* fullBatch) const
+{
+    auto it=_filteredEventBatches.find(subscriber);
+    if (it!=_filteredEventBatches.end())
+        return(it->second->stack);
+    return(fullBatch);
+}
+
+void CWorldContainer::_dispatchEventsToPlugins(CInterfaceStack* fullBatch)
+{
+    std::vector<SEventSubscriber> plugins; // a callback could change the subscriptions
+    for (auto it=_eventFilters.begin();it!=_eventFilters.end();it++)
+    {
+        if (it->first.type==eventsubscriber_plugin)
+            plugins.push_back(it->first);
+    }
+    for (size_t i=0;i<plugins.size();i++)
+    {
+        CPlugin* plugin=CPluginContainer::getPluginFromHandle(plugins[i].handle);
+        if ( (plugin!=nullptr)&&(plugin->eventCallback!=nullptr) )
+            plugin->eventCallback(getEventBatchForSubscriber(plugins[i],fullBatch)->getId());
+    }
+}
+
+std::string CWorldContainer::_getEventFilterSignature(const SEventFilter& filter)
+{
+    std::string retVal;
+    for (auto it=filter.eventTypes.begin();it!=filter.eventTypes.end();it++)
+        retVal+=*it+",";
+    retVal+="|";
+    for (auto it=filter.uids.begin();it!=filter.uids.end();it++)
+        retVal+=std::to_string(*it)+",";
+    retVal+="|";
+    for (auto it=filter.handles.begin();it!=filter.handles.end();it++)
+        retVal+=std::to_string(*it)+",";
+    retVal+="|";
+    for (auto it=filter.fieldNames.begin();it!=filter.fieldNames.end();it++)
+        retVal+=*it+",";
+    return(retVal);
+}
+
+CInterfaceStackTable* CWorldContainer::_copyEventFields(const CInterfaceStackTable* data,const std::set<std::string>& fieldNames,const std::string& dataSubtype)
+{ // copies only the wanted fields (and the wanted fields of the dataSubtype sub-map). Returns nullptr if none of them passed
+    CInterfaceStackTable* retVal=new CInterfaceStackTable();
+    for (size_t i=0;i<data->getMapEntryCount();i++)
+    {
+        std::string key;
+        double dummyD;
+        long long int dummyI;
+        bool dummyB;
+        int keyType=-1;
+        CInterfaceStackObject* obj=data->getMapItemAtIndex(i,key,dummyD,dummyI,dummyB,keyType);
+        if (keyType==STACK_OBJECT_STRING)
+        {
+            if ( (dataSubtype.size()>0)&&(key==dataSubtype)&&(obj->getObjectType()==STACK_OBJECT_TABLE) )
+            {
+                CInterfaceStackTable* sub=_copyEventFields((CInterfaceStackTable*)obj,fieldNames,"");
+                if (sub!=nullptr)
+                    retVal->appendMapObject_stringObject(key.c_str(),sub);
+            }
+            else if (fieldNames.find(key)!=fieldNames.end())
+                retVal->appendMapObject_stringObject(key.c_str(),obj->copyYourself());
+        }
+    }
+    if (retVal->getMapEntryCount()==0)
+    {
+        delete retVal;
+        retVal=nullptr;
+    }
+    return(retVal);
+}
+
+CInterfaceStackTable* CWorldContainer::_getEventWithFields(CInterfaceStackTable* event,const std::set<std::string>& fieldNames,const std::string& dataSubtype)
+{ // returns event itself if nothing needs to be pruned, nullptr if the event had data fields but none of them passed,
+  // otherwise a new event with only the wanted data fields
+    CInterfaceStackObject* data=event->getMapObject("data");
+    if ( (data==nullptr)||(data->getObjectType()!=STACK_OBJECT_TABLE)||(((CInterfaceStackTable*)data)->getMapEntryCount()==0) )
+        return(event);
+    CInterfaceStackTable* prunedData=_copyEventFields((CInterfaceStackTable*)data,fieldNames,dataSubtype);
+    if (prunedData==nullptr)
+        return(nullptr);
+    CInterfaceStackTable* retVal=new CInterfaceStackTable();
+    for (size_t i=0;i<event->getMapEntryCount();i++)
+    {
+        std::string key;
+        double dummyD;
+        long long int dummyI;
+        bool dummyB;
+        int keyType=-1;
+        CInterfaceStackObject* obj=event->getMapItemAtIndex(i,key,dummyD,dummyI,dummyB,keyType);
+        if (keyType==STACK_OBJECT_STRING)
+        {
+            if (obj==data)
+                retVal->appendMapObject_stringObject(key.c_str(),prunedData);
+            else
+                retVal->appendMapObject_stringObject(key.c_str(),obj->copyYourself()); // small header fields
+        }
+    }
+    return(retVal);
+}
+
+SFilteredEventBatch* CWorldContainer::_buildFilteredEventBatch(const SBufferedEvents* events,const SEventFilter& filter,std::vector<std::string>& cborEncodedEvents) const
+{ // events that do not need to be pruned are not copied: in table mode, they are borrowed from the full batch (see
+  // _destroyFilteredEventBatch), in CBOR mode, their encoding is shared among all filtered batches
+    SFilteredEventBatch* retVal=new SFilteredEventBatch;
+    retVal->stack=interfaceStackContainer->createStack();
+    CInterfaceStackTable* buff=(CInterfaceStackTable*)events->eventsStack->getStackObjectFromIndex(0);
+    std::vector<std::pair<size_t,CInterfaceStackTable*>> passed; // event index, event or pruned event
+    for (size_t i=0;i<events->eventDescriptions.size();i++)
+    {
+        const SEventInfo& ev=events->eventDescriptions[i];
+        if ( (filter.eventTypes.size()>0)&&(filter.eventTypes.find(ev.event)==filter.eventTypes.end()) )
+            continue;
+        if ( (filter.uids.size()>0)||(filter.handles.size()>0) )
+        {
+            if ( (filter.uids.find(ev.uid)==filter.uids.end())&&(filter.handles.find(ev.handle)==filter.handles.end()) )
+                continue;
+        }
+        CInterfaceStackTable* evTable=(CInterfaceStackTable*)buff->getArrayItemAtIndex(i);
+        if (filter.fieldNames.size()>0)
+        {
+            CInterfaceStackTable* pruned=_getEventWithFields(evTable,filter.fieldNames,ev.dataSubtype);
+            if (pruned==nullptr)
+                continue; // none of the wanted fields are part of this event
+            if (pruned!=evTable)
+            {
+                retVal->ownedEvents.push_back(pruned);
+                evTable=pruned;
+            }
+        }
+        passed.push_back(std::make_pair(i,evTable));
+    }
+
+    if (_cborEvents)
+    { // same encoding as CInterfaceStack::getCborEncodedBufferFromTable
+        if (cborEncodedEvents.size()==0)
+            cborEncodedEvents.resize(buff->getArraySize());
+        CCbor cbor(nullptr,0);
+        if (passed.size()==0)
+            cbor.appendMap(0);
+        else
+        {
+            cbor.appendArray(passed.size());
+            for (size_t i=0;i<passed.size();i++)
+            {
+                CInterfaceStackTable* evTable=passed[i].second;
+                if (evTable==buff->getArrayItemAtIndex(passed[i].first))
+                {
+                    std::string& enc=cborEncodedEvents[passed[i].first];
+                    if (enc.size()==0)
+                    {
+                        CCbor evCbor(nullptr,0);
+                        evTable->addCborObjectData(&evCbor);
+                        enc=evCbor.getBuff();
+                    }
+                    cbor.appendRaw((const unsigned char*)enc.c_str(),enc.size());
+                }
+                else
+                    evTable->addCborObjectData(&cbor);
+            }
+        }
+        cbor.appendBreakIfApplicable();
+        size_t l;
+        const unsigned char* b=cbor.getBuff(l);
+        retVal->stack->pushStringOntoStack((const char*)b,l);
+        for (size_t i=0;i<retVal->ownedEvents.size();i++)
+            delete retVal->ownedEvents[i];
+        retVal->ownedEvents.clear();
+    }
+    else
+    {
+        retVal->stack->pushTableOntoStack();
+        CInterfaceStackTable* dest=(CInterfaceStackTable*)retVal->stack->getStackObjectFromIndex(0);
+        for (size_t i=0;i<passed.size();i++)
+            dest->appendArrayObject(passed[i].second);
+    }
+    return(retVal);
+}
+
+void CWorldContainer::_destroyFilteredEventBatch(SFilteredEventBatch* batch) const
+{
+    CInterfaceStackObject* obj=nullptr;
+    if (batch->stack->getStackSize()>0)
+        obj=batch->stack->getStackObjectFromIndex(0);
+    if ( (obj!=nullptr)&&(obj->getObjectType()==STACK_OBJECT_TABLE) )
+    { // table mode: hand back the borrowed events, then delete the pruned ones
+        std::vector<CInterfaceStackObject*> evts;
+        ((CInterfaceStackTable*)obj)->getAllObjectsAndClearTable(evts);
+        for (size_t i=0;i<batch->ownedEvents.size();i++)
+            delete batch->ownedEvents[i];
+    }
+    interfaceStackContainer->destroyStack(batch->stack);
+    delete batch;
+}
+
 #ifdef SIM_WITH_GUI
 void CWorldContainer::addMenu(VMenu* menu)
 { // GUI THREAD only
@@ -916,6 +1750,7 @@ void CWorldContainer::announceScriptStateWillBeErased(int scriptHandle,bool simu
     delete[] (char*)pluginReturnVal;
 
     moduleMenuItemContainer->announceScriptStateWillBeErased(scriptHandle);
+    setEventFilter({eventsubscriber_script,scriptHandle},nullptr);
     currentWorld->announceScriptStateWillBeErased(scriptHandle,simulationScript,sceneSwitchPersistentScript);
 }
 
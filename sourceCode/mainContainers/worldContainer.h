@@ -11,7 +11,17 @@
 #include <world.h>
 #include <_worldContainer_.h>
 #include <customData.h>
+#include <genesisEventSnapshot.h>
+#include <eventData.h>
+#include <eventNodePool.h>
+#include <eventLog.h>
+#include <cbor.h>
+#include <vThread.h>
 #include <tuple>
+#include <atomic>
+#include <unordered_map>
+#include <map>
+#include <set>
 
 #ifdef SIM_WITH_GUI
     #include <globalGuiTextureContainer.h>
@@ -38,20 +48,105 @@
 
 struct SEventInfo
 {
-    CInterfaceStackTable* eventTable;
+    CInterfaceStackTable* eventTable; // header + data. Built when the event reaches the event buffer, unless the events are streamed
+    CEventData* eventData; // directly CBOR-encoded when prepared in streaming mode
     std::string event;
     std::string subEvent;
     std::string dataSubtype;
     long long int uid;
+    long long int seq;
+    int handle;
     bool mergeable;
 };
 
+struct SEventMergeKey
+{ // event, field and subtype are ids of the strings, as attributed in _mergeEvents
+    long long int uid;
+    int event;
+    int field;
+    int subtype;
+    bool operator==(const SEventMergeKey& other) const
+    {
+        return( (uid==other.uid)&&(event==other.event)&&(field==other.field)&&(subtype==other.subtype) );
+    }
+};
+
+struct SEventMergeKeyHash
+{
+    size_t operator()(const SEventMergeKey& key) const
+    {
+        size_t h=std::hash<long long int>()(key.uid);
+        h^=std::hash<int>()(key.event)+0x9e3779b97f4a7c15ULL+(h<<6)+(h>>2);
+        h^=std::hash<int>()(key.field)+0x9e3779b97f4a7c15ULL+(h<<6)+(h>>2);
+        h^=std::hash<int>()(key.subtype)+0x9e3779b97f4a7c15ULL+(h<<6)+(h>>2);
+        return(h);
+    }
+};
+
 struct SBufferedEvents
 {
     CInterfaceStack* eventsStack;
     std::vector<SEventInfo> eventDescriptions;
+    CCbor* cborStream; // not nullptr: events are directly CBOR-encoded in there, eventsStack stays empty until dispatch
+    size_t streamedEventCnt;
+    std::unordered_map<long long int,std::vector<SEventInfo>> pendingMergeable; // streaming mode only (uid-->events)
+    size_t pendingEventCnt;
+    bool liveBuffer; // i.e. not a temporary buffer used to collect genesis events. Feeds the genesis snapshot
+};
+
+struct SEventQueueNode
+{ // see CEventNodePool
+    SEventInfo event;
+    SEventQueueNode* next;
+    int poolIndex; // -1 if not from the pool
+    std::atomic<unsigned int> nextFreeNode; // index+1 in the pool's free list
+};
+
+struct SEventLogReplay
+{
+    CEventLogReader reader;
+    double speed;
+    long long int startTime;
+    const unsigned char* payload; // next record, not yet replayed. Valid until the next reader.getNextRecord
+    size_t payloadSize;
+    unsigned long long int recordTime;
+    int replayedBatchCnt;
 };
 
+struct SEventFilter
+{ // empty sets do not filter
+    std::set<std::string> eventTypes;
+    std::set<long long int> uids; // an event passes if its uid or its handle is listed
+    std::set<int> handles;
+    std::set<std::string> fieldNames; // other data fields are removed. Events left without data fields are skipped
+
+    bool isEmpty() const
+    {
+        return( eventTypes.empty()&&uids.empty()&&handles.empty()&&fieldNames.empty() );
+    }
+};
+
+enum {
+    eventsubscriber_script=0, // sysCall_event
+    eventsubscriber_plugin // event callback, see simSetPluginEventFilters
+};
+
+struct SEventSubscriber
+{
+    int type;
+    int handle; // script or plugin handle
+
+    bool operator<(const SEventSubscriber& other) const
+    {
+        return( (type<other.type)||((type==other.type)&&(handle<other.handle)) );
+    }
+};
+
+struct SFilteredEventBatch
+{
+    CInterfaceStack* stack;
+    std::vector<CInterfaceStackObject*> ownedEvents; // events with pruned fields. The other events are borrowed from the full batch
+};
 
 class CWorldContainer : public _CWorldContainer_
 {
@@ -79,16 +174,29 @@ public:
     void callScripts(int callType,CInterfaceStack* inStack,CInterfaceStack* outStack,CSceneObject* objectBranch=nullptr);
     void broadcastMsg(CInterfaceStack* inStack,int options);
 
-    std::tuple<SEventInfo,CInterfaceStackTable*> prepareNakedEvent(const char* event,int handle,long long int uid,bool mergeable);
-    std::tuple<SEventInfo,CInterfaceStackTable*> prepareEvent(const char* event,long long int uid,const char* fieldName,bool mergeable);
+    std::tuple<SEventInfo,CEventData*> prepareNakedEvent(const char* event,int handle,long long int uid,bool mergeable);
+    std::tuple<SEventInfo,CEventData*> prepareEvent(const char* event,long long int uid,const char* fieldName,bool mergeable);
     void pushSceneObjectRemoveEvent(const CSceneObject* object);
-    std::tuple<SEventInfo,CInterfaceStackTable*> prepareSceneObjectAddEvent(const CSceneObject* object);
-    std::tuple<SEventInfo,CInterfaceStackTable*> prepareSceneObjectChangedEvent(const CSceneObject* object,bool isCommonObjectData,const char* fieldName,bool mergeable);
-    std::tuple<SEventInfo,CInterfaceStackTable*> prepareSceneObjectChangedEvent(int sceneObjectHandle,bool isCommonObjectData,const char* fieldName,bool mergeable);
-    std::tuple<SEventInfo,CInterfaceStackTable*> _prepareGeneralEvent(const char* event,int objectHandle,long long int uid,const char* objType,const char* fieldName,bool mergeable);
-    void _combineDuplicateEvents(SBufferedEvents* events) const;
+    std::tuple<SEventInfo,CEventData*> prepareSceneObjectAddEvent(const CSceneObject* object);
+    std::tuple<SEventInfo,CEventData*> prepareSceneObjectChangedEvent(const CSceneObject* object,bool isCommonObjectData,const char* fieldName,bool mergeable);
+    std::tuple<SEventInfo,CEventData*> prepareSceneObjectChangedEvent(int sceneObjectHandle,bool isCommonObjectData,const char* fieldName,bool mergeable);
+    std::tuple<SEventInfo,CEventData*> _prepareGeneralEvent(const char* event,int objectHandle,long long int uid,const char* objType,const char* fieldName,bool mergeable);
     void _mergeEvents(SBufferedEvents* events) const;
-    void _prepareEventsForDispatch(SBufferedEvents* events) const;
+    static const std::string& _getMergedDataSubtype(const SEventInfo& newer,const SEventInfo& older);
+    void _prepareEventsForDispatch(SBufferedEvents* events,std::map<SEventSubscriber,SFilteredEventBatch*>* filteredBatches=nullptr) const;
+    SFilteredEventBatch* _buildFilteredEventBatch(const SBufferedEvents* events,const SEventFilter& filter,std::vector<std::string>& cborEncodedEvents) const;
+    void _destroyFilteredEventBatch(SFilteredEventBatch* batch) const;
+    static CInterfaceStackTable* _getEventWithFields(CInterfaceStackTable* event,const std::set<std::string>& fieldNames,const std::string& dataSubtype);
+    static CInterfaceStackTable* _copyEventFields(const CInterfaceStackTable* data,const std::set<std::string>& fieldNames,const std::string& dataSubtype);
+    static std::string _getEventFilterSignature(const SEventFilter& filter);
+    void _drainEventQueue(SBufferedEvents* events,SBufferedEvents* benchmarkEvents=nullptr);
+    static void _pushEventNode(std::atomic<SEventQueueNode*>& queue,SEventQueueNode* node);
+    static void _popEventNodes(std::atomic<SEventQueueNode*>& queue,std::vector<SEventQueueNode*>& nodes);
+    void _appendEventToBuffer(SBufferedEvents* events,SEventInfo& event) const;
+    void _streamEvent(SBufferedEvents* events,SEventInfo& event) const;
+    static void _encodeEvent(SBufferedEvents* events,const SEventInfo& event,long long int seq);
+    SBufferedEvents* _createBufferedEvents(CInterfaceStack* stack,bool cborStream) const;
+    void _destroyBufferedEvents(SBufferedEvents* events,bool destroyStack) const;
 
 
     void pushEvent(SEventInfo& event);
@@ -96,10 +204,24 @@ public:
     bool getCborEvents() const;
     void setCborEvents(bool b);
     void setMergeEvents(bool b);
+    bool getCborEventStream() const;
+    bool setCborEventStream(bool b); // false if event filters are set
     bool getEventsEnabled() const;
     void pushGenesisEvents();
+    bool setEventFilter(const SEventSubscriber& subscriber,const SEventFilter* filter); // false for a non-empty filter in CBOR streaming mode
+    static void getEventFilterFromTable(const CInterfaceStackTable* table,SEventFilter& filter);
+    CInterfaceStack* getEventBatchForSubscriber(const SEventSubscriber& subscriber,CInterfaceStack* fullBatch) const;
     void getGenesisEvents(CInterfaceStack* stack);
+    void setGenesisSnapshotMaxSize(size_t bytes);
+    bool startEventRecording(const char* filePrefix,size_t segmentSize);
+    void stopEventRecording();
+    int replayEventLog(const char* filePrefix,double speed);
+    int handleEventLogReplay();
+    void stopEventLogReplay();
     SBufferedEvents* swapBufferedEvents(SBufferedEvents* newBuffer);
+    void benchmarkEventMerging(size_t eventCount,size_t uidCount,bool mergeable,double& pushMs,double& mergeMs,size_t& keptEvents);
+    bool testEventMerging(std::string& errorString);
+    void benchmarkEventPush(size_t threadCnt,size_t eventsPerThread,double& pushMs,bool& orderOk);
 
     void simulationAboutToStart();
     void simulationPaused();
@@ -131,17 +253,33 @@ public:
 
 private:
     bool _switchToWorld(int newWorldIndex);
+    void _pushAppGenesisEvents();
+    void _refreshDirtyGenesisSnapshotObjects();
+    void _recordEventBatch(CInterfaceStack* batch);
+    void _dispatchEventsToPlugins(CInterfaceStack* fullBatch);
+    static VTHREAD_RETURN_TYPE _eventPushBenchmarkWorker(VTHREAD_ARGUMENT_TYPE lpData);
 
     std::vector<CWorld*> _worlds;
     int _currentWorldIndex;
     std::string _sessionId;
 
-    static long long int _eventSeq;
-    static long long int _mergedEventSeq;
+    static std::atomic<long long int> _eventSeq;
+    static std::atomic<long long int> _mergedEventSeq;
     SBufferedEvents* _bufferedEvents;
-    VMutex _eventMutex;
+    VMutex _eventMutex; // consumer side only (buffer drain and swap)
+    std::atomic<SEventQueueNode*> _eventQueue; // lock-free multi-producer stack, drained by the consumer
+    std::atomic<size_t> _queuedEventCnt;
+    CEventNodePool _eventNodePool;
+    CGenesisEventSnapshot* _genesisSnapshot;
+    std::atomic<CEventLogWriter*> _eventLogWriter; // non-null while recording. Read from any thread via getEventsEnabled
+    SEventLogReplay* _eventLogReplay; // non-null during a paced replay
+    int _eventLogReplayId; // incremented when a replay starts or stops
     bool _cborEvents;
+    bool _cborEventStream;
     bool _mergeTheEvents;
+    std::map<SEventSubscriber,SEventFilter> _eventFilters; // plugins are only dispatched events if listed here, possibly with an empty filter
+    std::atomic<int> _subscribedPluginCnt; // read from any thread via getEventsEnabled
+    std::map<SEventSubscriber,SFilteredEventBatch*> _filteredEventBatches; // during dispatch only. Subscribers with identical filters share a batch
 
     std::vector<long long int> _uniqueIdsOfSelectionSinceLastTimeGetAndClearModificationFlagsWasCalled;
     int _modificationFlags;
@@ -0,0 +1,179 @@
+#include <vMappedFile.h>
+#include <vFile.h>
+#include <vVarious.h>
+#ifndef WIN_SIM
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/types.h>
+#endif
+
+VMappedFile::VMappedFile()
+{
+#ifdef WIN_SIM
+    _file=INVALID_HANDLE_VALUE;
+    _mapping=nullptr;
+#else
+    _file=-1;
+#endif
+    _data=nullptr;
+    _capacity=0;
+    _writing=false;
+}
+
+VMappedFile::~VMappedFile()
+{
+    close(_capacity);
+}
+
+bool VMappedFile::openForWriting(const char* filename,size_t capacity)
+{
+    close(_capacity);
+    _filename=filename;
+    std::string path(VVarious::splitPath_path(filename));
+    if ( (path.size()>0)&&(!VFile::doesFolderExist(path.c_str())) )
+        VFile::createFolder(path.c_str());
+    _capacity=capacity;
+#ifdef WIN_SIM
+    _file=CreateFileA(filename,GENERIC_READ|GENERIC_WRITE,FILE_SHARE_READ,nullptr,CREATE_ALWAYS,FILE_ATTRIBUTE_NORMAL,nullptr);
+    if (_file==INVALID_HANDLE_VALUE)
+        return(false);
+#else
+    _file=open(filename,O_RDWR|O_CREAT|O_TRUNC,0644);
+    if (_file==-1)
+        return(false);
+    if (ftruncate(_file,off_t(capacity))!=0)
+    {
+        ::close(_file);
+        _file=-1;
+        return(false);
+    }
+#endif
+    return(_map(true));
+}
+
+bool VMappedFile::openForReading(const char* filename)
+{
+    close(_capacity);
+    _filename=filename;
+#ifdef WIN_SIM
+    _file=CreateFileA(filename,GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+    if (_file==INVALID_HANDLE_VALUE)
+        return(false);
+    LARGE_INTEGER s;
+    GetFileSizeEx(_file,&s);
+    _capacity=size_t(s.QuadPart);
+#else
+    _file=open(filename,O_RDONLY);
+    if (_file==-1)
+        return(false);
+    struct stat s;
+    fstat(_file,&s);
+    _capacity=size_t(s.st_size);
+#endif
+    return(_map(false));
+}
+
+bool VMappedFile::_map(bool writing)
+{
+    _writing=writing;
+    bool retVal=false;
+    if (_capacity>0)
+    {
+#ifdef WIN_SIM
+        LARGE_INTEGER s;
+        s.QuadPart=_capacity;
+        _mapping=CreateFileMappingA(_file,nullptr,writing?PAGE_READWRITE:PAGE_READONLY,s.HighPart,s.LowPart,nullptr);
+        if (_mapping!=nullptr)
+        {
+            _data=(unsigned char*)MapViewOfFile(_mapping,writing?FILE_MAP_WRITE:FILE_MAP_READ,0,0,_capacity);
+            retVal=(_data!=nullptr);
+        }
+#else
+        void* d=mmap(nullptr,_capacity,writing?(PROT_READ|PROT_WRITE):PROT_READ,MAP_SHARED,_file,0);
+        if (d!=MAP_FAILED)
+        {
+            _data=(unsigned char*)d;
+            retVal=true;
+        }
+#endif
+    }
+    if (!retVal)
+        close(0);
+    return(retVal);
+}
+
+bool VMappedFile::close(size_t finalSize)
+{
+    bool retVal=true;
+    if (_data!=nullptr)
+    {
+#ifdef WIN_SIM
+        if (_writing)
+            FlushViewOfFile(_data,finalSize);
+        UnmapViewOfFile(_data);
+#else
+        if (_writing)
+            msync(_data,finalSize,MS_SYNC);
+        munmap(_data,_capacity);
+#endif
+        _data=nullptr;
+    }
+#ifdef WIN_SIM
+    if (_mapping!=nullptr)
+    {
+        CloseHandle(_mapping);
+        _mapping=nullptr;
+    }
+    if (_file!=INVALID_HANDLE_VALUE)
+    {
+        if (_writing)
+        { // drop the unused, preallocated part:
+            LARGE_INTEGER s;
+            s.QuadPart=finalSize;
+            retVal=( SetFilePointerEx(_file,s,nullptr,FILE_BEGIN)&&SetEndOfFile(_file) );
+        }
+        CloseHandle(_file);
+        _file=INVALID_HANDLE_VALUE;
+    }
+#else
+    if (_file!=-1)
+    {
+        if (_writing)
+            retVal=(ftruncate(_file,off_t(finalSize))==0); // drop the unused, preallocated part
+        ::close(_file);
+        _file=-1;
+    }
+#endif
+    _capacity=0;
+    _writing=false;
+    return(retVal);
+}
+
+void VMappedFile::flush(size_t size)
+{
+    if ( (_data!=nullptr)&&_writing )
+    {
+#ifdef WIN_SIM
+        FlushViewOfFile(_data,size);
+#else
+        msync(_data,size,MS_ASYNC);
+#endif
+    }
+}
+
+bool VMappedFile::isOpen() const
+{
+    return(_data!=nullptr);
+}
+
+unsigned char* VMappedFile::getData() const
+{
+    return(_data);
+}
+
+size_t VMappedFile::getCapacity() const
+{
+    return(_capacity);
+}
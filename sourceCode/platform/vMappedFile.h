@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+
+#ifdef WIN_SIM
+    #include <Windows.h>
+    typedef HANDLE WMappedFileHandle;
+#else
+    typedef int WMappedFileHandle;
+#endif
+
+class VMappedFile
+{ // A file mapped into memory, either read-only, or read-write with a fixed capacity
+public:
+    VMappedFile();
+    virtual ~VMappedFile();
+
+    bool openForWriting(const char* filename,size_t capacity); // creates or truncates the file
+    bool openForReading(const char* filename);
+    bool close(size_t finalSize); // finalSize is only used when writing. The file is truncated to that size
+    void flush(size_t size);
+    bool isOpen() const;
+
+    unsigned char* getData() const;
+    size_t getCapacity() const;
+
+private:
+    bool _map(bool writing);
+
+    std::string _filename;
+    WMappedFileHandle _file;
+#ifdef WIN_SIM
+    HANDLE _mapping;
+#endif
+    unsigned char* _data;
+    size_t _capacity;
+    bool _writing;
+};
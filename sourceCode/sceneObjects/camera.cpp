@@ -990,11 +990,9 @@ void CCamera::removeSceneDependencies()
     _trackedObjectHandle=-1;
 }
 
-void CCamera::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CCamera::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("camera",subC);
-    data=subC;
+    data->openMapObject_stringMap("camera");
 
     if (_perspectiveOperation!=-1)
         data->appendMapObject_stringBool("perspectiveMode",_perspectiveOperation!=0);
@@ -1008,22 +1006,24 @@ void CCamera::addSpecializedObjectEventData(CInterfaceStackTable* data) const
     data->appendMapObject_stringBool("showFrustum",_showVolume);
     data->appendMapObject_stringInt32("remoteCameraMode",_remoteCameraMode);
 
-    CInterfaceStackTable* fr=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("frustumVectors",fr);
-    fr->appendMapObject_stringDoubleArray("near",_volumeVectorNear.data,3);
-    fr->appendMapObject_stringDoubleArray("far",_volumeVectorFar.data,3);
+    data->openMapObject_stringMap("frustumVectors");
+    data->appendMapObject_stringDoubleArray("near",_volumeVectorNear.data,3);
+    data->appendMapObject_stringDoubleArray("far",_volumeVectorFar.data,3);
+    data->closeObject();
 
-    CInterfaceStackTable* colors=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("colors",colors);
+    data->openMapObject_stringArray("colors");
     float c[9];
     _color.getColor(c,sim_colorcomponent_ambient_diffuse);
     _color.getColor(c+3,sim_colorcomponent_specular);
     _color.getColor(c+6,sim_colorcomponent_emission);
-    colors->appendArrayObject_floatArray(c,9);
+    data->appendArrayObject_floatArray(c,9);
     _color_removeSoon.getColor(c,sim_colorcomponent_ambient_diffuse);
     _color_removeSoon.getColor(c+3,sim_colorcomponent_specular);
     _color_removeSoon.getColor(c+6,sim_colorcomponent_emission);
-    colors->appendArrayObject_floatArray(c,9);
+    data->appendArrayObject_floatArray(c,9);
+    data->closeObject();
+
+    data->closeObject();
 }
 
 CSceneObject* CCamera::copyYourself()
@@ -2963,8 +2963,7 @@ void CCamera::_drawObjects(int renderingMode,int pass,int currentWinSize[2],CSVi
 
 CSceneObject* CCamera::_getInfoOfWhatNeedsToBeRendered(std::vector<CSceneObject*>& toRender)
 {
-    std::vector<int> transparentObjects;
-    std::vector<double> transparentObjectDist;
+    std::vector<CSceneObject*> transparent;
     C7Vector camTrInv(getCumulativeTransformation().getInverse());
     CSceneObject* viewBoxObject=nullptr;
     for (size_t i=0;i<App::currentWorld->sceneObjects->getObjectCount();i++)
@@ -2974,11 +2973,7 @@ CSceneObject* CCamera::_getInfoOfWhatNeedsToBeRendered(std::vector<CSceneObject*
         {
             CShape* sh=(CShape*)it;
             if (sh->getContainsTransparentComponent())
-            {
-                C7Vector obj(it->getCumulativeTransformation());
-                transparentObjectDist.push_back(-(camTrInv*obj).X(2)-it->getTransparentObjectDistanceOffset());
-                transparentObjects.push_back(it->getObjectHandle());
-            }
+                transparent.push_back(it);
             else
                 toRender.push_back(it);
         }
@@ -2988,11 +2983,7 @@ CSceneObject* CCamera::_getInfoOfWhatNeedsToBeRendered(std::vector<CSceneObject*
             {
                 CMirror* mir=(CMirror*)it;
                 if (mir->getContainsTransparentComponent())
-                {
-                    C7Vector obj(it->getCumulativeTransformation());
-                    transparentObjectDist.push_back(-(camTrInv*obj).X(2)-it->getTransparentObjectDistanceOffset());
-                    transparentObjects.push_back(it->getObjectHandle());
-                }
+                    transparent.push_back(it);
                 else
                     toRender.push_back(it);
             }
@@ -3003,6 +2994,15 @@ CSceneObject* CCamera::_getInfoOfWhatNeedsToBeRendered(std::vector<CSceneObject*
             viewBoxObject=it;
     }
 
+    std::vector<C7Vector> transformations; // shapes and mirrors: same as getCumulativeTransformation
+    App::currentWorld->sceneObjects->getWorldTransformations(transparent,transformations); // batch read
+    std::vector<int> transparentObjects;
+    std::vector<double> transparentObjectDist;
+    for (size_t i=0;i<transparent.size();i++)
+    {
+        transparentObjectDist.push_back(-(camTrInv*transformations[i]).X(2)-transparent[i]->getTransparentObjectDistanceOffset());
+        transparentObjects.push_back(transparent[i]->getObjectHandle());
+    }
     tt::orderAscending(transparentObjectDist,transparentObjects);
     for (int i=0;i<int(transparentObjects.size());i++)
         toRender.push_back(App::currentWorld->sceneObjects->getObjectFromHandle(transparentObjects[i]));
@@ -277,21 +277,21 @@ void CDummy::removeSceneDependencies()
     setLinkedDummyHandle(-1,false);
 }
 
-void CDummy::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CDummy::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("dummy",subC);
-    data=subC;
+    data->openMapObject_stringMap("dummy");
 
     data->appendMapObject_stringFloat("size",_dummySize);
 
-    CInterfaceStackTable* colors=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("colors",colors);
+    data->openMapObject_stringArray("colors");
     float c[9];
     _dummyColor.getColor(c,sim_colorcomponent_ambient_diffuse);
     _dummyColor.getColor(c+3,sim_colorcomponent_specular);
     _dummyColor.getColor(c+6,sim_colorcomponent_emission);
-    colors->appendArrayObject_floatArray(c,9);
+    data->appendArrayObject_floatArray(c,9);
+    data->closeObject();
+
+    data->closeObject();
 }
 
 CSceneObject* CDummy::copyYourself()
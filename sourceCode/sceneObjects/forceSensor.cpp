@@ -323,6 +323,7 @@ void CForceSensor::setIntrinsicTransformationError(const C7Vector& tr)
     if (diff)
     {
         _intrinsicTransformationError=tr;
+        _invalidateCumulativeTransformations();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="intrinsicPose";
@@ -464,29 +465,29 @@ void CForceSensor::removeSceneDependencies()
     CSceneObject::removeSceneDependencies();
 }
 
-void CForceSensor::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CForceSensor::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("forceSensor",subC);
-    data=subC;
+    data->openMapObject_stringMap("forceSensor");
 
     data->appendMapObject_stringFloat("size",_forceSensorSize);
 
-    CInterfaceStackTable* colors=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("colors",colors);
+    data->openMapObject_stringArray("colors");
     float c[9];
     _color.getColor(c,sim_colorcomponent_ambient_diffuse);
     _color.getColor(c+3,sim_colorcomponent_specular);
     _color.getColor(c+6,sim_colorcomponent_emission);
-    colors->appendArrayObject_floatArray(c,9);
+    data->appendArrayObject_floatArray(c,9);
     _color_removeSoon.getColor(c,sim_colorcomponent_ambient_diffuse);
     _color_removeSoon.getColor(c+3,sim_colorcomponent_specular);
     _color_removeSoon.getColor(c+6,sim_colorcomponent_emission);
-    colors->appendArrayObject_floatArray(c,9);
+    data->appendArrayObject_floatArray(c,9);
+    data->closeObject();
     C7Vector tr(getIntrinsicTransformation(true));
     double p[7]={tr.X(0),tr.X(1),tr.X(2),tr.Q(1),tr.Q(2),tr.Q(3),tr.Q(0)};
     data->appendMapObject_stringDoubleArray("intrinsicPose",p,7);
     // todo
+
+    data->closeObject();
 }
 
 CSceneObject* CForceSensor::copyYourself()
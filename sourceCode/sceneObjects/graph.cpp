@@ -572,15 +572,15 @@ void CGraph::removeSceneDependencies()
     CSceneObject::removeSceneDependencies();
 }
 
-void CGraph::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CGraph::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("graph",subC);
-    data=subC;
+    data->openMapObject_stringMap("graph");
 
     data->appendMapObject_stringFloat("size",_graphSize);
 
     // todo
+
+    data->closeObject();
 }
 
 CSceneObject* CGraph::copyYourself()
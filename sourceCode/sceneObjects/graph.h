@@ -19,7 +19,7 @@ public:
 
     // Following functions are inherited from CSceneObject
     void display(CViewableBase* renderingObject,int displayAttrib);
-    void addSpecializedObjectEventData(CInterfaceStackTable* data) const;
+    void addSpecializedObjectEventData(CEventData* data) const;
     CSceneObject* copyYourself();
     void removeSceneDependencies();
     void scaleObject(double scalingFactor);
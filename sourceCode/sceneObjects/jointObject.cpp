@@ -1272,6 +1272,7 @@ bool CJoint::setScrewPitch(double pitch)
             if (diff)
             {
                 _screwPitch=pitch;
+                _invalidateCumulativeTransformations();
                 if (getObjectCanSync())
                     _setScrewPitch_sendOldIk(pitch);
                 if (pitch!=0.0)
@@ -2080,11 +2081,9 @@ void CJoint::removeSceneDependencies()
     setDependencyMasterJointHandle(-1);
 }
 
-void CJoint::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CJoint::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("joint",subC);
-    data=subC;
+    data->openMapObject_stringMap("joint");
 
     std::string tmp;
     switch(_jointType)
@@ -2110,30 +2109,32 @@ void CJoint::addSpecializedObjectEventData(CInterfaceStackTable* data) const
     data->appendMapObject_stringFloat("diameter",_diameter);
     data->appendMapObject_stringFloat("length",_length);
 
-    CInterfaceStackTable* colors=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("colors",colors);
+    data->openMapObject_stringArray("colors");
     float c[9];
     _color.getColor(c,sim_colorcomponent_ambient_diffuse);
     _color.getColor(c+3,sim_colorcomponent_specular);
     _color.getColor(c+6,sim_colorcomponent_emission);
-    colors->appendArrayObject_floatArray(c,9);
+    data->appendArrayObject_floatArray(c,9);
     _color_removeSoon.getColor(c,sim_colorcomponent_ambient_diffuse);
     _color_removeSoon.getColor(c+3,sim_colorcomponent_specular);
     _color_removeSoon.getColor(c+6,sim_colorcomponent_emission);
-    colors->appendArrayObject_floatArray(c,9);
+    data->appendArrayObject_floatArray(c,9);
+    data->closeObject();
 
-    CInterfaceStackTable* dependency=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("dependency",dependency);
+    data->openMapObject_stringMap("dependency");
     if (_dependencyMasterJointHandle!=-1)
     {
         CSceneObject* master=App::currentWorld->sceneObjects->getJointFromHandle(_dependencyMasterJointHandle);
         if (master!=nullptr)
         {
-            dependency->appendMapObject_stringInt64("masterUid",master->getObjectUid());
-            dependency->appendMapObject_stringFloat("mult",_dependencyJointMult);
-            dependency->appendMapObject_stringFloat("off",_dependencyJointOffset);
+            data->appendMapObject_stringInt64("masterUid",master->getObjectUid());
+            data->appendMapObject_stringFloat("mult",_dependencyJointMult);
+            data->appendMapObject_stringFloat("off",_dependencyJointOffset);
         }
     }
+    data->closeObject();
+
+    data->closeObject();
 }
 
 CSceneObject* CJoint::copyYourself()
@@ -4095,6 +4096,7 @@ void CJoint::setSphericalTransformation(const C4Vector& tr)
     if (diff)
     {
         _sphericalTransf=tr;
+        _invalidateCumulativeTransformations();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="quaternion";
@@ -4191,6 +4193,7 @@ void CJoint::setPosition(double pos,const CJoint* masterJoint/*=nullptr*/,bool s
     if (diff)
     {
         _pos=pos;
+        _invalidateCumulativeTransformations();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="position";
@@ -4881,6 +4884,7 @@ void CJoint::setIntrinsicTransformationError(const C7Vector& tr)
     if (diff)
     {
         _intrinsicTransformationError=tr;
+        _invalidateCumulativeTransformations();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="position";
@@ -265,27 +265,27 @@ void CLight::removeSceneDependencies()
     CSceneObject::removeSceneDependencies();
 }
 
-void CLight::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CLight::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("light",subC);
-    data=subC;
+    data->openMapObject_stringMap("light");
 
     data->appendMapObject_stringFloat("size",_lightSize);
 
-    CInterfaceStackTable* colors=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("colors",colors);
+    data->openMapObject_stringArray("colors");
     float c[9];
     objectColor.getColor(c,sim_colorcomponent_ambient_diffuse);
     objectColor.getColor(c+3,sim_colorcomponent_specular);
     objectColor.getColor(c+6,sim_colorcomponent_emission);
-    colors->appendArrayObject_floatArray(c,9);
+    data->appendArrayObject_floatArray(c,9);
     lightColor.getColor(c,sim_colorcomponent_diffuse);
     lightColor.getColor(c+3,sim_colorcomponent_specular);
     lightColor.getColor(c+6,sim_colorcomponent_emission);
-    colors->appendArrayObject_floatArray(c,9);
+    data->appendArrayObject_floatArray(c,9);
+    data->closeObject();
 
     // todo
+
+    data->closeObject();
 }
 
 CSceneObject* CLight::copyYourself()
@@ -111,13 +111,13 @@ void CMill::removeSceneDependencies()
     _millableObject=-1;
 }
 
-void CMill::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CMill::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("mill",subC);
-    data=subC;
+    data->openMapObject_stringMap("mill");
 
     // todo
+
+    data->closeObject();
 }
 
 CSceneObject* CMill::copyYourself()
@@ -178,13 +178,13 @@ void CMirror::removeSceneDependencies()
     CSceneObject::removeSceneDependencies();
 }
 
-void CMirror::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CMirror::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("mirror",subC);
-    data=subC;
+    data->openMapObject_stringMap("mirror");
 
     // todo
+
+    data->closeObject();
 }
 
 CSceneObject* CMirror::copyYourself()
@@ -184,9 +184,7 @@ void COctree::_updateOctreeEvent() const
         const char* cmd="voxels";
         auto [event,data]=App::worldContainer->prepareSceneObjectChangedEvent(this,false,cmd,true);
         data->appendMapObject_stringFloat("voxelSize",_cellSize);
-        CInterfaceStackTable* subC=new CInterfaceStackTable();
-        data->appendMapObject_stringObject(cmd,subC);
-        data=subC;
+        data->openMapObject_stringMap(cmd);
 
         CCbor obj(nullptr,0);
         size_t l;
@@ -202,6 +200,7 @@ void COctree::_updateOctreeEvent() const
         obj.appendBuff(_colorsByte.data(),_colorsByte.size());
         buff=(const char*)obj.getBuff(l);
         data->appendMapObject_stringString("colors",buff,l,true);
+        data->closeObject();
         App::worldContainer->pushEvent(event);
     }
 }
@@ -594,17 +593,13 @@ void COctree::removeSceneDependencies()
     CSceneObject::removeSceneDependencies();
 }
 
-void COctree::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void COctree::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("octree",subC);
-    data=subC;
+    data->openMapObject_stringMap("octree");
 
     data->appendMapObject_stringFloat("voxelSize",_cellSize);
 
-    subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("voxels",subC);
-    data=subC;
+    data->openMapObject_stringMap("voxels");
 
     CCbor obj(nullptr,0);
     size_t l;
@@ -620,6 +615,9 @@ void COctree::addSpecializedObjectEventData(CInterfaceStackTable* data) const
     obj.appendBuff(_colorsByte.data(),_colorsByte.size());
     buff=(const char*)obj.getBuff(l);
     data->appendMapObject_stringString("colors",buff,l,true);
+    data->closeObject();
+
+    data->closeObject();
 }
 
 CSceneObject* COctree::copyYourself()
@@ -220,13 +220,13 @@ void CPath_old::removeSceneDependencies()
     CSceneObject::removeSceneDependencies();
 }
 
-void CPath_old::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CPath_old::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("path",subC);
-    data=subC;
+    data->openMapObject_stringMap("path");
 
     // todo
+
+    data->closeObject();
 }
 
 CSceneObject* CPath_old::copyYourself()
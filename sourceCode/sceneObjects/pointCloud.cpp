@@ -238,9 +238,7 @@ void CPointCloud::_updatePointCloudEvent() const
         const char* cmd="points";
         auto [event,data]=App::worldContainer->prepareSceneObjectChangedEvent(this,false,cmd,true);
 
-        CInterfaceStackTable* subC=new CInterfaceStackTable();
-        data->appendMapObject_stringObject(cmd,subC);
-        data=subC;
+        data->openMapObject_stringMap(cmd);
 
         CCbor obj(nullptr,0);
         size_t l;
@@ -256,6 +254,7 @@ void CPointCloud::_updatePointCloudEvent() const
         obj.appendBuff(_displayColorsByte.data(),_displayColorsByte.size());
         buff=(const char*)obj.getBuff(l);
         data->appendMapObject_stringString("colors",buff,l,true);
+        data->closeObject();
         App::worldContainer->pushEvent(event);
     }
 }
@@ -679,17 +678,13 @@ void CPointCloud::removeSceneDependencies()
     CSceneObject::removeSceneDependencies();
 }
 
-void CPointCloud::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CPointCloud::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("pointCloud",subC);
-    data=subC;
+    data->openMapObject_stringMap("pointCloud");
 
     data->appendMapObject_stringInt32("pointSize",_pointSize);
 
-    subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("points",subC);
-    data=subC;
+    data->openMapObject_stringMap("points");
 
     CCbor obj(nullptr,0);
     size_t l;
@@ -705,6 +700,9 @@ void CPointCloud::addSpecializedObjectEventData(CInterfaceStackTable* data) cons
     obj.appendBuff(_displayColorsByte.data(),_displayColorsByte.size());
     buff=(const char*)obj.getBuff(l);
     data->appendMapObject_stringString("colors",buff,l,true);
+    data->closeObject();
+
+    data->closeObject();
 }
 
 CSceneObject* CPointCloud::copyYourself()
@@ -231,15 +231,15 @@ void CProxSensor::removeSceneDependencies()
     _sensableObject=-1;
 }
 
-void CProxSensor::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CProxSensor::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("proxSensor",subC);
-    data=subC;
+    data->openMapObject_stringMap("proxSensor");
 
     data->appendMapObject_stringFloat("size",_proxSensorSize);
 
     // todo
+
+    data->closeObject();
 }
 
 CSceneObject* CProxSensor::copyYourself()
@@ -36,7 +36,14 @@ bool CProxSensorRoutine::detectEntity(int sensorID,int entityID,bool closestFeat
         if (entityID==-1)
         { // Special group here (all detectable objects):
             std::vector<CSceneObject*> exception;
-            App::currentWorld->sceneObjects->getAllDetectableObjectsFromSceneExcept(&exception,group,sensor->getSensableType());
+            C7Vector volumeTr;
+            C3Vector volumeHalfSize;
+            sensor->getSensingVolumeOBB(volumeTr,volumeHalfSize);
+            std::vector<CSceneObject*> candidates; // objects with bounding boxes overlapping the sensing volume
+            if (App::currentWorld->sceneObjects->getBroadphaseCandidates(volumeTr,volumeHalfSize,0.0,candidates))
+                App::currentWorld->sceneObjects->getAllDetectableObjectsFromSceneExcept(&exception,group,sensor->getSensableType(),&candidates);
+            else
+                App::currentWorld->sceneObjects->getAllDetectableObjectsFromSceneExcept(&exception,group,sensor->getSensableType());
         }
         else
         { // Regular group here:
@@ -548,10 +555,12 @@ void CProxSensorRoutine::_orderGroupAccordingToApproxDistanceToSensingPoint(cons
     std::vector<CSceneObject*> _group(group);
     group.clear();
     C3Vector pt(sensor->getFullCumulativeTransformation().X);
+    std::vector<C7Vector> transformations;
+    App::currentWorld->sceneObjects->getWorldTransformations(_group,transformations); // batch read
     for (size_t i=0;i<_group.size();i++)
     {
         indexes.push_back((int)i);
-        double d=_getApproxPointObjectBoundingBoxDistance(pt,_group[i]);
+        double d=_getApproxPointObjectBoundingBoxDistance(pt,_group[i],&transformations[i]);
         distances.push_back(d);
     }
     tt::orderAscending(distances,indexes);
@@ -559,7 +568,7 @@ void CProxSensorRoutine::_orderGroupAccordingToApproxDistanceToSensingPoint(cons
         group.push_back(_group[indexes[i]]);
 }
 
-double CProxSensorRoutine::_getApproxPointObjectBoundingBoxDistance(const C3Vector& point,CSceneObject* obj)
+double CProxSensorRoutine::_getApproxPointObjectBoundingBoxDistance(const C3Vector& point,CSceneObject* obj,const C7Vector* objTr/*=nullptr*/)
 { // the returned distance is always same or smaller than the real distance!
     C3Vector halfSize;
     C7Vector tr;
@@ -568,12 +577,18 @@ double CProxSensorRoutine::_getApproxPointObjectBoundingBoxDistance(const C3Vect
     if (obj->getObjectType()==sim_object_shape_type)
     {
         halfSize=((CShape*)obj)->getBoundingBoxHalfSizes();
-        tr=obj->getFullCumulativeTransformation();
+        if (objTr!=nullptr)
+            tr=*objTr;
+        else
+            tr=obj->getFullCumulativeTransformation();
     }
     if (obj->getObjectType()==sim_object_dummy_type)
     {
         isPointToo=true;
-        tr=obj->getFullCumulativeTransformation();
+        if (objTr!=nullptr)
+            tr=*objTr;
+        else
+            tr=obj->getFullCumulativeTransformation();
     }
     if (obj->getObjectType()==sim_object_octree_type)
         ((COctree*)obj)->getTransfAndHalfSizeOfBoundingBox(tr,halfSize);
@@ -25,6 +25,6 @@ private:
     static int _detectObject(CProxSensor* sensor,CSceneObject* object,C3Vector& detectedPt,double& dist,C3Vector& triNormalNotNormalized,bool closestFeatureMode,bool angleLimitation,double maxAngle,bool frontFace,bool backFace,double minThreshold);
 
     static void _orderGroupAccordingToApproxDistanceToSensingPoint(const CProxSensor* sensor,std::vector<CSceneObject*>& group);
-    static double _getApproxPointObjectBoundingBoxDistance(const C3Vector& point,CSceneObject* obj);
+    static double _getApproxPointObjectBoundingBoxDistance(const C3Vector& point,CSceneObject* obj,const C7Vector* objTr=nullptr); // objTr: obj's full cumulative transformation, if already known
     static bool _doesSensorVolumeOverlapWithObjectBoundingBox(CProxSensor* sensor,CSceneObject* obj);
 };
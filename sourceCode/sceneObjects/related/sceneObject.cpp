@@ -22,11 +22,20 @@
 #include <base64.h>
 #include <boost/algorithm/string.hpp>
 #include <pluginContainer.h>
+#include <chrono>
 #ifdef SIM_WITH_GUI
     #include <oGL.h>
     #include <oglSurface.h>
 #endif
 
+#define SPATIALCHANGES_MAX_SIZE 100000
+
+std::atomic<unsigned long long int> CSceneObject::_transformationGeneration(1);
+static VMutex _spatialChangesMutex;
+static std::vector<long long int> _spatialChanges; // uids of the objects whose pose or bounding box changed during the current take
+static unsigned long long int _spatialChangesTake=1;
+static std::atomic<int> _spatialChangeTrackers(0); // no bookkeeping if 0
+
 CSceneObject::CSceneObject()
 {
     _selected=false;
@@ -36,6 +45,9 @@ CSceneObject::CSceneObject()
     _childOrder=-1;
     _scriptExecPriority=sim_scriptexecorder_normal;
     _localTransformation.setIdentity();
+    _fullCumulativeTransformationValid=false;
+    _spatialChangeTake=0;
+    _poseChangeTake=0;
     _parentObjectHandle_forSerializationOnly=-1;
     _objectHandle=-1;
     _beforeDeleteCallbackSent=false;
@@ -489,8 +501,192 @@ C7Vector CSceneObject::getCumulativeTransformation() const
 }
 
 C7Vector CSceneObject::getFullCumulativeTransformation() const
+{ // cached, and recomputed lazily. Other threads only read the cache
+    if (_fullCumulativeTransformationValid)
+        return(_fullCumulativeTransformation);
+    C7Vector retVal(getFullParentCumulativeTransformation()*getFullLocalTransformation());
+    setFullCumulativeTransformationCache(retVal);
+    return(retVal);
+}
+
+bool CSceneObject::isFullCumulativeTransformationCached() const
+{
+    return(_fullCumulativeTransformationValid);
+}
+
+void CSceneObject::setFullCumulativeTransformationCache(const C7Vector& tr) const
+{ // only by the simulation thread, for objects in the scene. Keeps the parent's cache valid if this one is valid
+    if ( _isInScene&&VThread::isCurrentThreadTheMainSimulationThread()&&((_parentObject==nullptr)||_parentObject->_fullCumulativeTransformationValid) )
+    {
+        _fullCumulativeTransformation=tr;
+        _fullCumulativeTransformationValid=true;
+    }
+}
+
+void CSceneObject::_invalidateCumulativeTransformations()
+{
+    _transformationGeneration++;
+    if (_spatialChangeTrackers>0)
+    {
+        _spatialChangesMutex.lock_simple("CSceneObject::_invalidateCumulativeTransformations");
+        _invalidateSubtreeTransformations(true);
+        _spatialChangesMutex.unlock_simple();
+    }
+    else
+        _invalidateSubtreeTransformations(false);
+}
+
+unsigned long long int CSceneObject::getTransformationGeneration()
 {
-    return(getFullParentCumulativeTransformation()*getFullLocalTransformation());
+    return(_transformationGeneration);
+}
+
+void CSceneObject::_invalidateSubtreeTransformations(bool trackSpatialChanges)
+{ // if an object's cache is invalid, so are the caches of its descendants. If an object's pose change is in the spatial changes,
+  // so are its descendants (not so for bounding box changes). With trackSpatialChanges, call with _spatialChangesMutex locked
+    bool subtree=_fullCumulativeTransformationValid;
+    _fullCumulativeTransformationValid=false;
+    if (trackSpatialChanges)
+    {
+        subtree=subtree||(_poseChangeTake!=_spatialChangesTake);
+        _markSpatialChange_locked();
+        _poseChangeTake=_spatialChangesTake; // after the mark, which can start a new take
+    }
+    if (subtree)
+    {
+        for (size_t i=0;i<_childList.size();i++)
+            _childList[i]->_invalidateSubtreeTransformations(trackSpatialChanges);
+    }
+}
+
+void CSceneObject::_markSpatialChange_locked()
+{
+    if (_spatialChangeTake!=_spatialChangesTake)
+    {
+        if (_spatialChanges.size()>=SPATIALCHANGES_MAX_SIZE)
+        { // not taken for a long time, e.g. no broadphase query. The next take will report missing changes
+            _spatialChanges.clear();
+            _spatialChangesTake++;
+        }
+        _spatialChangeTake=_spatialChangesTake;
+        _spatialChanges.push_back(_objectUid);
+    }
+}
+
+void CSceneObject::invalidateSpatialData()
+{ // the bounding box changed: only this object is added to the spatial changes
+    if (_spatialChangeTrackers>0)
+    {
+        _spatialChangesMutex.lock_simple("CSceneObject::invalidateSpatialData");
+        _markSpatialChange_locked();
+        _spatialChangesMutex.unlock_simple();
+    }
+}
+
+void CSceneObject::trackSpatialChanges(bool track)
+{ // by each broadphase, while it exists. When tracking starts, all objects are out of the spatial changes
+    _spatialChangesMutex.lock_simple("CSceneObject::trackSpatialChanges");
+    if (track)
+    {
+        if (_spatialChangeTrackers==0)
+        {
+            _spatialChanges.clear();
+            _spatialChangesTake++;
+        }
+        _spatialChangeTrackers++;
+    }
+    else
+        _spatialChangeTrackers--;
+    _spatialChangesMutex.unlock_simple();
+}
+
+bool CSceneObject::takeSpatialChanges(unsigned long long int& take,std::vector<long long int>& uids)
+{ // uids of the objects whose pose or bounding box changed since the caller's previous take (may contain unknown uids).
+  // Returns false if some changes were taken by someone else (e.g. the broadphase of another scene) or dropped in the mean time
+    uids.clear();
+    _spatialChangesMutex.lock_simple("CSceneObject::takeSpatialChanges");
+    bool retVal=(take==_spatialChangesTake);
+    uids.swap(_spatialChanges);
+    _spatialChangesTake++; // all objects are out of the spatial changes
+    take=_spatialChangesTake;
+    _spatialChangesMutex.unlock_simple();
+    return(retVal);
+}
+
+void CSceneObject::benchmarkTransformationCache(int depth,int operations,double writeRatio,double& cachedMs,double& uncachedMs,double& maxError)
+{ // a chain of 'depth' dummies, not part of the scene. Random reads of cumulative transformations, mixed with random writes of local transformations
+    std::vector<CSceneObject*> chain;
+    for (int i=0;i<depth;i++)
+    {
+        CSceneObject* obj=new CDummy();
+        obj->_isInScene=true; // so that the cache is used. Not registered, no events are generated (writes below bypass setLocalTransformation)
+        if (i>0)
+        {
+            chain[i-1]->_childList.push_back(obj);
+            obj->_parentObject=chain[i-1];
+        }
+        chain.push_back(obj);
+    }
+    std::vector<int> indices;
+    std::vector<bool> isWrite;
+    std::vector<C7Vector> writes;
+    for (int i=0;i<operations;i++)
+    {
+        indices.push_back(int(SIM_RAND_FLOAT*double(depth))%depth);
+        isWrite.push_back(SIM_RAND_FLOAT<writeRatio);
+        C7Vector tr;
+        tr.X=C3Vector(0.1*SIM_RAND_FLOAT,0.1*SIM_RAND_FLOAT,0.1*SIM_RAND_FLOAT);
+        tr.Q.setEulerAngles(SIM_RAND_FLOAT,SIM_RAND_FLOAT,SIM_RAND_FLOAT);
+        writes.push_back(tr);
+    }
+    std::vector<C7Vector> cachedResults;
+    std::vector<C7Vector> uncachedResults;
+    for (size_t pass=0;pass<2;pass++)
+    {
+        std::vector<C7Vector>* results=&cachedResults;
+        if (pass==1)
+            results=&uncachedResults;
+        for (int i=0;i<depth;i++)
+        {
+            chain[i]->_localTransformation.setIdentity();
+            chain[i]->_fullCumulativeTransformationValid=false;
+        }
+        auto start=std::chrono::steady_clock::now();
+        for (int i=0;i<operations;i++)
+        {
+            CSceneObject* obj=chain[indices[i]];
+            if (!isWrite[i])
+            {
+                if (pass==0)
+                    results->push_back(obj->getFullCumulativeTransformation());
+                else
+                { // as before caching was introduced
+                    C7Vector tr(obj->getFullLocalTransformation());
+                    for (CSceneObject* it=obj->_parentObject;it!=nullptr;it=it->_parentObject)
+                        tr=it->getFullLocalTransformation()*tr;
+                    results->push_back(tr);
+                }
+            }
+            else
+            {
+                obj->_localTransformation=writes[i];
+                obj->_invalidateCumulativeTransformations();
+            }
+        }
+        double ms=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+        if (pass==0)
+            cachedMs=ms;
+        else
+            uncachedMs=ms;
+    }
+    maxError=0.0;
+    for (size_t i=0;i<cachedResults.size();i++)
+    {
+        maxError=std::max<double>(maxError,(cachedResults[i].X-uncachedResults[i].X).getLength());
+        maxError=std::max<double>(maxError,cachedResults[i].Q.getAngleBetweenQuaternions(uncachedResults[i].Q));
+    }
+    for (int i=depth-1;i>=0;i--)
+        delete chain[i];
 }
 
 void CSceneObject::recomputeModelInfluencedValues(int overrideFlags/*=-1*/)
@@ -514,6 +710,8 @@ void CSceneObject::recomputeModelInfluencedValues(int overrideFlags/*=-1*/)
     {
         if (_modelBase)
             overrideFlags|=_modelProperty;
+        if (_calculatedModelProperty!=overrideFlags)
+            CEmbeddedScriptContainer::invalidateScriptsToExecute(); // scripts could have become (in)active
         _calculatedModelProperty=overrideFlags;
         _setModelInvisible((_calculatedModelProperty&sim_modelproperty_not_visible)!=0);
 
@@ -529,6 +727,13 @@ void CSceneObject::recomputeModelInfluencedValues(int overrideFlags/*=-1*/)
 void CSceneObject::setObjectUniqueId()
 {
     _objectUid=App::getFreshUniqueId();
+    if (_spatialChangeTrackers>0)
+    {
+        _spatialChangesMutex.lock_simple("CSceneObject::setObjectUniqueId");
+        if (_spatialChangeTake==_spatialChangesTake)
+            _spatialChanges.push_back(_objectUid); // the old uid is in there
+        _spatialChangesMutex.unlock_simple();
+    }
 }
 
 void CSceneObject::setSelected(bool s)
@@ -539,11 +744,13 @@ void CSceneObject::setSelected(bool s)
 void CSceneObject::setIsInScene(bool s)
 {
     _isInScene=s;
+    _invalidateCumulativeTransformations();
 }
 
 void CSceneObject::setParentPtr(CSceneObject* parent)
 {
     _parentObject=parent;
+    _invalidateCumulativeTransformations();
 }
 
 void CSceneObject::_setModelInvisible(bool inv)
@@ -690,6 +897,8 @@ void CSceneObject::getSizeValues(double s[3]) const
 
 void CSceneObject::setScriptExecPriority(int p)
 {
+    if (_scriptExecPriority!=p)
+        CEmbeddedScriptContainer::invalidateScriptsToExecute();
     _scriptExecPriority=p;
 }
 
@@ -755,6 +964,8 @@ void CSceneObject::setModelBase(bool m)
     if (diff)
     {
         _modelBase=m;
+        if (_isInScene)
+            _CSceneObjectContainer_::invalidateObjectPaths();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="modelBase";
@@ -1286,7 +1497,7 @@ void CSceneObject::removeSceneDependencies()
     _customReferencedOriginalHandles.clear();
 }
 
-void CSceneObject::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CSceneObject::addSpecializedObjectEventData(CEventData* data) const
 {
 }
 
@@ -1312,7 +1523,7 @@ void CSceneObject::pushObjectRefreshEvent() const
     }
 }
 
-void CSceneObject::_addCommonObjectEventData(CInterfaceStackTable* data) const
+void CSceneObject::_addCommonObjectEventData(CEventData* data) const
 {
     data->appendMapObject_stringInt32("layer",_visibilityLayer);
     data->appendMapObject_stringInt32("childOrder",_childOrder);
@@ -1328,18 +1539,18 @@ void CSceneObject::_addCommonObjectEventData(CInterfaceStackTable* data) const
     if (_parentObject!=nullptr)
         pUid=_parentObject->getObjectUid();
     data->appendMapObject_stringInt64("parentUid",pUid);
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("boundingBox",subC);
-    subC->appendMapObject_stringDoubleArray("min",_boundingBoxMin.data,3);
-    subC->appendMapObject_stringDoubleArray("max",_boundingBoxMax.data,3);
+    data->openMapObject_stringMap("boundingBox");
+    data->appendMapObject_stringDoubleArray("min",_boundingBoxMin.data,3);
+    data->appendMapObject_stringDoubleArray("max",_boundingBoxMax.data,3);
+    data->closeObject();
     _appendObjectMovementEventData(data);
-    subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("customData",subC);
-    _customObjectData.appendEventData(subC);
-    _customObjectData_tempData.appendEventData(subC);
+    data->openMapObject_stringMap("customData");
+    _customObjectData.appendEventData(data);
+    _customObjectData_tempData.appendEventData(data);
+    data->closeObject();
 }
 
-void CSceneObject::_appendObjectMovementEventData(CInterfaceStackTable* data) const
+void CSceneObject::_appendObjectMovementEventData(CEventData* data) const
 {
     data->appendMapObject_stringInt32("movementOptions",_objectMovementOptions);
     data->appendMapObject_stringInt32("movementPreferredAxes",_objectMovementPreferredAxes);
@@ -1465,10 +1676,10 @@ void CSceneObject::writeCustomDataBlock(bool tmpData,const char* dataName,const
     {
         const char* cmd="customData";
         auto [event,dat]=App::worldContainer->prepareSceneObjectChangedEvent(this,true,cmd,false);
-        CInterfaceStackTable* subC=new CInterfaceStackTable();
-        dat->appendMapObject_stringObject(cmd,subC);
-        _customObjectData.appendEventData(subC);
-        _customObjectData_tempData.appendEventData(subC);
+        dat->openMapObject_stringMap(cmd);
+        _customObjectData.appendEventData(dat);
+        _customObjectData_tempData.appendEventData(dat);
+        dat->closeObject();
         App::worldContainer->pushEvent(event);
     }
 }
@@ -1743,14 +1954,15 @@ void CSceneObject::_setBoundingBox(const C3Vector& vmin,const C3Vector& vmax)
     {
         _boundingBoxMin=vmin;
         _boundingBoxMax=vmax;
+        invalidateSpatialData();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="boundingBox";
             auto [event,data]=App::worldContainer->prepareSceneObjectChangedEvent(this,true,cmd,true);
-            CInterfaceStackTable* subC=new CInterfaceStackTable();
-            data->appendMapObject_stringObject(cmd,subC);
-            subC->appendMapObject_stringDoubleArray("min",_boundingBoxMin.data,3);
-            subC->appendMapObject_stringDoubleArray("max",_boundingBoxMax.data,3);
+            data->openMapObject_stringMap(cmd);
+            data->appendMapObject_stringDoubleArray("min",_boundingBoxMin.data,3);
+            data->appendMapObject_stringDoubleArray("max",_boundingBoxMax.data,3);
+            data->closeObject();
             App::worldContainer->pushEvent(event);
         }
     }
@@ -2094,6 +2306,9 @@ bool CSceneObject::setParent(CSceneObject* parent)
     if (diff)
     {
         _parentObject=parent;
+        _invalidateCumulativeTransformations();
+        if (_isInScene)
+            _CSceneObjectContainer_::invalidateObjectPaths();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="parentUid";
@@ -3751,6 +3966,7 @@ void CSceneObject::acquireCommonPropertiesFromObject_simpleXMLLoading(const CSce
     _objectTempName_old=obj->_objectTempName_old;
 //    _objectAltName=obj->_objectAltName;
     _localTransformation=obj->_localTransformation;
+    _invalidateCumulativeTransformations();
     _hierarchyColorIndex=obj->_hierarchyColorIndex;
     _collectionSelfCollisionIndicator=obj->_collectionSelfCollisionIndicator;
     _objectProperty=obj->_objectProperty;
@@ -4631,6 +4847,8 @@ void CSceneObject::setObjectAlias_direct(const char* newName)
     if (diff)
     {
         _objectAlias=newName;
+        if (_isInScene)
+            _CSceneObjectContainer_::invalidateObjectPaths();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="alias";
@@ -4657,6 +4875,7 @@ void CSceneObject::setLocalTransformation(const C7Vector& tr)
     if (diff)
     {
         _localTransformation=tr;
+        _invalidateCumulativeTransformations();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="pose";
@@ -4676,6 +4895,7 @@ void CSceneObject::setLocalTransformation(const C4Vector& q)
     if (diff)
     {
         _localTransformation.Q=q;
+        _invalidateCumulativeTransformations();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="pose";
@@ -4699,6 +4919,7 @@ void CSceneObject::setLocalTransformation(const C3Vector& x)
     if (diff)
     {
         _localTransformation.X=x;
+        _invalidateCumulativeTransformations();
         if ( _isInScene&&App::worldContainer->getEventsEnabled() )
         {
             const char* cmd="pose";
@@ -4737,10 +4958,16 @@ const std::vector<CSceneObject*>* CSceneObject::getChildren() const
 void CSceneObject::addChild(CSceneObject* child)
 {
     if (child==nullptr)
+    {
         _childList.clear();
+        CEmbeddedScriptContainer::invalidateScriptsToExecute();
+        if (_isInScene)
+            _CSceneObjectContainer_::invalidateObjectPaths();
+    }
     else
     {
         _childList.push_back(child);
+        child->_invalidateCumulativeTransformations();
         handleOrderIndexOfChildren();
     }
 }
@@ -4763,7 +4990,10 @@ bool CSceneObject::removeChild(const CSceneObject* child)
 }
 
 void CSceneObject::handleOrderIndexOfChildren()
-{
+{ // called after each change of the child list
+    CEmbeddedScriptContainer::invalidateScriptsToExecute();
+    if (_isInScene)
+        _CSceneObjectContainer_::invalidateObjectPaths();
     std::map<std::string,int> nameMap;
     std::vector<int> co(_childList.size());
     for (size_t i=0;i<_childList.size();i++)
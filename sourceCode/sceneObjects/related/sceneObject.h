@@ -6,6 +6,7 @@
 #include <simMath/7Vector.h>
 #include <vMutex.h>
 #include <map>
+#include <atomic>
 #include <userParameters.h>
 #include <customData.h>
 #include <syncObject.h>
@@ -42,7 +43,7 @@ public:
     virtual void removeSynchronizationObject(bool localReferencesToItOnly);
 
     virtual void display(CViewableBase* renderingObject,int displayAttrib);
-    virtual void addSpecializedObjectEventData(CInterfaceStackTable* data) const;
+    virtual void addSpecializedObjectEventData(CEventData* data) const;
     virtual CSceneObject* copyYourself();
     virtual void removeSceneDependencies();
     virtual void scaleObject(double scalingFactor);
@@ -115,6 +116,13 @@ public:
     C7Vector getFullParentCumulativeTransformation() const;
     C7Vector getCumulativeTransformation() const;
     C7Vector getFullCumulativeTransformation() const;
+    bool isFullCumulativeTransformationCached() const;
+    void setFullCumulativeTransformationCache(const C7Vector& tr) const; // from batch updates, in hierarchy order
+    static unsigned long long int getTransformationGeneration(); // changes when a pose changes
+    static void benchmarkTransformationCache(int depth,int operations,double writeRatio,double& cachedMs,double& uncachedMs,double& maxError); // simulation thread only
+    static bool takeSpatialChanges(unsigned long long int& take,std::vector<long long int>& uids); // false if some changes may be missing
+    static void trackSpatialChanges(bool track);
+    void invalidateSpatialData(); // when the bounding box changes
 
     void setObjectHandle(int newObjectHandle);
     void setChildOrder(int order);
@@ -304,8 +312,11 @@ public:
 protected:
     void _setModelInvisible(bool inv);
     void _setBoundingBox(const C3Vector& vmin,const C3Vector& vmax);
-    void _addCommonObjectEventData(CInterfaceStackTable* data) const;
-    void _appendObjectMovementEventData(CInterfaceStackTable* data) const;
+    void _addCommonObjectEventData(CEventData* data) const;
+    void _appendObjectMovementEventData(CEventData* data) const;
+    void _invalidateCumulativeTransformations(); // of this object and its subtree
+    void _invalidateSubtreeTransformations(bool trackSpatialChanges);
+    void _markSpatialChange_locked();
 
     int _objectHandle;
     long long int _objectUid; // valid for a given session (non-persistent)
@@ -317,6 +328,11 @@ protected:
     int _childOrder;
     std::string _objectAlias;
     C7Vector _localTransformation;
+    mutable C7Vector _fullCumulativeTransformation; // cached. Only stored by the simulation thread, for objects in the scene
+    mutable bool _fullCumulativeTransformationValid; // if true, the parent's is also valid
+    static std::atomic<unsigned long long int> _transformationGeneration;
+    unsigned long long int _spatialChangeTake; // take during which the object was added to the spatial changes
+    unsigned long long int _poseChangeTake; // take during which the object was added to the spatial changes because of a pose change
 
     std::vector<CSceneObject*> _childList;
     C7Vector _assemblingLocalTransformation; // When assembling this object
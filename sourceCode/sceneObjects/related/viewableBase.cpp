@@ -554,10 +554,10 @@ void CViewableBase::computeVolumeVectors()
         {
             const char* cmd="frustumVectors";
             auto [event,data]=App::worldContainer->prepareSceneObjectChangedEvent(this,false,cmd,true);
-            CInterfaceStackTable* fr=new CInterfaceStackTable();
-            data->appendMapObject_stringObject(cmd,fr);
-            fr->appendMapObject_stringDoubleArray("near",_volumeVectorNear.data,3);
-            fr->appendMapObject_stringDoubleArray("far",_volumeVectorFar.data,3);
+            data->openMapObject_stringMap(cmd);
+            data->appendMapObject_stringDoubleArray("near",_volumeVectorNear.data,3);
+            data->appendMapObject_stringDoubleArray("far",_volumeVectorFar.data,3);
+            data->closeObject();
             App::worldContainer->pushEvent(event);
         }
     }
@@ -211,6 +211,7 @@ void CShape::_computeMeshBoundingBox()
         else
             _meshBoundingBoxHalfSizes.keepMax(C3Vector(&visibleVertices[3*i+0]));
     }
+    invalidateSpatialData();
 }
 
 C7Vector CShape::_acceptNewGeometry(const std::vector<double>& vert,const std::vector<int>& ind,const std::vector<double>* textCoord,const std::vector<double>* norm)
@@ -1797,10 +1798,10 @@ void CShape::setCulling(bool culState)
             {
                 const char* cmd="color";
                 auto [event,data]=App::worldContainer->prepareSceneObjectChangedEvent(this,false,cmd,true);
-                CInterfaceStackTable* sdata=new CInterfaceStackTable();
-                data->appendMapObject_stringObject(cmd,sdata);
-                sdata->appendMapObject_stringBool("culling",culState);
-                sdata->appendMapObject_stringInt32("index",0);
+                data->openMapObject_stringMap(cmd);
+                data->appendMapObject_stringBool("culling",culState);
+                data->appendMapObject_stringInt32("index",0);
+                data->closeObject();
                 App::worldContainer->pushEvent(event);
             }
         }
@@ -1827,10 +1828,10 @@ void CShape::setVisibleEdges(bool v)
             {
                 const char* cmd="color";
                 auto [event,data]=App::worldContainer->prepareSceneObjectChangedEvent(this,false,cmd,false);
-                CInterfaceStackTable* sdata=new CInterfaceStackTable();
-                data->appendMapObject_stringObject(cmd,sdata);
-                sdata->appendMapObject_stringBool("showEdges",v);
-                sdata->appendMapObject_stringInt32("index",0);
+                data->openMapObject_stringMap(cmd);
+                data->appendMapObject_stringBool("showEdges",v);
+                data->appendMapObject_stringInt32("index",0);
+                data->closeObject();
                 App::worldContainer->pushEvent(event);
             }
         }
@@ -1967,14 +1968,11 @@ void CShape::removeSceneDependencies()
     CSceneObject::removeSceneDependencies();
 }
 
-void CShape::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CShape::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("shape",subC);
-    data=subC;
+    data->openMapObject_stringMap("shape");
 
-    CInterfaceStackTable* meshData=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("meshes",meshData);
+    data->openMapObject_stringArray("meshes");
 
     std::vector<CMesh*> all;
     getMeshWrapper()->getAllShapeComponentsCumulative(all);
@@ -1982,8 +1980,7 @@ void CShape::addSpecializedObjectEventData(CInterfaceStackTable* data) const
     {
         CMesh* geom=all[i];
 
-        CInterfaceStackTable* mesh=new CInterfaceStackTable();
-        meshData->appendArrayObject(mesh);
+        data->openArrayObject_map();
 
         C7Vector tr(geom->getVerticeLocalFrame());
         const std::vector<float>* wvert=geom->getVerticesForDisplayAndDisk();
@@ -2004,12 +2001,12 @@ void CShape::addSpecializedObjectEventData(CInterfaceStackTable* data) const
         size_t l;
         obj.appendFloatArray(vertices.data(),vertices.size());
         const char* buff=(const char*)obj.getBuff(l);
-        mesh->appendMapObject_stringString("vertices",buff,l,true);
+        data->appendMapObject_stringString("vertices",buff,l,true);
 
         obj.clear();
         obj.appendIntArray(wind->data(),wind->size());
         buff=(const char*)obj.getBuff(l);
-        mesh->appendMapObject_stringString("indices",buff,l,true);
+        data->appendMapObject_stringString("indices",buff,l,true);
 
         std::vector<float> normals;
         normals.resize(wind->size()*3);
@@ -2025,22 +2022,22 @@ void CShape::addSpecializedObjectEventData(CInterfaceStackTable* data) const
         obj.clear();
         obj.appendFloatArray(normals.data(),normals.size());
         buff=(const char*)obj.getBuff(l);
-        mesh->appendMapObject_stringString("normals",buff,l,true);
+        data->appendMapObject_stringString("normals",buff,l,true);
 
         float c[9];
         geom->color.getColor(c+0,sim_colorcomponent_ambient_diffuse);
         geom->color.getColor(c+3,sim_colorcomponent_specular);
         geom->color.getColor(c+6,sim_colorcomponent_emission);
-        mesh->appendMapObject_stringFloatArray("color",c,9);
+        data->appendMapObject_stringFloatArray("color",c,9);
 
-//        mesh->appendMapObject_stringFloat("edgeAngle",geom->);
-        mesh->appendMapObject_stringFloat("shadingAngle",geom->getShadingAngle());
-        mesh->appendMapObject_stringBool("showEdges",geom->getVisibleEdges());
-        mesh->appendMapObject_stringBool("culling",geom->getCulling());
+//        data->appendMapObject_stringFloat("edgeAngle",geom->);
+        data->appendMapObject_stringFloat("shadingAngle",geom->getShadingAngle());
+        data->appendMapObject_stringBool("showEdges",geom->getVisibleEdges());
+        data->appendMapObject_stringBool("culling",geom->getCulling());
         double transp=0.0;
         if (geom->color.getTranslucid())
             transp=1.0-geom->color.getOpacity();
-        mesh->appendMapObject_stringFloat("transparency",transp);
+        data->appendMapObject_stringFloat("transparency",transp);
 
 
         int options=0;
@@ -2048,7 +2045,7 @@ void CShape::addSpecializedObjectEventData(CInterfaceStackTable* data) const
             options|=1;
         if (geom->getWireframe_OLD())
             options|=2;
-        mesh->appendMapObject_stringInt32("options",options);
+        data->appendMapObject_stringInt32("options",options);
 
         CTextureProperty* tp=geom->getTextureProperty();
         CTextureObject* to=nullptr;
@@ -2065,19 +2062,18 @@ void CShape::addSpecializedObjectEventData(CInterfaceStackTable* data) const
             { // sending raw texture
                 int tRes[2];
                 to->getTextureSize(tRes[0],tRes[1]);
-                CInterfaceStackTable* texture=new CInterfaceStackTable();
-                mesh->appendMapObject_stringObject("texture",texture);
+                data->openMapObject_stringMap("texture");
 
-                texture->appendMapObject_stringString("rawTexture",(char*)to->getTextureBufferPointer(),tRes[1]*tRes[0]*4);
+                data->appendMapObject_stringString("rawTexture",(char*)to->getTextureBufferPointer(),tRes[1]*tRes[0]*4);
 
-                texture->appendMapObject_stringInt32Array("resolution",tRes,2);
+                data->appendMapObject_stringInt32Array("resolution",tRes,2);
 
                 obj.clear();
                 obj.appendFloatArray(tc->data(),tc->size());
                 buff=(const char*)obj.getBuff(l);
-                texture->appendMapObject_stringString("coordinates",buff,l,true);
+                data->appendMapObject_stringString("coordinates",buff,l,true);
 
-                texture->appendMapObject_stringInt32("applyMode",tp->getApplyMode());
+                data->appendMapObject_stringInt32("applyMode",tp->getApplyMode());
 
                 int options=0;
                 if (tp->getRepeatU())
@@ -2086,9 +2082,10 @@ void CShape::addSpecializedObjectEventData(CInterfaceStackTable* data) const
                     options|=2;
                 if (tp->getInterpolateColors())
                     options|=4;
-                texture->appendMapObject_stringInt32("options",options);
+                data->appendMapObject_stringInt32("options",options);
 
-                texture->appendMapObject_stringInt32("id",tp->getTextureObjectID());
+                data->appendMapObject_stringInt32("id",tp->getTextureObjectID());
+                data->closeObject();
             }
             else
             { // sending PNG texture
@@ -2098,20 +2095,19 @@ void CShape::addSpecializedObjectEventData(CInterfaceStackTable* data) const
                 bool res=CImageLoaderSaver::save((unsigned char*)to->getTextureBufferPointer(),tRes,1,".png",-1,&buffer);
                 if (res)
                 {
-                    CInterfaceStackTable* texture=new CInterfaceStackTable();
-                    mesh->appendMapObject_stringObject("texture",texture);
+                    data->openMapObject_stringMap("texture");
 
                     buffer=CTTUtil::encode64(buffer);
-                    texture->appendMapObject_stringString("texture",buffer.c_str(),buffer.size());
+                    data->appendMapObject_stringString("texture",buffer.c_str(),buffer.size());
 
-                    texture->appendMapObject_stringInt32Array("resolution",tRes,2);
+                    data->appendMapObject_stringInt32Array("resolution",tRes,2);
 
                     obj.clear();
                     obj.appendFloatArray(tc->data(),tc->size());
                     buff=(const char*)obj.getBuff(l);
-                    texture->appendMapObject_stringString("coordinates",buff,l,true);
+                    data->appendMapObject_stringString("coordinates",buff,l,true);
 
-                    texture->appendMapObject_stringInt32("applyMode",tp->getApplyMode());
+                    data->appendMapObject_stringInt32("applyMode",tp->getApplyMode());
 
                     int options=0;
                     if (tp->getRepeatU())
@@ -2120,13 +2116,18 @@ void CShape::addSpecializedObjectEventData(CInterfaceStackTable* data) const
                         options|=2;
                     if (tp->getInterpolateColors())
                         options|=4;
-                    texture->appendMapObject_stringInt32("options",options);
+                    data->appendMapObject_stringInt32("options",options);
 
-                    texture->appendMapObject_stringInt32("id",tp->getTextureObjectID());
+                    data->appendMapObject_stringInt32("id",tp->getTextureObjectID());
+                    data->closeObject();
                 }
             }
         }
+        data->closeObject();
     }
+    data->closeObject();
+
+    data->closeObject();
 }
 
 CSceneObject* CShape::copyYourself()
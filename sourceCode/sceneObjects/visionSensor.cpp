@@ -1935,11 +1935,9 @@ void CVisionSensor::removeSceneDependencies()
     _detectableEntityHandle=-1;
 }
 
-void CVisionSensor::addSpecializedObjectEventData(CInterfaceStackTable* data) const
+void CVisionSensor::addSpecializedObjectEventData(CEventData* data) const
 {
-    CInterfaceStackTable* subC=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("visionSensor",subC);
-    data=subC;
+    data->openMapObject_stringMap("visionSensor");
 
     data->appendMapObject_stringBool("perspectiveMode",_perspective);
     data->appendMapObject_stringFloat("nearClippingPlane",_nearClippingPlane);
@@ -1949,12 +1947,14 @@ void CVisionSensor::addSpecializedObjectEventData(CInterfaceStackTable* data) co
     data->appendMapObject_stringFloat("size",_visionSensorSize);
     data->appendMapObject_stringBool("showFrustum",_showVolume);
 
-    CInterfaceStackTable* fr=new CInterfaceStackTable();
-    data->appendMapObject_stringObject("frustumVectors",fr);
-    fr->appendMapObject_stringDoubleArray("near",_volumeVectorNear.data,3);
-    fr->appendMapObject_stringDoubleArray("far",_volumeVectorFar.data,3);
+    data->openMapObject_stringMap("frustumVectors");
+    data->appendMapObject_stringDoubleArray("near",_volumeVectorNear.data,3);
+    data->appendMapObject_stringDoubleArray("far",_volumeVectorFar.data,3);
+    data->closeObject();
 
     // todo
+
+    data->closeObject();
 }
 
 CSceneObject* CVisionSensor::copyYourself()
@@ -0,0 +1,385 @@
+#include <luaBuffer.h>
+#include <string.h>
+#include <new>
+
+void CLuaBuffer::registerMetatable(luaWrap_lua_State* L)
+{
+    if (luaWrap_luaL_newmetatable(L,LUABUFFER_METATABLE)!=0)
+    {
+        luaWrap_lua_pushcfunction(L,_gc);
+        luaWrap_lua_setfield(L,-2,"__gc");
+        luaWrap_lua_pushcfunction(L,_newindex);
+        luaWrap_lua_setfield(L,-2,"__newindex");
+        luaWrap_lua_pushcfunction(L,_len);
+        luaWrap_lua_setfield(L,-2,"__len");
+        luaWrap_lua_pushcfunction(L,_tostring);
+        luaWrap_lua_setfield(L,-2,"__tostring");
+        // getmetatable returns that instead of the metatable, and setmetatable fails:
+        luaWrap_lua_pushstring(L,LUABUFFER_METATABLE);
+        luaWrap_lua_setfield(L,-2,"__metatable");
+        // methods, looked up by __index:
+        luaWrap_lua_newtable(L);
+        luaWrap_lua_pushcfunction(L,_slice);
+        luaWrap_lua_setfield(L,-2,"slice");
+        luaWrap_lua_pushcfunction(L,_view);
+        luaWrap_lua_setfield(L,-2,"view");
+        luaWrap_lua_pushcfunction(L,_type);
+        luaWrap_lua_setfield(L,-2,"type");
+        luaWrap_lua_pushcfunction(L,_byteSize);
+        luaWrap_lua_setfield(L,-2,"byteSize");
+        luaWrap_lua_pushcfunction(L,_toString);
+        luaWrap_lua_setfield(L,-2,"toString");
+        luaWrap_lua_pushcfunction(L,_toTable);
+        luaWrap_lua_setfield(L,-2,"toTable");
+        luaWrap_lua_pushcclosure(L,_index,1);
+        luaWrap_lua_setfield(L,-2,"__index");
+    }
+    luaWrap_lua_pop(L,1);
+}
+
+void CLuaBuffer::_pushBuffer(luaWrap_lua_State* L,unsigned char* data,SLuaBufferDeleter deleter,size_t size,int type)
+{
+    SLuaBufferData* buffer=new SLuaBufferData();
+    buffer->data=data;
+    buffer->deleter=deleter;
+    buffer->size=size;
+    buffer->refCnt=0;
+    _pushView(L,buffer,0,size-size%getElementSize(type),type);
+}
+
+void CLuaBuffer::pushBufferCopy(luaWrap_lua_State* L,const void* data,size_t size,int type)
+{
+    unsigned char* d=new unsigned char[size];
+    if (size>0)
+        memcpy(d,data,size);
+    pushBuffer(L,d,size,type);
+}
+
+bool CLuaBuffer::isBuffer(luaWrap_lua_State* L,int idx)
+{
+    return(_getView(L,idx)!=nullptr);
+}
+
+const char* CLuaBuffer::getData(luaWrap_lua_State* L,int idx,size_t* size)
+{
+    SLuaBuffer* view=_getView(L,idx);
+    if (view!=nullptr)
+    {
+        size[0]=view->size;
+        return((const char*)view->buffer->data+view->offset);
+    }
+    if (luaWrap_lua_isstring(L,idx))
+        return(luaWrap_lua_tolstring(L,idx,size));
+    return(nullptr);
+}
+
+int CLuaBuffer::typeFromString(const char* type)
+{
+    int retVal=-1;
+    if (strcmp(type,"uint8")==0)
+        retVal=LUABUFFER_TYPE_UINT8;
+    if (strcmp(type,"int32")==0)
+        retVal=LUABUFFER_TYPE_INT32;
+    if (strcmp(type,"float")==0)
+        retVal=LUABUFFER_TYPE_FLOAT;
+    if (strcmp(type,"double")==0)
+        retVal=LUABUFFER_TYPE_DOUBLE;
+    return(retVal);
+}
+
+const char* CLuaBuffer::typeToString(int type)
+{
+    if (type==LUABUFFER_TYPE_INT32)
+        return("int32");
+    if (type==LUABUFFER_TYPE_FLOAT)
+        return("float");
+    if (type==LUABUFFER_TYPE_DOUBLE)
+        return("double");
+    return("uint8");
+}
+
+size_t CLuaBuffer::getElementSize(int type)
+{
+    if ( (type==LUABUFFER_TYPE_INT32)||(type==LUABUFFER_TYPE_FLOAT) )
+        return(4);
+    if (type==LUABUFFER_TYPE_DOUBLE)
+        return(8);
+    return(1);
+}
+
+int CLuaBuffer::createBuffer(luaWrap_lua_State* L)
+{ // sim.createBuffer(elementCount,type='uint8') creates a zeroed buffer, sim.createBuffer(string,type='uint8') copies the string
+    int type=LUABUFFER_TYPE_UINT8;
+    if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isstring(L,2)&&(!luaWrap_lua_isnumber(L,2)) )
+        type=typeFromString(luaWrap_lua_tostring(L,2));
+    if (type<0)
+        return(_raiseError(L,"sim.createBuffer: invalid type (expected 'uint8', 'int32', 'float' or 'double')."));
+    bool ok=true;
+    try
+    { // no Lua error (i.e. long jump) in here
+        if ( (luaWrap_lua_gettop(L)>=1)&&luaWrap_lua_isnumber(L,1) )
+        {
+            long long int cnt=luaWrap_lua_tointeger(L,1);
+            if ( (cnt<0)||((unsigned long long int)cnt>size_t(-1)/getElementSize(type)) )
+                return(_raiseError(L,"sim.createBuffer: invalid size."));
+            size_t size=size_t(cnt)*getElementSize(type);
+            unsigned char* d=new unsigned char[size];
+            memset(d,0,size);
+            pushBuffer(L,d,size,type);
+            return(1);
+        }
+        size_t size;
+        const char* data=getData(L,1,&size);
+        if (data!=nullptr)
+        {
+            pushBufferCopy(L,data,size,type);
+            return(1);
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        ok=false;
+    }
+    if (!ok)
+        return(_raiseError(L,"sim.createBuffer: not enough memory."));
+    return(_raiseError(L,"sim.createBuffer: expected a size, a string or a buffer."));
+}
+
+SLuaBuffer* CLuaBuffer::_pushView(luaWrap_lua_State* L,SLuaBufferData* buffer,size_t offset,size_t size,int type)
+{
+    SLuaBuffer* view=(SLuaBuffer*)luaWrap_lua_newuserdata(L,sizeof(SLuaBuffer));
+    view->buffer=buffer;
+    view->offset=offset;
+    view->size=size;
+    view->type=type;
+    buffer->refCnt++;
+    luaWrap_luaL_setmetatable(L,LUABUFFER_METATABLE);
+    return(view);
+}
+
+SLuaBuffer* CLuaBuffer::_getView(luaWrap_lua_State* L,int idx)
+{
+    return((SLuaBuffer*)luaWrap_luaL_testudata(L,idx,LUABUFFER_METATABLE));
+}
+
+SLuaBuffer* CLuaBuffer::_checkView(luaWrap_lua_State* L)
+{ // metamethods can still be reached with debug.getmetatable, and called with other values
+    SLuaBuffer* view=_getView(L,1);
+    if (view==nullptr)
+        _raiseError(L,"buffer: expected a buffer.");
+    return(view);
+}
+
+int CLuaBuffer::_raiseError(luaWrap_lua_State* L,const char* msg)
+{
+    luaWrap_lua_pushstring(L,msg);
+    luaWrap_lua_error(L);
+    return(0);
+}
+
+int CLuaBuffer::_gc(luaWrap_lua_State* L)
+{
+    SLuaBuffer* view=_getView(L,1);
+    if ( (view!=nullptr)&&(view->buffer!=nullptr) )
+    {
+        view->buffer->refCnt--;
+        if (view->buffer->refCnt==0)
+        {
+            view->buffer->deleter(view->buffer->data);
+            delete view->buffer;
+        }
+        view->buffer=nullptr;
+    }
+    return(0);
+}
+
+int CLuaBuffer::_index(luaWrap_lua_State* L)
+{ // buf[i] (1-based), or a method
+    SLuaBuffer* view=_checkView(L);
+    if (luaWrap_lua_isinteger(L,2))
+    {
+        long long int i=luaWrap_lua_tointeger(L,2)-1;
+        size_t es=getElementSize(view->type);
+        if ( (i<0)||(size_t(i)>=view->size/es) )
+        {
+            luaWrap_lua_pushnil(L);
+            return(1);
+        }
+        const unsigned char* p=view->buffer->data+view->offset+size_t(i)*es;
+        if (view->type==LUABUFFER_TYPE_UINT8)
+            luaWrap_lua_pushinteger(L,p[0]);
+        else if (view->type==LUABUFFER_TYPE_INT32)
+        {
+            int v;
+            memcpy(&v,p,4);
+            luaWrap_lua_pushinteger(L,v);
+        }
+        else if (view->type==LUABUFFER_TYPE_FLOAT)
+        {
+            float v;
+            memcpy(&v,p,4);
+            luaWrap_lua_pushnumber(L,v);
+        }
+        else
+        {
+            double v;
+            memcpy(&v,p,8);
+            luaWrap_lua_pushnumber(L,v);
+        }
+        return(1);
+    }
+    if (luaWrap_lua_isstring(L,2))
+    {
+        luaWrap_lua_getfield(L,luaWrap_lua_upvalueindex(1),luaWrap_lua_tostring(L,2));
+        return(1);
+    }
+    luaWrap_lua_pushnil(L);
+    return(1);
+}
+
+int CLuaBuffer::_newindex(luaWrap_lua_State* L)
+{ // buf[i]=v (1-based)
+    SLuaBuffer* view=_checkView(L);
+    if ( (!luaWrap_lua_isinteger(L,2))||(!luaWrap_lua_isnumber(L,3)) )
+        return(_raiseError(L,"buffer: expected an integer index and a number."));
+    long long int i=luaWrap_lua_tointeger(L,2)-1;
+    size_t es=getElementSize(view->type);
+    if ( (i<0)||(size_t(i)>=view->size/es) )
+        return(_raiseError(L,"buffer: index out of range."));
+    unsigned char* p=view->buffer->data+view->offset+size_t(i)*es;
+    if (view->type==LUABUFFER_TYPE_UINT8)
+        p[0]=(unsigned char)luaWrap_lua_tointeger(L,3);
+    else if (view->type==LUABUFFER_TYPE_INT32)
+    {
+        int v=(int)luaWrap_lua_tointeger(L,3);
+        memcpy(p,&v,4);
+    }
+    else if (view->type==LUABUFFER_TYPE_FLOAT)
+    {
+        float v=(float)luaWrap_lua_tonumber(L,3);
+        memcpy(p,&v,4);
+    }
+    else
+    {
+        double v=luaWrap_lua_tonumber(L,3);
+        memcpy(p,&v,8);
+    }
+    return(0);
+}
+
+int CLuaBuffer::_len(luaWrap_lua_State* L)
+{ // element count
+    SLuaBuffer* view=_checkView(L);
+    luaWrap_lua_pushinteger(L,(long long int)(view->size/getElementSize(view->type)));
+    return(1);
+}
+
+int CLuaBuffer::_tostring(luaWrap_lua_State* L)
+{
+    SLuaBuffer* view=_checkView(L);
+    std::string str("buffer<");
+    str+=typeToString(view->type);
+    str+=">["+std::to_string(view->size/getElementSize(view->type))+"]";
+    luaWrap_lua_pushstring(L,str.c_str());
+    return(1);
+}
+
+int CLuaBuffer::_slice(luaWrap_lua_State* L)
+{ // buf:slice(fromIndex,toIndex=#buf), 1-based and inclusive. Shares the memory
+    SLuaBuffer* view=_getView(L,1);
+    if (view==nullptr)
+        return(_raiseError(L,"buffer:slice: expected a buffer."));
+    long long int cnt=(long long int)(view->size/getElementSize(view->type));
+    long long int from=1;
+    long long int to=cnt;
+    if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isinteger(L,2) )
+        from=luaWrap_lua_tointeger(L,2);
+    if ( (luaWrap_lua_gettop(L)>=3)&&luaWrap_lua_isinteger(L,3) )
+        to=luaWrap_lua_tointeger(L,3);
+    if (from<1)
+        from=1;
+    if (to>cnt)
+        to=cnt;
+    if (to<from)
+        to=from-1; // empty slice
+    size_t es=getElementSize(view->type);
+    _pushView(L,view->buffer,view->offset+size_t(from-1)*es,size_t(to-from+1)*es,view->type);
+    return(1);
+}
+
+int CLuaBuffer::_view(luaWrap_lua_State* L)
+{ // buf:view(type) reinterprets the same memory, e.g. buf:view('float')
+    SLuaBuffer* view=_getView(L,1);
+    if (view==nullptr)
+        return(_raiseError(L,"buffer:view: expected a buffer."));
+    int type=-1;
+    if ( (luaWrap_lua_gettop(L)>=2)&&luaWrap_lua_isstring(L,2) )
+        type=typeFromString(luaWrap_lua_tostring(L,2));
+    if (type<0)
+        return(_raiseError(L,"buffer:view: invalid type (expected 'uint8', 'int32', 'float' or 'double')."));
+    _pushView(L,view->buffer,view->offset,view->size-view->size%getElementSize(type),type);
+    return(1);
+}
+
+int CLuaBuffer::_type(luaWrap_lua_State* L)
+{
+    SLuaBuffer* view=_getView(L,1);
+    if (view==nullptr)
+        return(_raiseError(L,"buffer:type: expected a buffer."));
+    luaWrap_lua_pushstring(L,typeToString(view->type));
+    return(1);
+}
+
+int CLuaBuffer::_byteSize(luaWrap_lua_State* L)
+{
+    SLuaBuffer* view=_getView(L,1);
+    if (view==nullptr)
+        return(_raiseError(L,"buffer:byteSize: expected a buffer."));
+    luaWrap_lua_pushinteger(L,(long long int)view->size);
+    return(1);
+}
+
+int CLuaBuffer::_toString(luaWrap_lua_State* L)
+{ // copies the bytes into a Lua string, e.g. for sim.packTable or file output
+    SLuaBuffer* view=_getView(L,1);
+    if (view==nullptr)
+        return(_raiseError(L,"buffer:toString: expected a buffer."));
+    luaWrap_lua_pushlstring(L,(const char*)view->buffer->data+view->offset,view->size);
+    return(1);
+}
+
+int CLuaBuffer::_toTable(luaWrap_lua_State* L)
+{ // copies the elements into a Lua table
+    SLuaBuffer* view=_getView(L,1);
+    if (view==nullptr)
+        return(_raiseError(L,"buffer:toTable: expected a buffer."));
+    size_t es=getElementSize(view->type);
+    int cnt=int(view->size/es);
+    const unsigned char* p=view->buffer->data+view->offset;
+    luaWrap_lua_createtable(L,cnt,0);
+    for (int i=0;i<cnt;i++)
+    {
+        if (view->type==LUABUFFER_TYPE_UINT8)
+            luaWrap_lua_pushinteger(L,p[i]);
+        else if (view->type==LUABUFFER_TYPE_INT32)
+        {
+            int v;
+            memcpy(&v,p+4*i,4);
+            luaWrap_lua_pushinteger(L,v);
+        }
+        else if (view->type==LUABUFFER_TYPE_FLOAT)
+        {
+            float v;
+            memcpy(&v,p+4*i,4);
+            luaWrap_lua_pushnumber(L,v);
+        }
+        else
+        {
+            double v;
+            memcpy(&v,p+8*i,8);
+            luaWrap_lua_pushnumber(L,v);
+        }
+        luaWrap_lua_rawseti(L,-2,i+1);
+    }
+    return(1);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <luaWrapper.h>
+#include <string>
+
+#define LUABUFFER_METATABLE "simBuffer"
+
+#define LUABUFFER_TYPE_UINT8 0
+#define LUABUFFER_TYPE_INT32 1
+#define LUABUFFER_TYPE_FLOAT 2
+#define LUABUFFER_TYPE_DOUBLE 3
+
+typedef void (*SLuaBufferDeleter)(unsigned char* data);
+
+struct SLuaBufferData
+{ // native memory shared by all views (slices, reinterpretations) of a buffer
+    unsigned char* data;
+    SLuaBufferDeleter deleter; // delete[] with the type data was allocated with
+    size_t size;
+    int refCnt;
+};
+
+struct SLuaBuffer
+{ // the Lua userdata: a typed view onto SLuaBufferData
+    SLuaBufferData* buffer;
+    size_t offset; // in bytes
+    size_t size; // in bytes
+    int type;
+};
+
+class CLuaBuffer
+{ // Buffer userdata for large payloads (images, point clouds, meshes), e.g. buf[1], #buf, buf:slice(i,j), buf:view('float'), buf:toString()
+public:
+    static void registerMetatable(luaWrap_lua_State* L);
+    template<class T>
+    static void pushBuffer(luaWrap_lua_State* L,T* data,size_t size,int type) // takes ownership of data (new T[]). size is in bytes
+    {
+        _pushBuffer(L,(unsigned char*)data,_deleteArray<T>,size,type);
+    }
+    static void pushBufferCopy(luaWrap_lua_State* L,const void* data,size_t size,int type);
+    static bool isBuffer(luaWrap_lua_State* L,int idx);
+    static const char* getData(luaWrap_lua_State* L,int idx,size_t* size); // buffer or string. nullptr otherwise
+
+    static int typeFromString(const char* type); // -1 if invalid
+    static const char* typeToString(int type);
+    static size_t getElementSize(int type);
+
+    static int createBuffer(luaWrap_lua_State* L); // sim.createBuffer(sizeInBytesOrString,type='uint8')
+
+private:
+    template<class T>
+    static void _deleteArray(unsigned char* data)
+    {
+        delete[] (T*)data;
+    }
+    static void _pushBuffer(luaWrap_lua_State* L,unsigned char* data,SLuaBufferDeleter deleter,size_t size,int type);
+    static SLuaBuffer* _pushView(luaWrap_lua_State* L,SLuaBufferData* buffer,size_t offset,size_t size,int type);
+    static SLuaBuffer* _getView(luaWrap_lua_State* L,int idx);
+    static SLuaBuffer* _checkView(luaWrap_lua_State* L); // raises an error if argument 1 is not a buffer
+    static int _raiseError(luaWrap_lua_State* L,const char* msg);
+
+    static int _gc(luaWrap_lua_State* L);
+    static int _index(luaWrap_lua_State* L);
+    static int _newindex(luaWrap_lua_State* L);
+    static int _len(luaWrap_lua_State* L);
+    static int _tostring(luaWrap_lua_State* L);
+    static int _slice(luaWrap_lua_State* L);
+    static int _view(luaWrap_lua_State* L);
+    static int _type(luaWrap_lua_State* L);
+    static int _byteSize(luaWrap_lua_State* L);
+    static int _toString(luaWrap_lua_State* L);
+    static int _toTable(luaWrap_lua_State* L);
+};
@@ -0,0 +1,349 @@
+#include <luaBytecodeCache.h>
+#include <sha256.h>
+#include <vMutex.h>
+#include <vFile.h>
+#include <app.h>
+#include <folderSystem.h>
+#include <stdio.h>
+#include <random>
+
+#define LUABYTECODECACHE_MAX_MEMORY_SIZE (64*1024*1024) // least recently used chunks are evicted above that
+#define LUABYTECODECACHE_MAC_SIZE 64 // files on disk start with the HMAC-SHA256 (hex) of key and bytecode that follows
+#define LUABYTECODECACHE_SECRET_SIZE 32
+#define LUABYTECODECACHE_SECRET_FILE "luaBytecodeCache.key" // in the user settings folder, i.e. never in the cache folder
+
+std::unordered_map<std::string,SLuaBytecodeCacheEntry> CLuaBytecodeCache::_chunks;
+std::list<std::string> CLuaBytecodeCache::_lru;
+size_t CLuaBytecodeCache::_memorySize=0;
+size_t CLuaBytecodeCache::_hits=0;
+size_t CLuaBytecodeCache::_misses=0;
+std::string CLuaBytecodeCache::_secret;
+static VMutex _luaBytecodeCacheMutex;
+
+int CLuaBytecodeCache::loadBuffer(luaWrap_lua_State* L,const char* buff,size_t sz,const char* name)
+{
+    std::string key(_getKey(buff,sz,name));
+    std::string bytecode;
+    bool found=false;
+    _luaBytecodeCacheMutex.lock("CLuaBytecodeCache::loadBuffer");
+    auto it=_chunks.find(key);
+    if (it!=_chunks.end())
+    {
+        bytecode=it->second.bytecode;
+        _lru.splice(_lru.begin(),_lru,it->second.lruPos);
+        found=true;
+    }
+    _luaBytecodeCacheMutex.unlock();
+    bool fromDisk=false;
+    if (!found)
+        fromDisk=found=_readFromDisk(key,bytecode);
+    if (found)
+    {
+        if (luaWrap_luaL_loadbuffer(L,bytecode.c_str(),bytecode.size(),name)==0)
+        {
+            _luaBytecodeCacheMutex.lock("CLuaBytecodeCache::loadBuffer");
+            _hits++;
+            if (fromDisk)
+                _insert(key,bytecode);
+            _luaBytecodeCacheMutex.unlock();
+            return(0);
+        }
+        luaWrap_lua_pop(L,1); // error message. The cached chunk is not valid (e.g. truncated file): we compile the source instead
+    }
+
+    int retVal=luaWrap_luaL_loadbuffer(L,buff,sz,name);
+    if (retVal==0)
+    {
+        if (luaWrap_lua_dump(L,bytecode)==0)
+        {
+            _luaBytecodeCacheMutex.lock("CLuaBytecodeCache::loadBuffer");
+            _misses++;
+            _insert(key,bytecode);
+            _luaBytecodeCacheMutex.unlock();
+            _writeToDisk(key,bytecode);
+        }
+    }
+    return(retVal);
+}
+
+void CLuaBytecodeCache::clear()
+{
+    _luaBytecodeCacheMutex.lock("CLuaBytecodeCache::clear");
+    _chunks.clear();
+    _lru.clear();
+    _memorySize=0;
+    _hits=0;
+    _misses=0;
+    _luaBytecodeCacheMutex.unlock();
+}
+
+void CLuaBytecodeCache::getStats(size_t& hits,size_t& misses,size_t& memorySize)
+{
+    _luaBytecodeCacheMutex.lock("CLuaBytecodeCache::getStats");
+    hits=_hits;
+    misses=_misses;
+    memorySize=_memorySize;
+    _luaBytecodeCacheMutex.unlock();
+}
+
+void CLuaBytecodeCache::installModuleSearcher(luaWrap_lua_State* L)
+{ // goes before the standard Lua file searcher (package.searchers[2]), which it shadows for files it finds
+    luaWrap_lua_getglobal(L,"package");
+    luaWrap_lua_getfield(L,-1,"searchers");
+    if (luaWrap_lua_istable(L,-1))
+    {
+        for (int i=int(luaWrap_lua_rawlen(L,-1));i>=2;i--)
+        {
+            luaWrap_lua_rawgeti(L,-1,i);
+            luaWrap_lua_rawseti(L,-2,i+1);
+        }
+        luaWrap_lua_pushcfunction(L,_moduleSearcher);
+        luaWrap_lua_rawseti(L,-2,2);
+    }
+    luaWrap_lua_pop(L,2);
+}
+
+int CLuaBytecodeCache::_moduleSearcher(luaWrap_lua_State* L)
+{ // same as Lua's searcher_Lua: looks up package.path, and returns the loaded chunk and the file name, or why nothing was found
+    if (!luaWrap_lua_isstring(L,1))
+        return(0);
+    luaWrap_lua_settop(L,1);
+    bool ok=false;
+    { // in a block: the strings are released before luaWrap_lua_error, which does a long jump
+        std::string name(luaWrap_lua_tostring(L,1));
+        std::string filename;
+        luaWrap_lua_getglobal(L,"package");
+        luaWrap_lua_getfield(L,-1,"path");
+        std::string path(luaWrap_lua_isstring(L,-1)?luaWrap_lua_tostring(L,-1):"");
+        luaWrap_lua_settop(L,1);
+        if (!_findModule(L,name.c_str(),path.c_str(),filename))
+            return(1); // list of files tried, or error message
+        std::string code;
+        ok=_readFile(filename,code);
+        std::string err("error loading module '"+name+"' from file '"+filename+"'");
+        if (ok)
+        {
+            ok=(loadBuffer(L,code.c_str(),code.size(),("@"+filename).c_str())==0);
+            if (ok)
+                luaWrap_lua_pushstring(L,filename.c_str());
+            else
+            {
+                err+=":\n\t";
+                err+=luaWrap_lua_tostring(L,-1);
+            }
+        }
+        if (!ok)
+            luaWrap_lua_pushstring(L,err.c_str());
+    }
+    if (!ok)
+        luaWrap_lua_error(L); // does a long jump and never returns
+    return(2);
+}
+
+bool CLuaBytecodeCache::precompileModule(luaWrap_lua_State* L,const char* name,const char* path)
+{
+    bool retVal=false;
+    int top=luaWrap_lua_gettop(L);
+    std::string filename,code;
+    if ( _findModule(L,name,path,filename)&&_readFile(filename,code) )
+        retVal=(loadBuffer(L,code.c_str(),code.size(),("@"+filename).c_str())==0);
+    luaWrap_lua_settop(L,top);
+    return(retVal);
+}
+
+bool CLuaBytecodeCache::_findModule(luaWrap_lua_State* L,const char* name,const char* path,std::string& filename)
+{ // package.searchpath(name,path). If not found, leaves the reason on the stack
+    luaWrap_lua_getglobal(L,"package");
+    luaWrap_lua_getfield(L,-1,"searchpath");
+    luaWrap_lua_remove(L,-2);
+    luaWrap_lua_pushstring(L,name);
+    luaWrap_lua_pushstring(L,path);
+    if (luaWrap_lua_pcall(L,2,2,0)!=0)
+        return(false); // error message
+    if (luaWrap_lua_isnil(L,-2))
+        return(false); // list of files tried
+    filename=luaWrap_lua_tostring(L,-2);
+    luaWrap_lua_pop(L,2);
+    return(true);
+}
+
+bool CLuaBytecodeCache::_readFile(const std::string& filename,std::string& content)
+{
+    bool retVal=false;
+    FILE* f=fopen(filename.c_str(),"rb");
+    if (f!=nullptr)
+    {
+        fseek(f,0,SEEK_END);
+        long l=ftell(f);
+        fseek(f,0,SEEK_SET);
+        if (l>=0)
+        {
+            content.resize(size_t(l));
+            retVal=(fread(&content[0],1,size_t(l),f)==size_t(l));
+        }
+        fclose(f);
+    }
+    return(retVal);
+}
+
+void CLuaBytecodeCache::_insert(const std::string& key,const std::string& bytecode)
+{ // call with _luaBytecodeCacheMutex locked
+    if ( (bytecode.size()>LUABYTECODECACHE_MAX_MEMORY_SIZE)||(_chunks.find(key)!=_chunks.end()) )
+        return;
+    while (_memorySize+bytecode.size()>LUABYTECODECACHE_MAX_MEMORY_SIZE)
+    {
+        auto it=_chunks.find(_lru.back());
+        _memorySize-=it->second.bytecode.size();
+        _chunks.erase(it);
+        _lru.pop_back();
+    }
+    _lru.push_front(key);
+    SLuaBytecodeCacheEntry& entry=_chunks[key];
+    entry.bytecode=bytecode;
+    entry.lruPos=_lru.begin();
+    _memorySize+=bytecode.size();
+}
+
+std::string CLuaBytecodeCache::_getKey(const char* buff,size_t sz,const char* name)
+{ // the chunk name is part of the key, since it is stored in the bytecode (used in error messages)
+    std::string str(LUA_RELEASE);
+    str+='\0';
+    str+=name;
+    str+='\0';
+    str.append(buff,sz);
+    return(sha256(str));
+}
+
+bool CLuaBytecodeCache::_readFromDisk(const std::string& key,std::string& bytecode)
+{
+    bool retVal=false;
+    std::string folder(App::userSettings->luaBytecodeCacheFolder);
+    if ( (folder.size()>0)&&(_getSecret().size()>0) )
+    {
+        FILE* f=fopen((folder+"/"+key+".luac").c_str(),"rb");
+        if (f!=nullptr)
+        {
+            fseek(f,0,SEEK_END);
+            long l=ftell(f);
+            fseek(f,0,SEEK_SET);
+            if (l>LUABYTECODECACHE_MAC_SIZE)
+            {
+                std::string mac(LUABYTECODECACHE_MAC_SIZE,'\0');
+                bytecode.resize(size_t(l)-LUABYTECODECACHE_MAC_SIZE);
+                retVal=(fread(&mac[0],1,mac.size(),f)==mac.size());
+                retVal=retVal&&(fread(&bytecode[0],1,bytecode.size(),f)==bytecode.size());
+                if (retVal)
+                { // files that are corrupted, not written by this install, or written for another source, are ignored (and
+                  // overwritten once the source was compiled again). Compared in constant time:
+                    std::string expected(_getMac(key,bytecode));
+                    unsigned char diff=0;
+                    for (size_t i=0;i<mac.size();i++)
+                        diff|=(unsigned char)(mac[i]^expected[i]);
+                    retVal=(diff==0);
+                }
+            }
+            fclose(f);
+        }
+    }
+    return(retVal);
+}
+
+std::string CLuaBytecodeCache::_getMac(const std::string& key,const std::string& bytecode)
+{ // HMAC-SHA256(secret,key+bytecode), in hex. The key binds the file to the source it was compiled from
+    const unsigned int blockSize=64;
+    unsigned char k[blockSize]={0};
+    const std::string& secret=_getSecret();
+    for (size_t i=0;(i<secret.size())&&(i<blockSize);i++)
+        k[i]=(unsigned char)secret[i];
+    unsigned char pad[blockSize];
+    unsigned char inner[SHA256::DIGEST_SIZE];
+    unsigned char outer[SHA256::DIGEST_SIZE];
+    SHA256 ctx;
+    for (unsigned int i=0;i<blockSize;i++)
+        pad[i]=k[i]^0x36;
+    ctx.init();
+    ctx.update(pad,blockSize);
+    ctx.update((const unsigned char*)key.c_str(),(unsigned int)key.size());
+    ctx.update((const unsigned char*)bytecode.c_str(),(unsigned int)bytecode.size());
+    ctx.final(inner);
+    for (unsigned int i=0;i<blockSize;i++)
+        pad[i]=k[i]^0x5c;
+    ctx.init();
+    ctx.update(pad,blockSize);
+    ctx.update(inner,SHA256::DIGEST_SIZE);
+    ctx.final(outer);
+    std::string retVal;
+    const char* hex="0123456789abcdef";
+    for (unsigned int i=0;i<SHA256::DIGEST_SIZE;i++)
+    {
+        retVal+=hex[outer[i]>>4];
+        retVal+=hex[outer[i]&15];
+    }
+    return(retVal);
+}
+
+const std::string& CLuaBytecodeCache::_getSecret()
+{ // created once per install. Empty if it could not be read nor created, in which case nothing goes to disk
+    _luaBytecodeCacheMutex.lock("CLuaBytecodeCache::_getSecret");
+    if (_secret.size()==0)
+    {
+        std::string filename(CFolderSystem::getUserSettingsPath()+"/" LUABYTECODECACHE_SECRET_FILE);
+        for (size_t attempt=0;(attempt<2)&&(_secret.size()==0);attempt++)
+        {
+            FILE* f=fopen(filename.c_str(),"rb");
+            if (f!=nullptr)
+            {
+                std::string secret(LUABYTECODECACHE_SECRET_SIZE,'\0');
+                if (fread(&secret[0],1,secret.size(),f)==secret.size())
+                    _secret=secret;
+                fclose(f);
+            }
+            else if (attempt==0)
+            { // first use. If another instance does the same at the same time, one of them might keep a secret that then gets
+              // replaced on disk: its files are then just not accepted, and compiled again
+                std::random_device rd;
+                std::string secret;
+                for (size_t i=0;i<LUABYTECODECACHE_SECRET_SIZE;i++)
+                    secret+=char(rd()&255);
+                std::string tmpFilename(filename+"."+std::to_string(rd())+".tmp");
+                f=fopen(tmpFilename.c_str(),"wb");
+                if (f!=nullptr)
+                {
+                    bool ok=(fwrite(secret.c_str(),1,secret.size(),f)==secret.size());
+                    ok=(fclose(f)==0)&&ok;
+                    if ( (!ok)||(rename(tmpFilename.c_str(),filename.c_str())!=0) )
+                        remove(tmpFilename.c_str());
+                }
+            }
+        }
+    }
+    _luaBytecodeCacheMutex.unlock();
+    return(_secret);
+}
+
+void CLuaBytecodeCache::_writeToDisk(const std::string& key,const std::string& bytecode)
+{
+    std::string folder(App::userSettings->luaBytecodeCacheFolder);
+    if ( (folder.size()>0)&&(_getSecret().size()>0) )
+    {
+        if (!VFile::doesFolderExist(folder.c_str()))
+            VFile::createFolder(folder.c_str());
+        std::string filename(folder+"/"+key+".luac");
+        std::string tmpFilename(filename+".tmp");
+        FILE* f=fopen(tmpFilename.c_str(),"wb");
+        if (f!=nullptr)
+        {
+            std::string mac(_getMac(key,bytecode));
+            bool ok=(fwrite(mac.c_str(),1,mac.size(),f)==mac.size());
+            ok=ok&&(fwrite(bytecode.c_str(),1,bytecode.size(),f)==bytecode.size());
+            ok=(fclose(f)==0)&&ok;
+            if (ok)
+            { // other instances never see a partially written file:
+                remove(filename.c_str());
+                ok=(rename(tmpFilename.c_str(),filename.c_str())==0);
+            }
+            if (!ok)
+                remove(tmpFilename.c_str());
+        }
+    }
+}
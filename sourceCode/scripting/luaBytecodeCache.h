@@ -0,0 +1,43 @@
+#pragma once
+
+#include <luaWrapper.h>
+#include <unordered_map>
+#include <list>
+#include <string>
+
+struct SLuaBytecodeCacheEntry
+{
+    std::string bytecode;
+    std::list<std::string>::iterator lruPos;
+};
+
+class CLuaBytecodeCache
+{ // Compiled Lua chunks (lua_dump output), keyed by the sha256 of Lua version, chunk name and source. Optionally also kept on disk.
+  // Files on disk carry an HMAC-SHA256 of key and bytecode, keyed by a per-install secret stored in the user settings folder:
+  // a file that was not written by this install, or that was moved to another key, is never loaded. The folder should
+  // still only be writable by trusted users, since anyone who can also read the secret can forge files
+public:
+    static int loadBuffer(luaWrap_lua_State* L,const char* buff,size_t sz,const char* name); // same as luaWrap_luaL_loadbuffer
+    static void installModuleSearcher(luaWrap_lua_State* L); // modules loaded with 'require' also go through the cache
+    static bool precompileModule(luaWrap_lua_State* L,const char* name,const char* path); // puts the module in the cache, without running it
+    static void clear();
+    static void getStats(size_t& hits,size_t& misses,size_t& memorySize);
+
+private:
+    static std::string _getKey(const char* buff,size_t sz,const char* name);
+    static void _insert(const std::string& key,const std::string& bytecode);
+    static int _moduleSearcher(luaWrap_lua_State* L);
+    static bool _findModule(luaWrap_lua_State* L,const char* name,const char* path,std::string& filename);
+    static bool _readFile(const std::string& filename,std::string& content);
+    static bool _readFromDisk(const std::string& key,std::string& bytecode);
+    static std::string _getMac(const std::string& key,const std::string& bytecode);
+    static const std::string& _getSecret();
+    static void _writeToDisk(const std::string& key,const std::string& bytecode);
+
+    static std::unordered_map<std::string,SLuaBytecodeCacheEntry> _chunks;
+    static std::list<std::string> _lru; // keys, most recently used first
+    static size_t _memorySize;
+    static size_t _hits;
+    static size_t _misses;
+    static std::string _secret;
+};
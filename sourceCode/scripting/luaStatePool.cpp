@@ -0,0 +1,203 @@
+#include <luaStatePool.h>
+#include <scriptObject.h>
+#include <luaBytecodeCache.h>
+#include <app.h>
+#include <chrono>
+#include <algorithm>
+
+std::vector<CLuaStatePool*> CLuaStatePool::_poolsToRefill;
+VMutex CLuaStatePool::_poolsToRefillMutex;
+
+CLuaStatePool::CLuaStatePool(int size/*=-1*/)
+{
+    _size=size;
+    _targetSize=0;
+    _refilling=false;
+    _stopRefill=false;
+    _oldApiNotation=false;
+    _hits=0;
+    _misses=0;
+}
+
+CLuaStatePool::~CLuaStatePool()
+{
+    clear();
+}
+
+CLuaStatePool* CLuaStatePool::getDefaultPool()
+{ // never destroyed: emptied in CWorldContainer::deinitialize
+    static CLuaStatePool* pool=new CLuaStatePool();
+    return(pool);
+}
+
+size_t CLuaStatePool::_getSize() const
+{
+    int retVal=_size;
+    if (retVal<0)
+        retVal=App::userSettings->luaStatePoolSize;
+    return(size_t(std::max<int>(0,retVal)));
+}
+
+luaWrap_lua_State* CLuaStatePool::takeState()
+{
+    luaWrap_lua_State* retVal=nullptr;
+    if (_getSize()>0)
+    {
+        _mutex.lock("CLuaStatePool::takeState");
+        if ( (_states.size()>0)&&(_oldApiNotation==App::userSettings->getSupportOldApiNotation()) )
+        {
+            retVal=_states[_states.size()-1];
+            _states.pop_back();
+            _hits++;
+        }
+        else
+            _misses++;
+        _mutex.unlock();
+    }
+    return(retVal);
+}
+
+void CLuaStatePool::refill(bool waitUntilDone/*=false*/)
+{ // e.g. once the simulation ended. Returns without waiting for the states to be built, unless waitUntilDone is true
+    bool oldApiNotation=App::userSettings->getSupportOldApiNotation();
+    std::string modulePath(CScriptObject::getSearchPath_lua());
+    _mutex.lock("CLuaStatePool::refill");
+    if (oldApiNotation!=_oldApiNotation)
+    {
+        for (size_t i=0;i<_states.size();i++)
+            luaWrap_lua_close(_states[i]);
+        _states.clear();
+        _oldApiNotation=oldApiNotation;
+    }
+    size_t size=_getSize();
+    while (_states.size()>size)
+    {
+        luaWrap_lua_close(_states[_states.size()-1]);
+        _states.pop_back();
+    }
+    _targetSize=size;
+    _modulePath=modulePath;
+    _stopRefill=false;
+    bool launch=( (_states.size()<size)&&(!_refilling) ); // a running refill thread picks up the new size
+    if (launch)
+        _refilling=true;
+    _mutex.unlock();
+    if (launch)
+    {
+        _poolsToRefillMutex.lock("CLuaStatePool::refill");
+        _poolsToRefill.push_back(this);
+        _poolsToRefillMutex.unlock();
+        VThread::launchThread(_refillWorker,false);
+    }
+    if (waitUntilDone)
+    {
+        while (_refilling)
+            VThread::sleep(1);
+    }
+}
+
+VTHREAD_RETURN_TYPE CLuaStatePool::_refillWorker(VTHREAD_ARGUMENT_TYPE lpData)
+{ // states are built without the lock, so that takeState never waits for a state to be built
+    _poolsToRefillMutex.lock("CLuaStatePool::_refillWorker");
+    CLuaStatePool* pool=_poolsToRefill[0];
+    _poolsToRefill.erase(_poolsToRefill.begin());
+    _poolsToRefillMutex.unlock();
+    while (true)
+    {
+        pool->_mutex.lock("CLuaStatePool::_refillWorker");
+        if ( pool->_stopRefill||(pool->_states.size()>=pool->_targetSize) )
+        {
+            pool->_refilling=false;
+            pool->_mutex.unlock();
+            break;
+        }
+        bool oldApiNotation=pool->_oldApiNotation;
+        std::string modulePath(pool->_modulePath);
+        pool->_mutex.unlock();
+        luaWrap_lua_State* L=_buildState(modulePath);
+        pool->_mutex.lock("CLuaStatePool::_refillWorker");
+        if ( (oldApiNotation==pool->_oldApiNotation)&&(!pool->_stopRefill)&&(pool->_states.size()<pool->_targetSize) )
+        {
+            pool->_states.push_back(L);
+            L=nullptr;
+        }
+        pool->_mutex.unlock();
+        if (L!=nullptr)
+            luaWrap_lua_close(L);
+    }
+    VThread::endThread();
+    return(VTHREAD_RETURN_VAL);
+}
+
+void CLuaStatePool::clear()
+{
+    _mutex.lock("CLuaStatePool::clear");
+    _stopRefill=true;
+    _mutex.unlock();
+    while (_refilling)
+        VThread::sleep(1);
+    _mutex.lock("CLuaStatePool::clear");
+    for (size_t i=0;i<_states.size();i++)
+        luaWrap_lua_close(_states[i]);
+    _states.clear();
+    _hits=0;
+    _misses=0;
+    _mutex.unlock();
+}
+
+void CLuaStatePool::getStats(size_t& available,size_t& hits,size_t& misses)
+{
+    _mutex.lock("CLuaStatePool::getStats");
+    available=_states.size();
+    hits=_hits;
+    misses=_misses;
+    _mutex.unlock();
+}
+
+luaWrap_lua_State* CLuaStatePool::_buildState(const std::string& modulePath)
+{ // same as the first part of CScriptObject::_initInterpreterState. Nothing in here depends on the script or the scene.
+  // Also runs on the refill thread, so nothing process-wide either: os.setlocale stays in _initInterpreterState. 'require'
+  // itself stays there too, since the module registers script-specific hooks. Its compilation is done here, and is found
+  // in the bytecode cache by the module searcher
+    luaWrap_lua_State* L=luaWrap_luaL_newstate();
+    luaWrap_luaL_openlibs(L);
+    CLuaBytecodeCache::installModuleSearcher(L);
+    luaWrap_luaL_dostring(L,"sim={}");
+    CScriptObject::registerNewFunctions_lua(L);
+    CScriptObject::registerNewVariables_lua(L);
+    CLuaBytecodeCache::precompileModule(L,"sim",modulePath.c_str());
+    return(L);
+}
+
+void CLuaStatePool::benchmark(size_t stateCnt,double& buildMs,double& refillCallMs,double& backgroundMs,double& takeMs)
+{ // buildMs: stateCnt states built in the calling thread (i.e. what a script start costs without the pool).
+  // refillCallMs: the refill call at simulation end. backgroundMs: until the pool is full. takeMs: stateCnt states taken from
+  // the pool (i.e. what a script start costs with the pool). Uses its own pool: the default pool is not touched
+    std::string modulePath(CScriptObject::getSearchPath_lua());
+    std::vector<luaWrap_lua_State*> states;
+    auto start=std::chrono::steady_clock::now();
+    for (size_t i=0;i<stateCnt;i++)
+        states.push_back(_buildState(modulePath));
+    buildMs=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+    for (size_t i=0;i<states.size();i++)
+        luaWrap_lua_close(states[i]);
+    states.clear();
+
+    CLuaStatePool pool(int(stateCnt));
+    start=std::chrono::steady_clock::now();
+    pool.refill();
+    refillCallMs=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+    while (pool._refilling)
+        VThread::sleep(1);
+    backgroundMs=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+    start=std::chrono::steady_clock::now();
+    for (size_t i=0;i<stateCnt;i++)
+    {
+        luaWrap_lua_State* L=pool.takeState();
+        if (L!=nullptr)
+            states.push_back(L);
+    }
+    takeMs=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+    for (size_t i=0;i<states.size();i++)
+        luaWrap_lua_close(states[i]);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <luaWrapper.h>
+#include <vThread.h>
+#include <vMutex.h>
+#include <vector>
+#include <string>
+#include <atomic>
+
+class CLuaStatePool
+{ // Pristine Lua states (standard libs, API functions and variables registered), prepared in advance for simulation scripts
+public:
+    CLuaStatePool(int size=-1); // size -1: follows the user setting luaStatePoolSize
+    virtual ~CLuaStatePool();
+
+    static CLuaStatePool* getDefaultPool(); // the one simulation scripts take their states from
+
+    luaWrap_lua_State* takeState(); // nullptr if the pool is empty or disabled
+    void refill(bool waitUntilDone=false); // a background thread builds states until the pool size is reached
+    void clear(); // also stops the background thread
+    void getStats(size_t& available,size_t& hits,size_t& misses);
+    static void benchmark(size_t stateCnt,double& buildMs,double& refillCallMs,double& backgroundMs,double& takeMs);
+
+private:
+    size_t _getSize() const;
+
+    static luaWrap_lua_State* _buildState(const std::string& modulePath);
+    static VTHREAD_RETURN_TYPE _refillWorker(VTHREAD_ARGUMENT_TYPE lpData);
+
+    int _size;
+    std::vector<luaWrap_lua_State*> _states;
+    size_t _targetSize;
+    std::string _modulePath; // where the refill thread looks for the modules it precompiles
+    std::atomic<bool> _refilling;
+    bool _stopRefill;
+    bool _oldApiNotation; // states built with the old API notation differ
+    size_t _hits;
+    size_t _misses;
+    VMutex _mutex;
+
+    static std::vector<CLuaStatePool*> _poolsToRefill; // one entry per launched refill thread, which picks one up
+    static VMutex _poolsToRefillMutex;
+};
@@ -268,6 +268,34 @@ int luaWrap_luaL_loadbuffer(luaWrap_lua_State* L,const char* buff,size_t sz,cons
     return(luaL_loadbuffer((lua_State*)L,buff,sz,name));
 }
 
+static int _luaWrap_dumpWriter(lua_State* L,const void* p,size_t sz,void* ud)
+{
+    ((std::string*)ud)->append((const char*)p,sz);
+    return(0);
+}
+
+int luaWrap_lua_dump(luaWrap_lua_State* L,std::string& buffer)
+{
+    buffer.clear();
+    return(lua_dump((lua_State*)L,_luaWrap_dumpWriter,&buffer,0));
+}
+
+bool luaWrap_lua_getstackframe(luaWrap_lua_State* L,int level,std::string& functionName,std::string& source,int& currentLine)
+{ // uses the real lua_Debug: luaWrap_lua_Debug only mirrors its first fields
+    lua_Debug ar;
+    if (lua_getstack((lua_State*)L,level,&ar)==0)
+        return(false);
+    lua_getinfo((lua_State*)L,"Sln",&ar);
+    functionName.clear();
+    if (ar.name!=nullptr)
+        functionName=ar.name;
+    else if (ar.what!=nullptr)
+        functionName=ar.what; // e.g. main
+    source=ar.short_src;
+    currentLine=ar.currentline;
+    return(true);
+}
+
 void luaWrap_lua_remove(luaWrap_lua_State* L,int idx)
 {
     lua_remove((lua_State*)L,idx);
@@ -288,6 +316,26 @@ int luaWrap_lua_isuserdata(luaWrap_lua_State* L,int idx)
     return(lua_isuserdata((lua_State*)L,idx));
 }
 
+void* luaWrap_lua_newuserdata(luaWrap_lua_State* L,size_t size)
+{
+    return(lua_newuserdata((lua_State*)L,size));
+}
+
+int luaWrap_luaL_newmetatable(luaWrap_lua_State* L,const char* name)
+{
+    return(luaL_newmetatable((lua_State*)L,name));
+}
+
+void luaWrap_luaL_setmetatable(luaWrap_lua_State* L,const char* name)
+{
+    luaL_setmetatable((lua_State*)L,name);
+}
+
+void* luaWrap_luaL_testudata(luaWrap_lua_State* L,int idx,const char* name)
+{
+    return(luaL_testudata((lua_State*)L,idx,name));
+}
+
 int luaWrap_lua_upvalueindex(int i)
 {
     return(lua_upvalueindex(i));
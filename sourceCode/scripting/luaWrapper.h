@@ -86,10 +86,16 @@ void luaWrap_lua_rawgeti(luaWrap_lua_State* L,int idx,int n);
 void luaWrap_lua_rawseti(luaWrap_lua_State* L,int idx,int n);
 void luaWrap_lua_newtable(luaWrap_lua_State* L);
 int luaWrap_luaL_loadbuffer(luaWrap_lua_State* L,const char* buff,size_t sz,const char* name);
+int luaWrap_lua_dump(luaWrap_lua_State* L,std::string& buffer); // dumps the function on top of the stack
+bool luaWrap_lua_getstackframe(luaWrap_lua_State* L,int level,std::string& functionName,std::string& source,int& currentLine); // false if there is no such level
 int luaWrap_lua_pcall(luaWrap_lua_State* L,int nargs,int nresult,int errfunc);
 void luaWrap_lua_remove(luaWrap_lua_State* L,int idx);
 void luaWrap_lua_insert(luaWrap_lua_State* L,int idx);
 int luaWrap_lua_isuserdata(luaWrap_lua_State* L,int idx);
+void* luaWrap_lua_newuserdata(luaWrap_lua_State* L,size_t size);
+int luaWrap_luaL_newmetatable(luaWrap_lua_State* L,const char* name); // 0 if the registry already has that name
+void luaWrap_luaL_setmetatable(luaWrap_lua_State* L,const char* name);
+void* luaWrap_luaL_testudata(luaWrap_lua_State* L,int idx,const char* name); // nullptr if not a userdata with that metatable
 int luaWrap_lua_upvalueindex(int i);
 int luaWrap_getCurrentCodeLine(luaWrap_lua_State* L);
 std::string luaWrap_getCurrentCodeSource(luaWrap_lua_State* L);
@@ -0,0 +1,198 @@
+#include <scriptIsolation.h>
+#include <scriptObject.h>
+#include <luaScriptFunctions.h>
+#include <vMutex.h>
+#include <app.h>
+
+// API functions that only read the world, or that only affect the calling script:
+static const char* _readingApiFunctions[]={
+    "sim.getSimulationTime","sim.getSimulationTimeStep","sim.getSimulationState","sim.getSystemTime","sim.getSystemTimeInMs",
+    "sim._getObject","sim.getObjectAlias","sim.getObjectUid","sim.getObjectParent","sim.getObjectChild","sim.getObjectType",
+    "sim.getObjectsInTree","sim.getObjects","sim.isHandle",
+    "sim.getObjectPosition","sim.getObjectOrientation","sim.getObjectQuaternion","sim.getObjectMatrix","sim.getObjectPose",
+    "sim.getObjectPoses","sim.getObjectChildPose","sim.getObjectVelocity",
+    "sim.getJointPosition","sim.getJointVelocity","sim.getJointForce","sim.getJointTargetPosition","sim.getJointTargetVelocity",
+    "sim.getJointTargetForce","sim.getJointInterval","sim.getJointMode","sim.getJointType",
+    "sim.getInt32Signal","sim.getFloatSignal","sim.getDoubleSignal","sim.getStringSignal",
+    "sim.readProximitySensor","sim.readForceSensor","sim.readVisionSensor","sim.getVisionSensorImg","sim.getVisionSensorDepth",
+    "sim.getVisionSensorRes",
+    "sim.buildIdentityMatrix","sim.buildMatrix","sim.buildMatrixQ","sim.buildPose","sim.copyMatrix","sim.getEulerAnglesFromMatrix",
+    "sim.getQuaternionFromMatrix","sim.getRotationAxis","sim.rotateAroundAxis","sim.interpolateMatrices","sim.interpolatePoses",
+    "sim.invertMatrix","sim.invertPose","sim.matrixToPose","sim.poseToMatrix","sim.multiplyMatrices","sim.multiplyPoses",
+    "sim.multiplyVector","sim.transformBuffer","sim.getRandom",
+    "sim.packInt32Table","sim.packUInt32Table","sim.packFloatTable","sim.packDoubleTable","sim.packUInt8Table","sim.packUInt16Table",
+    "sim.unpackInt32Table","sim.unpackUInt32Table","sim.unpackFloatTable","sim.unpackDoubleTable","sim.unpackUInt8Table",
+    "sim.unpackUInt16Table",
+    ""
+};
+
+// API functions that write, and that are buffered:
+static const char* _bufferedApiFunctions[]={
+    "sim.setInt32Signal","sim.setFloatSignal","sim.setDoubleSignal","sim.setStringSignal",
+    "sim.clearInt32Signal","sim.clearFloatSignal","sim.clearDoubleSignal","sim.clearStringSignal",
+    "sim.setJointTargetPosition","sim.setJointTargetVelocity","sim.setJointTargetForce","sim.setJointPosition",
+    "sim.setObjectPosition","sim.setObjectOrientation","sim.setObjectQuaternion","sim.setObjectMatrix","sim.setObjectPose",
+    "sim.setObjectPoses","sim.writeCustomDataBlock","sim.addLog",
+    ""
+};
+
+std::map<std::string,luaWrap_lua_CFunction> CScriptIsolation::_apiFunctions;
+std::vector<SIsolatedRun*> CScriptIsolation::_runs;
+size_t CScriptIsolation::_nextRun=0;
+size_t CScriptIsolation::_pendingRuns=0;
+int CScriptIsolation::_workerCnt=0;
+bool CScriptIsolation::_stopWorkers=false;
+size_t CScriptIsolation::_scriptRuns=0;
+size_t CScriptIsolation::_bufferedCalls=0;
+static VMutex _isolationMutex;
+static thread_local SIsolatedRun* _currentRun=nullptr;
+
+bool CScriptIsolation::isRunningIsolated()
+{
+    return(_currentRun!=nullptr);
+}
+
+int CScriptIsolation::handleApiCall(luaWrap_lua_State* L,const char* functionName)
+{
+    int retVal=-1;
+    auto it=_apiFunctions.find(functionName);
+    if (it==_apiFunctions.end())
+    { // raised unconditionally (i.e. also for scripts that do not raise errors, for backward compatibility): the function must not execute
+        std::string msg(std::to_string(luaWrap_getCurrentCodeLine(L)));
+        msg+=": in ";
+        msg+=functionName;
+        msg+=": function not available to isolated scripts during the sensing phase.";
+        luaWrap_lua_pushstring(L,msg.c_str());
+        luaWrap_lua_error(L); // does a long jump and never returns
+    }
+    else if (it->second!=nullptr)
+    { // a write: applied once all isolated scripts ran
+        SIsolatedApiCall call;
+        call.func=it->second;
+        call.args=new CInterfaceStack(1,1,"");
+        CScriptObject::buildFromInterpreterStack_lua(L,call.args,1,0);
+        _currentRun->calls.push_back(call);
+        retVal=0;
+    }
+    return(retVal);
+}
+
+void CScriptIsolation::deferLog(int verbosity,const char* msg)
+{
+    if (_currentRun!=nullptr)
+        _currentRun->logs.push_back(std::make_pair(verbosity,std::string(msg)));
+}
+
+int CScriptIsolation::runSensing(const std::vector<CScriptObject*>& scripts)
+{
+    _initApiFunctions();
+    int threadCnt=App::userSettings->isolatedScriptThreads;
+    if (threadCnt<=0)
+        threadCnt=VThread::getCoreCount();
+    std::vector<SIsolatedRun*> runs;
+    for (size_t i=0;i<scripts.size();i++)
+    {
+        SIsolatedRun* run=new SIsolatedRun();
+        run->script=scripts[i];
+        run->result=0;
+        runs.push_back(run);
+    }
+
+    _isolationMutex.lock_simple("CScriptIsolation::runSensing");
+    while (_workerCnt<threadCnt-1)
+    { // the simulation thread also runs scripts
+        VThread::launchThread(_worker,false);
+        _workerCnt++;
+    }
+    _runs=runs;
+    _nextRun=0;
+    _pendingRuns=runs.size();
+    _isolationMutex.wakeAll_simple();
+    while (_runNext());
+    while (_pendingRuns>0)
+        _isolationMutex.wait_simple();
+    _runs.clear();
+    _scriptRuns+=runs.size();
+    _isolationMutex.unlock_simple();
+
+    int retVal=0;
+    for (size_t i=0;i<runs.size();i++)
+    { // in script execution order
+        if (runs[i]->result==1)
+            retVal++;
+        runs[i]->script->applySensingIsolated(runs[i]);
+        _bufferedCalls+=runs[i]->calls.size();
+        for (size_t j=0;j<runs[i]->calls.size();j++)
+            delete runs[i]->calls[j].args;
+        delete runs[i];
+    }
+    return(retVal);
+}
+
+void CScriptIsolation::stopWorkers()
+{
+    _isolationMutex.lock_simple("CScriptIsolation::stopWorkers");
+    _stopWorkers=true;
+    _isolationMutex.wakeAll_simple();
+    while (_workerCnt>0)
+        _isolationMutex.wait_simple();
+    _stopWorkers=false;
+    _isolationMutex.unlock_simple();
+}
+
+void CScriptIsolation::getStats(int& workers,size_t& scriptRuns,size_t& bufferedCalls)
+{
+    _isolationMutex.lock_simple("CScriptIsolation::getStats");
+    workers=_workerCnt;
+    scriptRuns=_scriptRuns;
+    bufferedCalls=_bufferedCalls;
+    _isolationMutex.unlock_simple();
+}
+
+VTHREAD_RETURN_TYPE CScriptIsolation::_worker(VTHREAD_ARGUMENT_TYPE lpData)
+{
+    _isolationMutex.lock_simple("CScriptIsolation::_worker");
+    while (!_stopWorkers)
+    {
+        if (!_runNext())
+            _isolationMutex.wait_simple();
+    }
+    _workerCnt--;
+    _isolationMutex.wakeAll_simple();
+    _isolationMutex.unlock_simple();
+    VThread::endThread();
+    return(VTHREAD_RETURN_VAL);
+}
+
+bool CScriptIsolation::_runNext()
+{ // call with _isolationMutex locked. The lock is released while the script runs
+    if (_nextRun>=_runs.size())
+        return(false);
+    SIsolatedRun* run=_runs[_nextRun++];
+    _isolationMutex.unlock_simple();
+    _currentRun=run;
+    run->result=run->script->callSensingIsolated(run->errorMsg);
+    _currentRun=nullptr;
+    _isolationMutex.lock_simple("CScriptIsolation::_runNext");
+    _pendingRuns--;
+    if (_pendingRuns==0)
+        _isolationMutex.wakeAll_simple();
+    return(true);
+}
+
+void CScriptIsolation::_initApiFunctions()
+{ // simulation thread. Workers only read _apiFunctions
+    if (_apiFunctions.size()==0)
+    {
+        for (size_t i=0;_readingApiFunctions[i][0]!=0;i++)
+            _apiFunctions[_readingApiFunctions[i]]=nullptr;
+        for (size_t i=0;simLuaCommands[i].name!="";i++)
+        {
+            for (size_t j=0;_bufferedApiFunctions[j][0]!=0;j++)
+            {
+                if (simLuaCommands[i].name.compare(_bufferedApiFunctions[j])==0)
+                    _apiFunctions[_bufferedApiFunctions[j]]=simLuaCommands[i].func;
+            }
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <luaWrapper.h>
+#include <interfaceStack.h>
+#include <vThread.h>
+#include <vector>
+#include <string>
+#include <map>
+
+class CScriptObject;
+
+struct SIsolatedApiCall
+{ // a write, buffered while the script ran on a worker thread
+    luaWrap_lua_CFunction func;
+    CInterfaceStack* args;
+};
+
+struct SIsolatedRun
+{
+    CScriptObject* script;
+    int result; // -1: runtime error, 0: not executed, 1: ok
+    std::string errorMsg;
+    std::vector<SIsolatedApiCall> calls; // in call order
+    std::vector<std::pair<int,std::string>> logs; // verbosity and message of warnings raised on the worker
+};
+
+class CScriptIsolation
+{ // Runs sysCall_sensing of isolated scripts (see sim.setScriptIsolated) concurrently on worker threads. Each script has its own
+  // Lua state. While the workers run, the world is read-only: reading API functions execute normally, writing API functions
+  // are buffered and applied afterwards on the simulation thread, in script execution order. Other API functions raise an error
+public:
+    static bool isRunningIsolated(); // true while the current thread executes an isolated script
+    static int handleApiCall(luaWrap_lua_State* L,const char* functionName); // from LUA_START, while running isolated. -1: execute the function normally. Raises an error for other functions
+    static void deferLog(int verbosity,const char* msg);
+
+    static int runSensing(const std::vector<CScriptObject*>& scripts); // simulation thread only. Returns the number of scripts that executed
+    static void stopWorkers();
+    static void getStats(int& workers,size_t& scriptRuns,size_t& bufferedCalls);
+
+private:
+    static VTHREAD_RETURN_TYPE _worker(VTHREAD_ARGUMENT_TYPE lpData);
+    static bool _runNext(); // false when no run is left
+    static void _initApiFunctions();
+
+    static std::map<std::string,luaWrap_lua_CFunction> _apiFunctions; // allowed functions. nullptr for reading functions
+    static std::vector<SIsolatedRun*> _runs;
+    static size_t _nextRun;
+    static size_t _pendingRuns;
+    static int _workerCnt;
+    static bool _stopWorkers;
+    static size_t _scriptRuns;
+    static size_t _bufferedCalls;
+};
@@ -15,6 +15,11 @@
 #include <unordered_map>
 #include <luaScriptFunctions.h>
 #include <luaWrapper.h>
+#include <luaBytecodeCache.h>
+#include <luaStatePool.h>
+#include <scriptProfiler.h>
+#include <luaBuffer.h>
+#include <scriptIsolation.h>
 #include <regex>
 
 // Old:
@@ -68,6 +73,7 @@ CScriptObject::CScriptObject(int scriptTypeOrMinusOneForSerialization)
     _scriptState=scriptState_unloaded;
     _flaggedForDestruction=false;
     _executionDepth=0;
+    _isolatedExecution=false;
     _autoStartAddOn=-1;
     _treeTraversalDirection=0; // reverse by default
     _previousEditionWindowPosAndSize[0]=50;
@@ -1180,6 +1186,8 @@ int CScriptObject::getTreeTraversalDirection() const
 
 void CScriptObject::setScriptIsDisabled(bool isDisabled)
 {
+    if (_scriptIsDisabled!=isDisabled)
+        CEmbeddedScriptContainer::invalidateScriptsToExecute();
     _scriptIsDisabled=isDisabled;
 }
 
@@ -1359,7 +1367,10 @@ void CScriptObject::setAddOnName(const char* name)
 void CScriptObject::performSceneObjectLoadingMapping(const std::map<int,int>* map)
 {
     if (App::currentWorld->sceneObjects!=nullptr)
+    {
         _objectHandleAttachedTo=CWorld::getLoadingMapping(map,_objectHandleAttachedTo);
+        _announceAttachmentChanged();
+    }
 }
 
 bool CScriptObject::announceSceneObjectWillBeErased(const CSceneObject* object,bool copyBuffer)
@@ -1378,7 +1389,10 @@ bool CScriptObject::announceSceneObjectWillBeErased(const CSceneObject* object,b
 
             // Old:
             if (_threadedExecution_oldThreads)
+            {
                 _objectHandleAttachedTo=-1;
+                _announceAttachmentChanged();
+            }
         }
         if (closeCodeEditor)
         {
@@ -1421,6 +1435,7 @@ int CScriptObject::getObjectHandleThatScriptIsAttachedTo(int scriptTypeToConside
 
 void CScriptObject::setObjectHandleThatScriptIsAttachedTo(int newObjectHandle)
 {
+    CEmbeddedScriptContainer::invalidateScriptsToExecute();
     if (newObjectHandle!=-1)
     {
         if ( (_scriptType==sim_scripttype_childscript)||(_scriptType==sim_scripttype_customizationscript) )
@@ -1428,6 +1443,13 @@ void CScriptObject::setObjectHandleThatScriptIsAttachedTo(int newObjectHandle)
     }
     else
         _objectHandleAttachedTo=-1;
+    _announceAttachmentChanged();
+}
+
+void CScriptObject::_announceAttachmentChanged()
+{
+    if ( (App::currentWorld!=nullptr)&&(App::currentWorld->embeddedScriptContainer!=nullptr) )
+        App::currentWorld->embeddedScriptContainer->announceScriptAttachmentChanged(this);
 }
 
 int CScriptObject::getNumberOfPasses() const
@@ -1467,6 +1489,7 @@ int CScriptObject::systemCallMainScript(int optionalCallType,const CInterfaceSta
 
             retVal=systemCallScript(sim_syscb_actuation,inStack,outStack);
             App::worldContainer->dispatchEvents();
+            App::currentWorld->sceneObjects->updateWorldTransformations(); // batch update before the sensing phase, if enabled
             retVal=systemCallScript(sim_syscb_sensing,inStack,outStack);
 
             if (App::currentWorld->simulation->getSimulationState()==sim_simulation_advancing_lastbeforestop)
@@ -1536,6 +1559,8 @@ int CScriptObject::systemCallScript(int callType,const CInterfaceStack* inStack,
                 {
                     if ( (callType!=sim_syscb_event)||hasSystemFunctionOrHook(sim_syscb_event) )
                     {
+                        if (callType==sim_syscb_event)
+                            inStack=App::worldContainer->getEventBatchForSubscriber({eventsubscriber_script,_scriptHandle},inStack); // possibly pre-filtered
                         retVal=_callSystemScriptFunction(callType,inStack,outStack);
                         if (_scriptType==sim_scripttype_sandboxscript)
                             _scriptState&=7; // remove a possible error flag
@@ -1566,6 +1591,93 @@ int CScriptObject::systemCallScript(int callType,const CInterfaceStack* inStack,
     return(retVal);
 }
 
+void CScriptObject::setIsolatedExecution(bool isolated)
+{
+    _isolatedExecution=isolated;
+}
+
+bool CScriptObject::getIsolatedExecution() const
+{
+    return(_isolatedExecution);
+}
+
+bool CScriptObject::canRunSensingIsolated() const
+{
+    if ( (!_isolatedExecution)||_scriptIsDisabled||_compatibilityMode_oldLua||getThreadedExecution_oldThreads() )
+        return(false);
+    if ( (_scriptType==sim_scripttype_customizationscript)&&(!App::userSettings->runCustomizationScripts) )
+        return(false);
+    return( (_scriptState==scriptState_initialized)&&(_executionDepth==0)&&hasSystemFunctionOrHook(sim_syscb_sensing) );
+}
+
+int CScriptObject::callSensingIsolated(std::string& errorMsg)
+{ // called from a worker thread, see CScriptIsolation. Do not touch anything shared with other scripts in here
+    _timeForNextAutoYielding=int(VDateTime::getTimeInMs())+_delayForAutoYielding;
+    _forbidOverallYieldingLevel=0;
+    _enterExecution();
+    int retVal=_callScriptFunction(getSystemCallbackString(sim_syscb_sensing,0).c_str(),nullptr,nullptr,&errorMsg);
+    _leaveExecution();
+    return(retVal);
+}
+
+void CScriptObject::_enterExecution()
+{ // brackets each call into the script. Nested calls only count once, for the execution time and for the profiler
+    if (_executionDepth==0)
+    {
+        _timeOfScriptExecutionStart=int(VDateTime::getTimeInMs());
+        if (CScriptProfiler::isEnabled())
+            CScriptProfiler::scriptEntered(_scriptHandle);
+    }
+    _executionDepth++;
+}
+
+void CScriptObject::_leaveExecution()
+{
+    _executionDepth--;
+    if (_executionDepth==0)
+    {
+        _timeOfScriptExecutionStart=-1;
+        if (CScriptProfiler::isEnabled())
+            CScriptProfiler::scriptLeft(_scriptHandle);
+    }
+}
+
+void CScriptObject::applySensingIsolated(const SIsolatedRun* run)
+{ // simulation thread, once all isolated scripts ran. Buffered writes are applied as if they had executed in place
+    for (size_t i=0;i<run->logs.size();i++)
+        App::logScriptMsg(getShortDescriptiveName().c_str(),run->logs[i].first,run->logs[i].second.c_str());
+    int result=run->result;
+    std::string errMsg(run->errorMsg);
+    luaWrap_lua_State* L=(luaWrap_lua_State*)_interpreterState;
+    for (size_t i=0;i<run->calls.size();i++)
+    {
+        int oldTop=luaWrap_lua_gettop(L);
+        luaWrap_lua_pushcfunction(L,run->calls[i].func);
+        buildOntoInterpreterStack_lua(L,run->calls[i].args,false);
+        if (luaWrap_lua_pcall(L,run->calls[i].args->getStackSize(),0,0)!=0)
+        { // the script would have stopped there
+            result=-1;
+            errMsg="(error unknown)";
+            if (luaWrap_lua_isstring(L,-1))
+                errMsg=luaWrap_lua_tostring(L,-1);
+            luaWrap_lua_settop(L,oldTop);
+            break;
+        }
+        luaWrap_lua_settop(L,oldTop);
+    }
+    if (result!=0)
+    {
+        if (result==-1)
+        { // a runtime error occurred!
+            _scriptState|=scriptState_error;
+            _announceErrorWasRaisedAndPossiblyPauseSimulation(errMsg.c_str(),true);
+        }
+        _calledInThisSimulationStep=true;
+    }
+    if ( ((_scriptState&scriptState_error)!=0)&&((_scriptState&7)!=scriptState_ended) )
+        _killInterpreterState();
+}
+
 bool CScriptObject::shouldTemporarilySuspendMainScript()
 {
     bool retVal=false;
@@ -1749,9 +1861,7 @@ int CScriptObject::___loadCode(const char* code,const char* functionsToFind,std:
     _execSimpleString_safe_lua(L,tmp.c_str());
     if (_loadBuffer_lua(_code.c_str(),_code.size(),getShortDescriptiveName().c_str()))
     {
-        if (_executionDepth==0)
-            _timeOfScriptExecutionStart=int(VDateTime::getTimeInMs());
-        _executionDepth++;
+        _enterExecution();
         if (_callScriptFunction("",nullptr,nullptr,errorMsg)==-1)
             retVal=0; // a runtime error occurred!
         else
@@ -1804,9 +1914,7 @@ int CScriptObject::___loadCode(const char* code,const char* functionsToFind,std:
                 l=strlen(functionsToFind+off);
             }
         }
-        _executionDepth--;
-        if (_executionDepth==0)
-            _timeOfScriptExecutionStart=-1;
+        _leaveExecution();
     }
     else
     { // A compilation error occurred!
@@ -1962,13 +2070,9 @@ int CScriptObject::_callSystemScriptFunction(int callType,const CInterfaceStack*
     luaWrap_lua_pop(L,1);
 
     std::string errMsg;
-    if (_executionDepth==0)
-        _timeOfScriptExecutionStart=int(VDateTime::getTimeInMs());
-    _executionDepth++;
+    _enterExecution();
     int retVal=_callScriptFunction(getSystemCallbackString(callType,0).c_str(),inStack,outStack,&errMsg);
-    _executionDepth--;
-    if (_executionDepth==0)
-        _timeOfScriptExecutionStart=-1;
+    _leaveExecution();
     if (retVal!=0)
     {
         if (retVal==-1)
@@ -2190,9 +2294,7 @@ int CScriptObject::callCustomScriptFunction(const char* functionName,CInterfaceS
         CInterfaceStack* outStack=App::worldContainer->interfaceStackContainer->createStack();
         // -------------------------------------
         std::string errMsg;
-        if (_executionDepth==0)
-            _timeOfScriptExecutionStart=int(VDateTime::getTimeInMs());
-        _executionDepth++;
+        _enterExecution();
 
         luaWrap_lua_State* L=(luaWrap_lua_State*)_interpreterState;
         luaWrap_lua_getglobal(L,"sysCall_ext");
@@ -2212,9 +2314,7 @@ int CScriptObject::callCustomScriptFunction(const char* functionName,CInterfaceS
         if (!extFunc)
             retVal=_callScriptFunction(functionName,inOutStack,outStack,&errMsg);
 
-        _executionDepth--;
-        if (_executionDepth==0)
-            _timeOfScriptExecutionStart=-1;
+        _leaveExecution();
         if (retVal!=0)
         {
             if (retVal==-1)
@@ -2253,16 +2353,12 @@ int CScriptObject::executeScriptString(const char* scriptString,CInterfaceStack*
     changeOverallYieldingForbidLevel(1,false);
     if (_scriptState==scriptState_initialized)
     {
-        if (_executionDepth==0)
-            _timeOfScriptExecutionStart=int(VDateTime::getTimeInMs());
-        _executionDepth++;
+        _enterExecution();
         if (_execScriptString(scriptString,outStack))
             retVal=0; // success
         else
             retVal=-1;
-        _executionDepth--;
-        if (_executionDepth==0)
-            _timeOfScriptExecutionStart=-1;
+        _leaveExecution();
     }
     changeOverallYieldingForbidLevel(-1,false);
     return(retVal);
@@ -2378,6 +2474,7 @@ bool CScriptObject::_killInterpreterState()
     _scriptState|=scriptState_ended; // set the ended state
     _scriptTextExec.clear();
     _executionDepth=0;
+    _isolatedExecution=false;
 
     for (size_t i=0;i<3;i++)
     {
@@ -2618,10 +2715,18 @@ bool CScriptObject::_initInterpreterState(std::string* errorMsg)
     _timeForNextAutoYielding=int(VDateTime::getTimeInMs())+_delayForAutoYielding;
     _forbidOverallYieldingLevel=0;
 
-    luaWrap_lua_State* L=luaWrap_luaL_newstate();
+    luaWrap_lua_State* L=nullptr;
+    if (isSimulationScript())
+        L=CLuaStatePool::getDefaultPool()->takeState(); // libs, API functions and variables are already registered there
+    bool pristineState=(L!=nullptr);
+    if (!pristineState)
+    {
+        L=luaWrap_luaL_newstate();
+        luaWrap_luaL_openlibs(L);
+        CLuaBytecodeCache::installModuleSearcher(L);
+    }
+    _execSimpleString_safe_lua(L,"os.setlocale'C'"); // process-wide: not done when the pool builds the state
     _interpreterState=L;
-    luaWrap_luaL_openlibs(L);
-    _execSimpleString_safe_lua(L,"os.setlocale'C'");
 
     _setScriptHandleToInterpreterState_lua(L,_scriptHandle);
     setScriptNameIndexToInterpreterState_lua_old(L,_getScriptNameIndexNumber_old());
@@ -2650,9 +2755,12 @@ bool CScriptObject::_initInterpreterState(std::string* errorMsg)
     luaWrap_lua_pop(L,1);
     // --------------------------------------------
 
-    _execSimpleString_safe_lua(L,"sim={}");
-    registerNewFunctions_lua();
-    _registerNewVariables_lua();
+    if (!pristineState)
+    {
+        _execSimpleString_safe_lua(L,"sim={}");
+        registerNewFunctions_lua();
+        registerNewVariables_lua(L);
+    }
     if (0!=_execSimpleString_safe_lua(L,"require('sim')"))
     {
         if (errorMsg!=nullptr)
@@ -2693,6 +2801,8 @@ void CScriptObject::_hookFunction_lua(void* LL,void* arr)
 
     if (ar->event!=luaWrapGet_LUA_HOOKCALL())
     {
+        if (CScriptProfiler::isEnabled())
+            CScriptProfiler::sample(L,it->getScriptHandle());
         // Following 3 instructions are important: it can happen that the user locks/unlocks automatic thread switch in a loop,
         // and that the hook function by malchance only gets called when the thread switches are not allowed (due to the loop
         // timing and hook call timing overlap) --> this thread doesn't switch and stays in a lua loop forever.
@@ -2703,7 +2813,7 @@ void CScriptObject::_hookFunction_lua(void* LL,void* arr)
         // Also remember: the hook gets also called when calling luaWrap_luaL_doString from c++ and similar!!
 
 #ifdef SIM_WITH_GUI
-        if (App::userSettings->getAbortScriptExecutionTiming()!=0)
+        if ( (App::userSettings->getAbortScriptExecutionTiming()!=0)&&(!CScriptIsolation::isRunningIsolated()) )
         {
             if ( it->getScriptExecutionTimeInMs()>(App::userSettings->getAbortScriptExecutionTiming()*1000) )
             {
@@ -2714,7 +2824,7 @@ void CScriptObject::_hookFunction_lua(void* LL,void* arr)
                 App::currentWorld->simulation->showAndHandleEmergencyStopButton(false,"");
         }
 #endif
-        if (!VThread::isCurrentThreadTheMainSimulationThread())
+        if ( (!VThread::isCurrentThreadTheMainSimulationThread())&&(!CScriptIsolation::isRunningIsolated()) )
         { // Old, for backward compatibility with old threads
             if (CThreadPool_old::getSimulationStopRequestedAndActivated())
             {
@@ -2780,7 +2890,13 @@ void CScriptObject::buildOntoInterpreterStack_lua(void* LL,const CInterfaceStack
 
 void CScriptObject::registerNewFunctions_lua()
 {
-    luaWrap_lua_State* L=(luaWrap_lua_State*)_interpreterState;
+    registerNewFunctions_lua(_interpreterState);
+}
+
+void CScriptObject::registerNewFunctions_lua(void* LL)
+{ // also used to prepare pooled states, i.e. nothing in here may depend on a specific script
+    luaWrap_lua_State* L=(luaWrap_lua_State*)LL;
+    CLuaBuffer::registerMetatable(L);
     // CoppeliaSim API functions:
     for (int i=0;simLuaCommands[i].name!="";i++)
     {
@@ -3027,23 +3143,45 @@ void CScriptObject::registerPluginFunctions()
     }
 }
 
-void CScriptObject::_registerNewVariables_lua()
-{
-    luaWrap_lua_State* L=(luaWrap_lua_State*)_interpreterState;
+void CScriptObject::registerNewVariables_lua(void* LL)
+{ // also used to prepare pooled states, i.e. nothing in here may depend on a specific script
+    luaWrap_lua_State* L=(luaWrap_lua_State*)LL;
     for (size_t i=0;simLuaVariables[i].name!="";i++)
-    {
-        std::string tmp(simLuaVariables[i].name.c_str());
-        tmp+="="+std::to_string(simLuaVariables[i].val);
-        _execSimpleString_safe_lua(L,tmp.c_str());
-    }
+        _registerVariable_lua(L,simLuaVariables[i].name.c_str(),simLuaVariables[i].val);
     if (App::userSettings->getSupportOldApiNotation())
     {
         for (size_t i=0;simLuaVariablesOldApi[i].name!="";i++)
+            _registerVariable_lua(L,simLuaVariablesOldApi[i].name.c_str(),simLuaVariablesOldApi[i].val);
+    }
+}
+
+void CScriptObject::_registerVariable_lua(void* LL,const char* name,int value)
+{ // "xxx" or "table.xxx". Much faster than compiling and running "name=value" for each variable
+    luaWrap_lua_State* L=(luaWrap_lua_State*)LL;
+    std::string n(name);
+    size_t p=n.find(".");
+    bool done=false;
+    if (p==std::string::npos)
+    {
+        luaWrap_lua_pushinteger(L,value);
+        luaWrap_lua_setglobal(L,name);
+        done=true;
+    }
+    else if (n.find(".",p+1)==std::string::npos)
+    {
+        luaWrap_lua_getglobal(L,n.substr(0,p).c_str());
+        if (luaWrap_lua_istable(L,-1))
         {
-            std::string tmp(simLuaVariablesOldApi[i].name.c_str());
-            tmp+="="+std::to_string(simLuaVariablesOldApi[i].val);
-            _execSimpleString_safe_lua(L,tmp.c_str());
+            luaWrap_lua_pushinteger(L,value);
+            luaWrap_lua_setfield(L,-2,n.c_str()+p+1);
+            done=true;
         }
+        luaWrap_lua_pop(L,1);
+    }
+    if (!done)
+    {
+        std::string tmp(n+"="+std::to_string(value));
+        luaWrap_luaL_dostring(L,tmp.c_str());
     }
 }
 
@@ -3261,7 +3399,10 @@ void CScriptObject::serialize(CSer& ar)
                         int v;
                         ar >> v;
                         if (v>=0)
+                        {
                             _objectHandleAttachedTo=v;
+                            _announceAttachmentChanged();
+                        }
                     }
                     if (theName.compare("Cod")==0)
                     {
@@ -3411,7 +3552,7 @@ bool CScriptObject::_loadBuffer_lua(const char* buff,size_t sz,const char* name)
     luaWrap_lua_State* L=(luaWrap_lua_State*)_interpreterState;
     if (_loadBufferResult_lua!=0)
     {
-        _loadBufferResult_lua=luaWrap_luaL_loadbuffer(L,buff,sz,name);
+        _loadBufferResult_lua=CLuaBytecodeCache::loadBuffer(L,buff,sz,name); // skips parsing if that code was already compiled
         if (_loadBufferResult_lua==0)
             luaWrap_lua_setglobal(L,"sim_code_function_to_run");
     }
@@ -3584,6 +3725,12 @@ CInterfaceStackObject* CScriptObject::_generateObjectFromInterpreterStack_lua(vo
         }
         return(table);
     }
+    else if ( (t==STACK_OBJECT_USERDAT)&&CLuaBuffer::isBuffer(L,index) )
+    { // buffers are passed as binary strings: one copy, no per-element conversion
+        size_t l;
+        const char* c=CLuaBuffer::getData(L,index,&l);
+        return(new CInterfaceStackString(c,l));
+    }
     else
     { // following types translate to strings (i.e. can't be handled outside of the Lua state)
         void* p=(void*)luaWrap_lua_topointer(L,index);
@@ -3639,7 +3786,40 @@ void CScriptObject::_pushOntoInterpreterStack_lua(void* LL,CInterfaceStackObject
     {
         luaWrap_lua_newtable(L);
         CInterfaceStackTable* table=(CInterfaceStackTable*)obj;
-        if (table->isTableArray())
+        int packedType=table->getPackedType();
+        if (packedType!=STACK_PACKED_NONE)
+        { // packed numeric array: values go directly into the Lua table, without expanding the stack table
+            size_t cnt=table->getArraySize();
+            if ( (packedType==STACK_PACKED_FLOAT)||(packedType==STACK_PACKED_DOUBLE) )
+            {
+                std::vector<double> v(cnt);
+                table->getDoubleArray(v.data(),int(cnt));
+                for (size_t i=0;i<cnt;i++)
+                {
+#ifdef LUA_STACK_COMPATIBILITY_MODE
+                    long long int w=(long long int)v[i];
+                    if (v[i]==(double)w)
+                        luaWrap_lua_pushinteger(L,w);
+                    else
+                        luaWrap_lua_pushnumber(L,v[i]);
+#else
+                    luaWrap_lua_pushnumber(L,v[i]);
+#endif
+                    luaWrap_lua_rawseti(L,-2,int(i)+1);
+                }
+            }
+            else
+            {
+                std::vector<long long int> v(cnt);
+                table->getInt64Array(v.data(),int(cnt));
+                for (size_t i=0;i<cnt;i++)
+                {
+                    luaWrap_lua_pushinteger(L,v[i]);
+                    luaWrap_lua_rawseti(L,-2,int(i)+1);
+                }
+            }
+        }
+        else if (table->isTableArray())
         { // array-type table
             for (size_t i=0;i<table->getArraySize();i++)
             {
@@ -5671,6 +5851,7 @@ std::string CScriptObject::getScriptPseudoName_old() const
 }
 void CScriptObject::setThreadedExecution_oldThreads(bool threadedExec)
 {
+    CEmbeddedScriptContainer::invalidateScriptsToExecute();
     if (threadedExec)
     {
         if (_scriptType==sim_scripttype_childscript)
@@ -5741,14 +5922,10 @@ void CScriptObject::_launchThreadedChildScriptNow_oldThreads()
         int argCnt=0;
         int errindex=-argCnt-2;
         luaWrap_lua_insert(L,errindex);
-        if (_executionDepth==0)
-            _timeOfScriptExecutionStart=int(VDateTime::getTimeInMs());
-        _executionDepth++;
+        _enterExecution();
         if (luaWrap_lua_pcall((luaWrap_lua_State*)_interpreterState,argCnt,luaWrapGet_LUA_MULTRET(),errindex)!=0)
         { // a runtime error occurred!
-            _executionDepth--;
-            if (_executionDepth==0)
-                _timeOfScriptExecutionStart=-1;
+            _leaveExecution();
             _scriptState|=scriptState_error;
             // We have to exit the thread free mode if we are still in there (the instance should automatically be restored when this thread resumes):
             if (CThreadPool_old::isThreadInFreeMode())
@@ -5764,9 +5941,7 @@ void CScriptObject::_launchThreadedChildScriptNow_oldThreads()
         }
         else
         {
-            _executionDepth--;
-            if (_executionDepth==0)
-                _timeOfScriptExecutionStart=-1;
+            _leaveExecution();
             _scriptState=scriptState_initialized;
             luaWrap_lua_getglobal(L,getSystemCallbackString(sim_syscb_vision,0).c_str());
             _containedSystemCallbacks[sim_syscb_vision]=luaWrap_lua_isfunction(L,-1);
@@ -5788,14 +5963,10 @@ void CScriptObject::_launchThreadedChildScriptNow_oldThreads()
                     int argCnt=0;
                     int errindex=-argCnt-2;
                     luaWrap_lua_insert(L,errindex);
-                    if (_executionDepth==0)
-                        _timeOfScriptExecutionStart=int(VDateTime::getTimeInMs());
-                    _executionDepth++;
+                    _enterExecution();
                     if (luaWrap_lua_pcall((luaWrap_lua_State*)_interpreterState,argCnt,luaWrapGet_LUA_MULTRET(),errindex)!=0)
                     { // a runtime error occurred!
-                        _executionDepth--;
-                        if (_executionDepth==0)
-                            _timeOfScriptExecutionStart=-1;
+                        _leaveExecution();
                         _scriptState|=scriptState_error;
                         if (CThreadPool_old::isThreadInFreeMode())
                             CThreadPool_old::setThreadFreeMode(false);
@@ -5811,9 +5982,7 @@ void CScriptObject::_launchThreadedChildScriptNow_oldThreads()
                     {
                         if (calls[callIndex]==sim_syscb_cleanup)
                             _handleCallbackEx_old(sim_syscb_cleanup);
-                        _executionDepth--;
-                        if (_executionDepth==0)
-                            _timeOfScriptExecutionStart=-1;
+                        _leaveExecution();
                     }
                 }
                 else
@@ -5877,14 +6046,10 @@ bool CScriptObject::_callScriptChunk_old(int callType,const CInterfaceStack* inS
         int argCnt=inputArgs;
         int errindex=-argCnt-2;
         luaWrap_lua_insert(L,errindex);
-        if (_executionDepth==0)
-            _timeOfScriptExecutionStart=int(VDateTime::getTimeInMs());
-        _executionDepth++;
+        _enterExecution();
         if (luaWrap_lua_pcall((luaWrap_lua_State*)_interpreterState,argCnt,luaWrapGet_LUA_MULTRET(),errindex)!=0)
         { // a runtime error occurred!
-            _executionDepth--;
-            if (_executionDepth==0)
-                _timeOfScriptExecutionStart=-1;
+            _leaveExecution();
             _scriptState|=scriptState_error;
             std::string errMsg;
             if (luaWrap_lua_isstring(L,-1))
@@ -5897,9 +6062,7 @@ bool CScriptObject::_callScriptChunk_old(int callType,const CInterfaceStack* inS
         else
         {
             _handleCallbackEx_old(callType);
-            _executionDepth--;
-            if (_executionDepth==0)
-                _timeOfScriptExecutionStart=-1;
+            _leaveExecution();
             if (outStack!=nullptr)
             {
                 int currentTop=luaWrap_lua_gettop(L);
@@ -5993,14 +6156,10 @@ int CScriptObject::callScriptFunction_DEPRECATED(const char* functionName,SLuaCa
     int errindex=-argCnt-2;
     luaWrap_lua_insert(L,errindex);
 
-    if (_executionDepth==0)
-        _timeOfScriptExecutionStart=int(VDateTime::getTimeInMs());
-    _executionDepth++;
+    _enterExecution();
     if (luaWrap_lua_pcall((luaWrap_lua_State*)_interpreterState,argCnt,luaWrapGet_LUA_MULTRET(),errindex)!=0)
     { // a runtime error occurred!
-        _executionDepth--;
-        if (_executionDepth==0)
-            _timeOfScriptExecutionStart=-1;
+        _leaveExecution();
         std::string errMsg;
         if (luaWrap_lua_isstring(L,-1))
             errMsg=std::string(luaWrap_lua_tostring(L,-1));
@@ -6019,9 +6178,7 @@ int CScriptObject::callScriptFunction_DEPRECATED(const char* functionName,SLuaCa
     }
     else
     { // return values:
-        _executionDepth--;
-        if (_executionDepth==0)
-            _timeOfScriptExecutionStart=-1;
+        _leaveExecution();
         int currentTop=luaWrap_lua_gettop(L);
 
         // Following line new since 7/3/2016:
@@ -23,6 +23,7 @@
 // **********************
 
 class CSceneObject;
+struct SIsolatedRun;
 
 class CScriptObject
 {
@@ -79,6 +80,12 @@ public:
     int callCustomScriptFunction(const char* functionName,CInterfaceStack* inOutStack);
     bool shouldTemporarilySuspendMainScript();
 
+    void setIsolatedExecution(bool isolated);
+    bool getIsolatedExecution() const;
+    bool canRunSensingIsolated() const;
+    int callSensingIsolated(std::string& errorMsg);
+    void applySensingIsolated(const SIsolatedRun* run);
+
     int executeScriptString(const char* scriptString,CInterfaceStack* outStack);
 
     void terminateScriptExecutionExternally(bool generateErrorMsg);
@@ -169,6 +176,8 @@ public:
     // Lua specific:
     // -----------------------------
     void registerNewFunctions_lua();
+    static void registerNewFunctions_lua(void* LL);
+    static void registerNewVariables_lua(void* LL);
     static void buildFromInterpreterStack_lua(void* LL,CInterfaceStack* stack,int fromPos,int cnt);
     static void buildOntoInterpreterStack_lua(void* LL,const CInterfaceStack* stack,bool takeOnlyTop);
     static int getScriptHandleFromInterpreterState_lua(void* LL);
@@ -233,6 +242,9 @@ protected:
     int _callScriptFunc(const char* functionName,const CInterfaceStack* inStack,CInterfaceStack* outStack,std::string* errorMsg);
     bool _execScriptString(const char* scriptString,CInterfaceStack* outStack);
     void _handleInfoCallback();
+    void _announceAttachmentChanged();
+    void _enterExecution();
+    void _leaveExecution();
 
 
     int _scriptHandle; // is unique since 25.11.2022
@@ -248,6 +260,7 @@ protected:
     std::string _addOnFilePath;
 
     bool _calledInThisSimulationStep;
+    bool _isolatedExecution; // sysCall_sensing can run concurrently with other isolated scripts. Not saved
 
     int _timeForNextAutoYielding;
     int _delayForAutoYielding;
@@ -298,7 +311,6 @@ protected:
     int _execSimpleString_safe_lua(void* LL,const char* string);
     int _loadBufferResult_lua;
     bool _loadBuffer_lua(const char* buff,size_t sz,const char* name);
-    void _registerNewVariables_lua();
     static CInterfaceStackObject* _generateObjectFromInterpreterStack_lua(void* LL,int index,std::map<void*,bool>& visitedTables);
     static CInterfaceStackTable* _generateTableArrayFromInterpreterStack_lua(void* LL,int index,std::map<void*,bool>& visitedTables);
     static CInterfaceStackTable* _generateTableMapFromInterpreterStack_lua(void* LL,int index,std::map<void*,bool>& visitedTables);
@@ -306,6 +318,7 @@ protected:
     static void _pushOntoInterpreterStack_lua(void* LL,CInterfaceStackObject* obj);
     static void _hookFunction_lua(void* LL,void* arr);
     static void _setScriptHandleToInterpreterState_lua(void* LL,int h);
+    static void _registerVariable_lua(void* LL,const char* name,int value);
     // -----------------------------
 
     // Old:
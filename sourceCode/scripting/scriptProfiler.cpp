@@ -0,0 +1,276 @@
+#include <scriptProfiler.h>
+#include <scriptObject.h>
+#include <vMutex.h>
+#include <app.h>
+#include <chrono>
+#include <algorithm>
+#include <stdio.h>
+
+#define SCRIPTPROFILER_MAX_STACK_DEPTH 64
+
+struct SScriptProfilerThread
+{
+    unsigned long long int session;
+    std::vector<SScriptProfilerExec> execs; // innermost script last
+};
+
+std::atomic<bool> CScriptProfiler::_enabled(false);
+unsigned long long int CScriptProfiler::_intervalInNs=0;
+std::map<int,SScriptProfile> CScriptProfiler::_profiles;
+static std::atomic<unsigned long long int> _profilerSession(0);
+static VMutex _profilerMutex;
+static thread_local SScriptProfilerThread _profilerThread={0,{}};
+
+static std::vector<SScriptProfilerExec>& _getExecs()
+{ // execs left over from a previous profiling session are dropped
+    unsigned long long int session=_profilerSession.load(std::memory_order_acquire);
+    if (_profilerThread.session!=session)
+    {
+        _profilerThread.execs.clear();
+        _profilerThread.session=session;
+    }
+    return(_profilerThread.execs);
+}
+
+void CScriptProfiler::start(int intervalInUs)
+{
+    _profilerMutex.lock("CScriptProfiler::start");
+    _intervalInNs=(unsigned long long int)std::max<int>(0,intervalInUs)*1000;
+    _profilerSession++;
+    _profilerMutex.unlock();
+    _enabled=true;
+}
+
+void CScriptProfiler::stop()
+{
+    _enabled=false;
+}
+
+void CScriptProfiler::clear()
+{
+    _profilerMutex.lock("CScriptProfiler::clear");
+    _profiles.clear();
+    _profilerSession++;
+    _profilerMutex.unlock();
+}
+
+void CScriptProfiler::scriptEntered(int scriptHandle)
+{
+    std::vector<SScriptProfilerExec>& execs=_getExecs();
+    unsigned long long int now=_getTimeInNs();
+    if (execs.size()>0)
+        _flush(execs[execs.size()-1],now); // the calling script pauses
+    SScriptProfilerExec e;
+    e.scriptHandle=scriptHandle;
+    e.lastTimeInNs=now;
+    e.apiStartInNs=0;
+    execs.push_back(e);
+}
+
+void CScriptProfiler::scriptLeft(int scriptHandle)
+{
+    std::vector<SScriptProfilerExec>& execs=_getExecs();
+    if ( (execs.size()>0)&&(execs[execs.size()-1].scriptHandle==scriptHandle) )
+    {
+        unsigned long long int now=_getTimeInNs();
+        _flush(execs[execs.size()-1],now);
+        execs.pop_back();
+        if (execs.size()>0)
+        { // the calling script resumes
+            execs[execs.size()-1].lastTimeInNs=now;
+            if (execs[execs.size()-1].apiCalls.size()>0)
+                execs[execs.size()-1].apiStartInNs=now;
+        }
+    }
+}
+
+void CScriptProfiler::sample(luaWrap_lua_State* L,int scriptHandle)
+{
+    std::vector<SScriptProfilerExec>& execs=_getExecs();
+    if ( (execs.size()==0)||(execs[execs.size()-1].scriptHandle!=scriptHandle) )
+        return;
+    SScriptProfilerExec& e=execs[execs.size()-1];
+    if (e.apiCalls.size()>0)
+        _dropUnwoundApiCalls(e,L,_getCallDepth(L)); // e.g. an API call raised an error that was caught with pcall
+    unsigned long long int now=_getTimeInNs();
+    if ( (e.lastStack.size()>0)&&(now-e.lastTimeInNs<_intervalInNs) )
+        return;
+    std::vector<std::string> frames;
+    std::string functionName,source;
+    int currentLine;
+    for (int level=0;level<SCRIPTPROFILER_MAX_STACK_DEPTH;level++)
+    {
+        if (!luaWrap_lua_getstackframe(L,level,functionName,source,currentLine))
+            break;
+        if (currentLine<0)
+            continue; // C functions, e.g. pcall
+        if (functionName.size()==0)
+            functionName="?";
+        frames.push_back(functionName+" ("+source+":"+std::to_string(currentLine)+")");
+    }
+    std::string stack;
+    for (size_t i=frames.size();i>0;i--)
+    { // outermost first
+        if (stack.size()>0)
+            stack+=";";
+        stack+=frames[i-1];
+    }
+    e.lastStack=stack; // the time since the previous sample is attributed to the current stack
+    _flush(e,now);
+}
+
+size_t CScriptProfiler::apiEntered(luaWrap_lua_State* L,const char* functionName)
+{
+    size_t retVal=0;
+    std::vector<SScriptProfilerExec>& execs=_getExecs();
+    if (execs.size()>0)
+    {
+        SScriptProfilerExec& e=execs[execs.size()-1];
+        SScriptProfilerApiCall call;
+        call.functionName=functionName;
+        call.L=L;
+        call.callDepth=_getCallDepth(L);
+        _dropUnwoundApiCalls(e,L,call.callDepth);
+        if (e.apiCalls.size()==0)
+            e.apiStartInNs=_getTimeInNs();
+        retVal=e.apiCalls.size();
+        e.apiCalls.push_back(call);
+    }
+    return(retVal);
+}
+
+void CScriptProfiler::apiLeft(size_t token)
+{ // also drops the inner calls that were left with a long jump
+    std::vector<SScriptProfilerExec>& execs=_getExecs();
+    if ( (execs.size()>0)&&(execs[execs.size()-1].apiCalls.size()>token) )
+    {
+        SScriptProfilerExec& e=execs[execs.size()-1];
+        if (token==0)
+            e.apiTimes.push_back(std::make_pair(e.apiCalls[0].functionName,_getTimeInNs()-e.apiStartInNs));
+        e.apiCalls.resize(token);
+    }
+}
+
+void CScriptProfiler::_dropUnwoundApiCalls(SScriptProfilerExec& exec,luaWrap_lua_State* L,int callDepth)
+{ // Lua code, or a new C API call, at callDepth: calls made on the same Lua state at that depth or deeper were left with a long jump.
+  // Their time after the long jump is unknown, and not attributed to the C API
+    size_t n=exec.apiCalls.size();
+    while ( (n>0)&&(exec.apiCalls[n-1].L==L)&&(exec.apiCalls[n-1].callDepth>=callDepth) )
+        n--;
+    if (n!=exec.apiCalls.size())
+    {
+        if (n==0)
+            exec.apiStartInNs=0;
+        exec.apiCalls.resize(n);
+    }
+}
+
+int CScriptProfiler::_getCallDepth(luaWrap_lua_State* L)
+{ // number of frames on the Lua call stack, found with an exponential, then a binary search
+    luaWrap_lua_Debug ar;
+    int low=0; // level low exists (level 0 is the running function)
+    int high=1;
+    if (luaWrap_lua_getstack(L,0,&ar)==0)
+        return(0);
+    while (luaWrap_lua_getstack(L,high,&ar)!=0)
+    {
+        low=high;
+        high*=2;
+    }
+    while (low+1<high)
+    { // level low exists, level high does not
+        int m=(low+high)/2;
+        if (luaWrap_lua_getstack(L,m,&ar)!=0)
+            low=m;
+        else
+            high=m;
+    }
+    return(low+1);
+}
+
+void CScriptProfiler::_flush(SScriptProfilerExec& exec,unsigned long long int now)
+{
+    if (exec.apiCalls.size()>0)
+    { // a C API call is in progress
+        exec.apiTimes.push_back(std::make_pair(exec.apiCalls[0].functionName,now-exec.apiStartInNs));
+        exec.apiStartInNs=now;
+    }
+    unsigned long long int elapsed=now-exec.lastTimeInNs;
+    unsigned long long int apiTime=0;
+    for (size_t i=0;i<exec.apiTimes.size();i++)
+        apiTime+=exec.apiTimes[i].second;
+    std::string stack(exec.lastStack);
+    if (stack.size()==0)
+        stack="?"; // no sample was taken yet
+    _profilerMutex.lock("CScriptProfiler::_flush");
+    SScriptProfile& p=_profiles[exec.scriptHandle];
+    p.totalInNs+=std::max<unsigned long long int>(elapsed,apiTime);
+    p.apiInNs+=apiTime;
+    p.samples++;
+    if (elapsed>apiTime)
+        p.stacks[stack]+=elapsed-apiTime;
+    for (size_t i=0;i<exec.apiTimes.size();i++)
+    {
+        std::string apiFunc("?");
+        if (exec.apiTimes[i].first!=nullptr)
+            apiFunc=exec.apiTimes[i].first;
+        p.stacks[stack+";[C] "+apiFunc]+=exec.apiTimes[i].second;
+    }
+    _profilerMutex.unlock();
+    exec.apiTimes.clear();
+    exec.lastTimeInNs=now;
+}
+
+bool CScriptProfiler::exportCollapsedStacks(const char* filename)
+{
+    FILE* f=fopen(filename,"w");
+    if (f==nullptr)
+        return(false);
+    _profilerMutex.lock("CScriptProfiler::exportCollapsedStacks");
+    for (auto it=_profiles.begin();it!=_profiles.end();it++)
+    {
+        std::string scriptName(_getScriptName(it->first));
+        for (auto it2=it->second.stacks.begin();it2!=it->second.stacks.end();it2++)
+        {
+            unsigned long long int us=it2->second/1000;
+            if (us>0)
+                fprintf(f,"%s;%s %llu\n",scriptName.c_str(),it2->first.c_str(),us);
+        }
+    }
+    _profilerMutex.unlock();
+    return(fclose(f)==0);
+}
+
+void CScriptProfiler::getScriptTotals(std::vector<int>& scriptHandles,std::vector<double>& totalTimesInMs,std::vector<double>& apiShares)
+{
+    scriptHandles.clear();
+    totalTimesInMs.clear();
+    apiShares.clear();
+    _profilerMutex.lock("CScriptProfiler::getScriptTotals");
+    for (auto it=_profiles.begin();it!=_profiles.end();it++)
+    {
+        scriptHandles.push_back(it->first);
+        totalTimesInMs.push_back(double(it->second.totalInNs)/1000000.0);
+        double share=0.0;
+        if (it->second.totalInNs>0)
+            share=double(it->second.apiInNs)/double(it->second.totalInNs);
+        apiShares.push_back(share);
+    }
+    _profilerMutex.unlock();
+}
+
+unsigned long long int CScriptProfiler::_getTimeInNs()
+{
+    return((unsigned long long int)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::string CScriptProfiler::_getScriptName(int scriptHandle)
+{ // ';' and ' ' are separators in the collapsed stack format
+    std::string retVal("script_"+std::to_string(scriptHandle));
+    CScriptObject* it=App::worldContainer->getScriptFromHandle(scriptHandle);
+    if (it!=nullptr)
+        retVal=it->getShortDescriptiveName();
+    std::replace(retVal.begin(),retVal.end(),';','_');
+    std::replace(retVal.begin(),retVal.end(),' ','_');
+    return(retVal);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <luaWrapper.h>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <string>
+
+struct SScriptProfilerApiCall
+{
+    const char* functionName;
+    luaWrap_lua_State* L;
+    int callDepth; // Lua call depth of the C function. Lua code running at that depth or less means the call was left with a long jump
+};
+
+struct SScriptProfilerExec
+{ // a script that is executing on this thread
+    int scriptHandle;
+    unsigned long long int lastTimeInNs; // last sample or resume
+    std::string lastStack;
+    std::vector<SScriptProfilerApiCall> apiCalls; // C API calls in progress (they can call back into Lua), outermost first
+    unsigned long long int apiStartInNs; // of the outermost C API call
+    std::vector<std::pair<const char*,unsigned long long int>> apiTimes; // C API time since lastTimeInNs
+};
+
+struct SScriptProfile
+{
+    unsigned long long int totalInNs;
+    unsigned long long int apiInNs;
+    unsigned long long int samples;
+    std::map<std::string,unsigned long long int> stacks; // collapsed stack --> time in ns
+};
+
+class CScriptProfiler
+{ // Opt-in sampling profiler for Lua scripts. Samples are taken from the count hook, and weighted by the time since the previous sample
+public:
+    static bool isEnabled()
+    {
+        return(_enabled.load(std::memory_order_relaxed));
+    }
+    static void start(int intervalInUs);
+    static void stop();
+    static void clear();
+
+    static void scriptEntered(int scriptHandle);
+    static void scriptLeft(int scriptHandle);
+    static void sample(luaWrap_lua_State* L,int scriptHandle);
+    static size_t apiEntered(luaWrap_lua_State* L,const char* functionName); // returns the token for apiLeft
+    static void apiLeft(size_t token);
+
+    static bool exportCollapsedStacks(const char* filename); // flame graph input, times in us
+    static void getScriptTotals(std::vector<int>& scriptHandles,std::vector<double>& totalTimesInMs,std::vector<double>& apiShares);
+
+private:
+    static unsigned long long int _getTimeInNs();
+    static void _flush(SScriptProfilerExec& exec,unsigned long long int now);
+    static void _dropUnwoundApiCalls(SScriptProfilerExec& exec,luaWrap_lua_State* L,int callDepth);
+    static int _getCallDepth(luaWrap_lua_State* L);
+    static std::string _getScriptName(int scriptHandle);
+
+    static std::atomic<bool> _enabled;
+    static unsigned long long int _intervalInNs;
+    static std::map<int,SScriptProfile> _profiles;
+};
+
+class CScriptProfilerApiCall
+{ // declared in LUA_START: attributes the time spent in a C API function to the calling script. The destructor does not run
+  // if the function raises a Lua error or yields: the profiler then drops the call once Lua code runs at a lower call depth
+public:
+    CScriptProfilerApiCall(luaWrap_lua_State* L,const char* functionName)
+    {
+        _active=CScriptProfiler::isEnabled();
+        if (_active)
+            _token=CScriptProfiler::apiEntered(L,functionName);
+    };
+    ~CScriptProfilerApiCall()
+    {
+        if (_active)
+            CScriptProfiler::apiLeft(_token);
+    };
+
+private:
+    bool _active;
+    size_t _token;
+};
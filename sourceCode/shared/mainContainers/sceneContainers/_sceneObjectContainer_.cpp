@@ -5,6 +5,13 @@
 #include <tt.h>
 #include <ttUtil.h>
 #include <app.h>
+#include <chrono>
+#include <vMutex.h>
+
+#define OBJECTPATHCACHE_MAX_SIZE 10000
+
+std::atomic<unsigned long long int> _CSceneObjectContainer_::_objectPathGeneration(1);
+static VMutex _objectPathCacheMutex;
 
 _CSceneObjectContainer_::_CSceneObjectContainer_()
 {
@@ -13,6 +20,9 @@ _CSceneObjectContainer_::_CSceneObjectContainer_()
     rt.objType=sim_syncobj_dummy; // doesn't matter, as long as it is a scene object
     setSyncMsgRouting(nullptr,rt);
     setObjectCanSync(true);
+    _objectPathCacheGeneration=0;
+    _objectPathCacheHits=0;
+    _objectPathCacheMisses=0;
 }
 
 _CSceneObjectContainer_::~_CSceneObjectContainer_()
@@ -46,19 +56,17 @@ CSceneObject* _CSceneObjectContainer_::getObjectFromIndex(size_t index) const
 
 CSceneObject* _CSceneObjectContainer_::getObjectFromHandle(int objectHandle) const
 {
-    std::map<int,CSceneObject*>::const_iterator it=_objectHandleMap.find(objectHandle);
-    if (it!=_objectHandleMap.end())
-        return(it->second);
+    CSceneObject* const* it=_objectHandleMap.find(objectHandle);
+    if (it!=nullptr)
+        return(*it);
     return(nullptr);
 }
 
 CSceneObject* _CSceneObjectContainer_::getObjectFromUid(long long int objectUid) const
-{ // not efficient. For now
-    for (size_t i=0;i<_allObjects.size();i++)
-    {
-        if (_allObjects[i]->getObjectUid()==objectUid)
-            return(_allObjects[i]);
-    }
+{
+    CSceneObject* const* it=_objectUidMap.find(objectUid);
+    if (it!=nullptr)
+        return(*it);
     return(nullptr);
 }
 
@@ -970,6 +978,7 @@ size_t _CSceneObjectContainer_::getOrphanCount() const
 void _CSceneObjectContainer_::_addToOrphanObjects(CSceneObject* object)
 {
     _orphanObjects.push_back(object);
+    invalidateObjectPaths();
 }
 
 void _CSceneObjectContainer_::_removeFromOrphanObjects(CSceneObject* object)
@@ -982,6 +991,7 @@ void _CSceneObjectContainer_::_removeFromOrphanObjects(CSceneObject* object)
             break;
         }
     }
+    invalidateObjectPaths();
 }
 
 int _CSceneObjectContainer_::getObjectSequence(const CSceneObject* object) const
@@ -1016,6 +1026,7 @@ bool _CSceneObjectContainer_::setObjectSequence(CSceneObject* object,int order)
                 {
                     _orphanObjects.erase(_orphanObjects.begin()+i);
                     _orphanObjects.insert(_orphanObjects.begin()+order,object);
+                    invalidateObjectPaths();
                     return(true);
                 }
                 break;
@@ -1053,7 +1064,9 @@ void _CSceneObjectContainer_::_addObject(CSceneObject* object)
 {
     _orphanObjects.push_back(object);
     _allObjects.push_back(object);
-    _objectHandleMap[object->getObjectHandle()]=object;
+    _objectHandleMap.insert(object->getObjectHandle(),object);
+    _objectUidMap.insert(object->getObjectUid(),object);
+    invalidateObjectPaths();
     _objectNameMap_old[object->getObjectName_old()]=object;
     _objectAltNameMap_old[object->getObjectAltName_old()]=object;
     int t=object->getObjectType();
@@ -1153,6 +1166,8 @@ void _CSceneObjectContainer_::_removeObject(CSceneObject* object)
     }
 
     _objectHandleMap.erase(object->getObjectHandle());
+    _objectUidMap.erase(object->getObjectUid());
+    invalidateObjectPaths();
     _objectNameMap_old.erase(object->getObjectName_old());
     _objectAltNameMap_old.erase(object->getObjectAltName_old());
     delete object;
@@ -1313,6 +1328,59 @@ CSceneObject* _CSceneObjectContainer_::_getObjectFromSimplePath(const CSceneObje
 }
 
 CSceneObject* _CSceneObjectContainer_::getObjectFromPath(const CSceneObject* emittingObject,const char* objectAliasAndPath,int index) const
+{ // memoized. Can be called concurrently, e.g. by isolated scripts
+    SObjectPathKey key;
+    key.emittingUid=-1;
+    if (emittingObject!=nullptr)
+        key.emittingUid=emittingObject->getObjectUid();
+    key.index=index;
+    key.path=objectAliasAndPath;
+    unsigned long long int generation=_objectPathGeneration;
+    _objectPathCacheMutex.lock_simple("_CSceneObjectContainer_::getObjectFromPath");
+    if (_objectPathCacheGeneration!=generation)
+    {
+        _objectPathCache.clear();
+        _objectPathCacheGeneration=generation;
+    }
+    auto it=_objectPathCache.find(key);
+    if (it!=_objectPathCache.end())
+    {
+        CSceneObject* retVal=it->second;
+        _objectPathCacheHits++;
+        _objectPathCacheMutex.unlock_simple();
+        return(retVal);
+    }
+    _objectPathCacheMisses++;
+    _objectPathCacheMutex.unlock_simple();
+
+    CSceneObject* retVal=_getObjectFromPath(emittingObject,objectAliasAndPath,index);
+
+    _objectPathCacheMutex.lock_simple("_CSceneObjectContainer_::getObjectFromPath");
+    if ( (_objectPathCacheGeneration==generation)&&(_objectPathGeneration==generation) )
+    { // the scene structure did not change since the lookup started
+        if (_objectPathCache.size()>=OBJECTPATHCACHE_MAX_SIZE)
+            _objectPathCache.clear(); // e.g. paths generated in a loop
+        _objectPathCache[std::move(key)]=retVal;
+    }
+    _objectPathCacheMutex.unlock_simple();
+    return(retVal);
+}
+
+void _CSceneObjectContainer_::invalidateObjectPaths()
+{ // global: objects do not always know which world they belong to. A spurious invalidation is harmless
+    _objectPathGeneration++;
+}
+
+void _CSceneObjectContainer_::getObjectPathCacheStats(size_t& hits,size_t& misses,size_t& entries) const
+{
+    _objectPathCacheMutex.lock_simple("_CSceneObjectContainer_::getObjectPathCacheStats");
+    hits=_objectPathCacheHits;
+    misses=_objectPathCacheMisses;
+    entries=_objectPathCache.size();
+    _objectPathCacheMutex.unlock_simple();
+}
+
+CSceneObject* _CSceneObjectContainer_::_getObjectFromPath(const CSceneObject* emittingObject,const char* objectAliasAndPath,int index) const
 {
     std::string path(objectAliasAndPath);
     CSceneObject* retVal=nullptr;
@@ -1406,3 +1474,36 @@ CSceneObject* _CSceneObjectContainer_::_getObjectInTree(const CSceneObject* tree
     return(nullptr);
 }
 
+
+void _CSceneObjectContainer_::benchmarkObjectIndex(size_t objectCount,size_t lookups,double& flatMapMs,double& stdMapMs)
+{ // random lookups by handle, in the handle index (CFlatHashMap) vs. the previous std::map
+    CFlatHashMap<int,CSceneObject*> flatMap;
+    std::map<int,CSceneObject*> stdMap;
+    for (size_t i=0;i<objectCount;i++)
+    {
+        CSceneObject* obj=(CSceneObject*)((i+1)*sizeof(void*)); // never dereferenced
+        flatMap.insert(SIM_IDSTART_SCENEOBJECT+int(i),obj);
+        stdMap[SIM_IDSTART_SCENEOBJECT+int(i)]=obj;
+    }
+    std::vector<int> handles;
+    for (size_t i=0;i<lookups;i++)
+        handles.push_back(SIM_IDSTART_SCENEOBJECT+int(SIM_RAND_FLOAT*double(objectCount+objectCount/10))); // some misses
+    size_t flatHits=0;
+    auto start=std::chrono::steady_clock::now();
+    for (size_t i=0;i<handles.size();i++)
+    {
+        if (flatMap.find(handles[i])!=nullptr)
+            flatHits++;
+    }
+    flatMapMs=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+    size_t stdHits=0;
+    start=std::chrono::steady_clock::now();
+    for (size_t i=0;i<handles.size();i++)
+    {
+        if (stdMap.find(handles[i])!=stdMap.end())
+            stdHits++;
+    }
+    stdMapMs=double(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()-start).count())/1000.0;
+    if (flatHits!=stdHits)
+        App::logMsg(sim_verbosity_errors,"object index benchmark: lookup results differ.");
+}
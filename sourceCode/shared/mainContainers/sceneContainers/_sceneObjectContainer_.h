@@ -3,6 +3,9 @@
 #include <map>
 #include <sceneObject.h>
 #include <syncObject.h>
+#include <flatHashMap.h>
+#include <atomic>
+#include <unordered_map>
 
 class CJoint;
 class CDummy;
@@ -24,6 +27,28 @@ enum {
     sim_syncobj_sceneobjectcont_selection=0,
 };
 
+struct SObjectPathKey
+{
+    long long int emittingUid;
+    int index;
+    std::string path;
+    bool operator==(const SObjectPathKey& other) const
+    {
+        return( (emittingUid==other.emittingUid)&&(index==other.index)&&(path==other.path) );
+    }
+};
+
+struct SObjectPathKeyHash
+{
+    size_t operator()(const SObjectPathKey& key) const
+    {
+        size_t h=std::hash<std::string>()(key.path);
+        h^=std::hash<long long int>()(key.emittingUid)+0x9e3779b97f4a7c15ULL+(h<<6)+(h>>2);
+        h^=std::hash<int>()(key.index)+0x9e3779b97f4a7c15ULL+(h<<6)+(h>>2);
+        return(h);
+    }
+};
+
 class _CSceneObjectContainer_ : public CSyncObject
 {
 public:
@@ -140,6 +165,11 @@ public:
     virtual bool setObjectSequence(CSceneObject* object,int order);
     virtual bool setSelectedObjectHandles(const std::vector<int>* v);
 
+    static void benchmarkObjectIndex(size_t objectCount,size_t lookups,double& flatMapMs,double& stdMapMs);
+
+    static void invalidateObjectPaths(); // call when aliases, model bases, the hierarchy or the object order change, and when objects are added or removed
+    void getObjectPathCacheStats(size_t& hits,size_t& misses,size_t& entries) const;
+
 protected:
     virtual void _addObject(CSceneObject* object);
     virtual void _removeObject(CSceneObject* object);
@@ -148,6 +178,7 @@ protected:
     CSceneObject* _getObjectInTree(const CSceneObject* treeBase,const char* objectAliasAndPath,int& index) const;
     CSceneObject* _getObjectFromSimplePath(const CSceneObject* emittingObject,const char* objectAliasAndPath,int index) const;
     CSceneObject* _getObjectFromComplexPath(const CSceneObject* emittingObject,std::string& path,int index) const;
+    CSceneObject* _getObjectFromPath(const CSceneObject* emittingObject,const char* objectAliasAndPath,int index) const;
 
     virtual void _setSelectedObjectHandles_send(const std::vector<int>* v) const;
 
@@ -155,7 +186,8 @@ private:
     std::vector<CSceneObject*> _orphanObjects;
 
     std::vector<CSceneObject*> _allObjects; // only used for iterating in a RANDOM manner over objects
-    std::map<int,CSceneObject*> _objectHandleMap; // only used for fast access!
+    CFlatHashMap<int,CSceneObject*> _objectHandleMap; // only used for fast access!
+    CFlatHashMap<long long int,CSceneObject*> _objectUidMap; // only used for fast access!
     std::map<std::string,CSceneObject*> _objectNameMap_old; // only used for fast access!
     std::map<std::string,CSceneObject*> _objectAltNameMap_old; // only used for fast access!
 
@@ -177,6 +209,13 @@ private:
     std::vector<CMill*> _millList;
 
     std::vector<int> _selectedObjectHandles;
+
+    // getObjectFromPath results, keyed by emitting object uid, index and path:
+    mutable std::unordered_map<SObjectPathKey,CSceneObject*,SObjectPathKeyHash> _objectPathCache;
+    mutable unsigned long long int _objectPathCacheGeneration;
+    mutable size_t _objectPathCacheHits;
+    mutable size_t _objectPathCacheMisses;
+    static std::atomic<unsigned long long int> _objectPathGeneration;
 };
 
 
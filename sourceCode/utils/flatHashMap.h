@@ -0,0 +1,140 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+template<typename TKey,typename TValue>
+class CFlatHashMap
+{ // Open-addressing hash map (linear probing, backward-shift deletion) for integer keys, e.g. object handles or uids.
+  // All entries are in one contiguous array: lookups touch very few cache lines, unlike with std::map
+public:
+    CFlatHashMap()
+    {
+        _size=0;
+    }
+
+    virtual ~CFlatHashMap()
+    {
+    }
+
+    size_t size() const
+    {
+        return(_size);
+    }
+
+    void clear()
+    {
+        _slots.clear();
+        _size=0;
+    }
+
+    TValue* find(TKey key)
+    {
+        TValue* retVal=nullptr;
+        if (_slots.size()>0)
+        {
+            size_t mask=_slots.size()-1;
+            for (size_t i=_hash(key)&mask;_slots[i].used;i=(i+1)&mask)
+            {
+                if (_slots[i].key==key)
+                {
+                    retVal=&_slots[i].value;
+                    break;
+                }
+            }
+        }
+        return(retVal);
+    }
+
+    const TValue* find(TKey key) const
+    {
+        return(((CFlatHashMap*)this)->find(key));
+    }
+
+    void insert(TKey key,const TValue& value)
+    { // overwrites an existing entry
+        if ((_size+1)*4>_slots.size()*3)
+            _rehash(std::max<size_t>(16,_slots.size()*2));
+        size_t mask=_slots.size()-1;
+        size_t i=_hash(key)&mask;
+        while (_slots[i].used)
+        {
+            if (_slots[i].key==key)
+            {
+                _slots[i].value=value;
+                return;
+            }
+            i=(i+1)&mask;
+        }
+        _slots[i].key=key;
+        _slots[i].value=value;
+        _slots[i].used=true;
+        _size++;
+    }
+
+    bool erase(TKey key)
+    {
+        if (_slots.size()==0)
+            return(false);
+        size_t mask=_slots.size()-1;
+        size_t i=_hash(key)&mask;
+        while (true)
+        {
+            if (!_slots[i].used)
+                return(false);
+            if (_slots[i].key==key)
+                break;
+            i=(i+1)&mask;
+        }
+        _slots[i].used=false;
+        _size--;
+        for (size_t j=(i+1)&mask;_slots[j].used;j=(j+1)&mask)
+        { // shift back following entries of the probe sequence, so that no tombstones are needed
+            size_t ideal=_hash(_slots[j].key)&mask;
+            if (((j-ideal)&mask)>=((j-i)&mask))
+            {
+                _slots[i]=_slots[j];
+                _slots[j].used=false;
+                i=j;
+            }
+        }
+        return(true);
+    }
+
+private:
+    struct SSlot
+    {
+        TKey key;
+        TValue value;
+        bool used;
+    };
+
+    static size_t _hash(TKey key)
+    { // handles and uids are mostly consecutive: mix the bits (splitmix64 finalizer)
+        unsigned long long int x=(unsigned long long int)key;
+        x=(x^(x>>30))*0xbf58476d1ce4e5b9ULL;
+        x=(x^(x>>27))*0x94d049bb133111ebULL;
+        x=x^(x>>31);
+        return(size_t(x));
+    }
+
+    void _rehash(size_t capacity)
+    { // capacity is a power of 2
+        std::vector<SSlot> old;
+        old.swap(_slots);
+        SSlot empty;
+        empty.key=TKey();
+        empty.value=TValue();
+        empty.used=false;
+        _slots.resize(capacity,empty);
+        _size=0;
+        for (size_t i=0;i<old.size();i++)
+        {
+            if (old[i].used)
+                insert(old[i].key,old[i].value);
+        }
+    }
+
+    std::vector<SSlot> _slots;
+    size_t _size;
+};
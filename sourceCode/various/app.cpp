@@ -207,6 +207,8 @@ void App::simulationThreadLoop()
         }
     }
 
+    App::worldContainer->handleEventLogReplay(); // paced event log replay, if any
+
     // Handle the main loop (one pass):
     if (_workThreadLoopCallback!=nullptr)
         _workThreadLoopCallback();
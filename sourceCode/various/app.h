@@ -7,6 +7,7 @@
 #include <vMutex.h>
 #include <worldContainer.h>
 #include <gm.h>
+#include <funcTraceBuffer.h>
 #ifdef SIM_WITH_QT
     #include <simQApp.h>
     #include <simAndUiThreadSync.h>
@@ -182,6 +183,12 @@ class CFuncTrace
 public:
     CFuncTrace(const char* functionName,int traceVerbosity)
     {
+        _traceSession=0;
+        if (CFuncTraceBuffer::isEnabled())
+        { // binary trace: no string formatting
+            _functionName=functionName;
+            _traceSession=CFuncTraceBuffer::recordEnter(_functionName);
+        }
         if (App::getConsoleOrStatusbarVerbosityTriggered(traceVerbosity))
         {
             _txt=functionName;
@@ -195,11 +202,15 @@ public:
     };
     virtual ~CFuncTrace()
     {
+        if (_traceSession!=0)
+            CFuncTraceBuffer::recordExit(_functionName,_traceSession);
         if (_txt.size()>0)
             App::logMsg(_verbosity,(std::string("<-- ")+_txt).c_str());
     };
 
 private:
+    const char* _functionName;
+    unsigned long long int _traceSession;
     std::string _txt;
     int _verbosity;
 };
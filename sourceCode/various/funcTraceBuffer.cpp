@@ -0,0 +1,158 @@
+#include <funcTraceBuffer.h>
+#include <vMutex.h>
+#include <vThread.h>
+#include <chrono>
+#include <algorithm>
+#include <stdio.h>
+
+std::atomic<bool> CFuncTraceBuffer::_enabled(false);
+std::atomic<unsigned long long int> CFuncTraceBuffer::_session(0);
+size_t CFuncTraceBuffer::_recordsPerThread=0;
+std::vector<SFuncTraceRing*> CFuncTraceBuffer::_rings;
+static VMutex _ringsMutex;
+static thread_local SFuncTraceRing* _threadRing=nullptr;
+
+unsigned long long int CFuncTraceBuffer::recordEnter(const char* functionName)
+{
+    unsigned long long int retVal=0;
+    SFuncTraceRing* ring=_getRing();
+    if (ring!=nullptr)
+    {
+        retVal=ring->session;
+        _write(ring,retVal,functionName,true);
+    }
+    return(retVal);
+}
+
+void CFuncTraceBuffer::recordExit(const char* functionName,unsigned long long int session)
+{ // the exit record only goes to the ring of the enter record's session: a function that outlives a session
+    // must not write an orphan record into the ring of the next session
+    SFuncTraceRing* ring=_threadRing;
+    if ( (ring!=nullptr)&&(ring->session==session) )
+        _write(ring,session,functionName,false);
+}
+
+void CFuncTraceBuffer::_write(SFuncTraceRing* ring,unsigned long long int session,const char* functionName,bool enter)
+{ // the writing flag is set before _enabled is checked, and dumpAsChromeTrace clears _enabled before it waits for
+    // the flags: once the dump reads the ring, no write is in progress, and no new write will start
+    ring->writing.store(true);
+    if ( _enabled.load()&&(_session.load()==session) )
+    {
+        unsigned long long int cnt=ring->writeCnt.load(std::memory_order_relaxed);
+        SFuncTraceRecord& r=ring->records[cnt%ring->records.size()];
+        r.functionName=functionName;
+        r.timeInNs=(unsigned long long int)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        r.enter=enter;
+        ring->writeCnt.store(cnt+1,std::memory_order_release);
+    }
+    ring->writing.store(false,std::memory_order_release);
+}
+
+void CFuncTraceBuffer::_waitForWriters()
+{ // call with _ringsMutex locked and _enabled cleared
+    for (size_t i=0;i<_rings.size();i++)
+    {
+        while (_rings[i]->writing.load())
+            VThread::switchThread();
+    }
+}
+
+SFuncTraceRing* CFuncTraceBuffer::_getRing()
+{ // only the owning thread writes to a ring, and only the owning thread resets it when a new session started
+    unsigned long long int session=_session.load(std::memory_order_acquire);
+    if ( (_threadRing!=nullptr)&&(_threadRing->session==session) )
+        return(_threadRing);
+    _ringsMutex.lock("CFuncTraceBuffer::_getRing");
+    if (_threadRing==nullptr)
+    {
+        _threadRing=new SFuncTraceRing();
+        _threadRing->writing=false;
+        _threadRing->session=0;
+        _threadRing->threadIndex=int(_rings.size());
+        _rings.push_back(_threadRing);
+    }
+    if (_recordsPerThread>0)
+    {
+        _threadRing->records.resize(_recordsPerThread);
+        _threadRing->writeCnt=0;
+        _threadRing->session=session;
+    }
+    _ringsMutex.unlock();
+    if (_threadRing->session!=session)
+        return(nullptr);
+    return(_threadRing);
+}
+
+void CFuncTraceBuffer::start(size_t recordsPerThread)
+{
+    if (recordsPerThread==0)
+        recordsPerThread=1;
+    _ringsMutex.lock("CFuncTraceBuffer::start");
+    _enabled=false;
+    _recordsPerThread=recordsPerThread;
+    _session++;
+    _enabled=true; // while _ringsMutex is locked: a dump in progress cannot see a new session start
+    _ringsMutex.unlock();
+}
+
+void CFuncTraceBuffer::stop()
+{
+    _enabled=false;
+}
+
+size_t CFuncTraceBuffer::getRecordCount()
+{
+    size_t retVal=0;
+    unsigned long long int session=_session;
+    _ringsMutex.lock("CFuncTraceBuffer::getRecordCount");
+    for (size_t i=0;i<_rings.size();i++)
+    {
+        SFuncTraceRing* ring=_rings[i];
+        if (ring->session==session)
+            retVal+=size_t(std::min<unsigned long long int>(ring->writeCnt,ring->records.size()));
+    }
+    _ringsMutex.unlock();
+    return(retVal);
+}
+
+bool CFuncTraceBuffer::dumpAsChromeTrace(const char* filename)
+{ // see the "Trace Event Format" (chrome://tracing, Perfetto). Timestamps are in microseconds
+    _ringsMutex.lock("CFuncTraceBuffer::dumpAsChromeTrace");
+    if (_enabled)
+    { // the session was restarted since the last stop
+        _ringsMutex.unlock();
+        return(false);
+    }
+    _waitForWriters();
+    FILE* f=fopen(filename,"w");
+    if (f==nullptr)
+    {
+        _ringsMutex.unlock();
+        return(false);
+    }
+    unsigned long long int session=_session;
+    fprintf(f,"{\"traceEvents\":[\n");
+    bool first=true;
+    for (size_t i=0;i<_rings.size();i++)
+    {
+        SFuncTraceRing* ring=_rings[i];
+        if (ring->session!=session)
+            continue;
+        unsigned long long int cnt=ring->writeCnt.load(std::memory_order_acquire);
+        unsigned long long int s=ring->records.size();
+        unsigned long long int start=0;
+        if (cnt>s)
+            start=cnt-s; // the ring wrapped: oldest records were overwritten
+        for (unsigned long long int j=start;j<cnt;j++)
+        {
+            const SFuncTraceRecord& r=ring->records[j%s];
+            if (!first)
+                fprintf(f,",\n");
+            first=false;
+            fprintf(f,"{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":0,\"tid\":%i}",r.functionName,r.enter?"B":"E",double(r.timeInNs)/1000.0,ring->threadIndex);
+        }
+    }
+    _ringsMutex.unlock();
+    fprintf(f,"\n]}\n");
+    return(fclose(f)==0);
+}
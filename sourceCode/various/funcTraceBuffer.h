@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <string>
+
+struct SFuncTraceRecord
+{
+    const char* functionName; // acts as the function id: points to __func__, which is static
+    unsigned long long int timeInNs;
+    bool enter;
+};
+
+struct SFuncTraceRing
+{
+    std::vector<SFuncTraceRecord> records;
+    std::atomic<unsigned long long int> writeCnt;
+    std::atomic<bool> writing; // set by the owning thread while it writes a record
+    unsigned long long int session;
+    int threadIndex;
+};
+
+class CFuncTraceBuffer
+{ // Binary function trace. Each thread writes fixed-size records into its own ring (no lock), dumpable as Chrome trace JSON
+public:
+    static bool isEnabled()
+    {
+        return(_enabled.load(std::memory_order_relaxed));
+    }
+    static unsigned long long int recordEnter(const char* functionName); // returns the session to pass to recordExit, or 0
+    static void recordExit(const char* functionName,unsigned long long int session);
+
+    static void start(size_t recordsPerThread);
+    static void stop();
+    static bool dumpAsChromeTrace(const char* filename); // call after stop
+    static size_t getRecordCount();
+
+private:
+    static SFuncTraceRing* _getRing();
+    static void _write(SFuncTraceRing* ring,unsigned long long int session,const char* functionName,bool enter);
+    static void _waitForWriters();
+
+    static std::atomic<bool> _enabled;
+    static std::atomic<unsigned long long int> _session; // first session is 1
+    static size_t _recordsPerThread;
+    static std::vector<SFuncTraceRing*> _rings; // never shrinks: threads keep a pointer to their ring
+};
@@ -49,10 +49,16 @@
     #define IF_C_API_SIM_OR_UI_THREAD_CAN_READ_DATA  for(CSimAndUiThreadSync readData(__func__);readData.simOrUiThread_tryToLockForRead_cApi();)
 #endif
 
-// Trace commands:
-#define TRACE_C_API CFuncTrace funcTrace(__func__,sim_verbosity_traceall)
-#define TRACE_LUA_API CFuncTrace funcTrace(__func__,sim_verbosity_tracelua)
-#define TRACE_INTERNAL CFuncTrace funcTrace(__func__,sim_verbosity_traceall)
+// Trace commands (define SIM_WITHOUT_FUNCTRACE to compile them out):
+#ifdef SIM_WITHOUT_FUNCTRACE
+    #define TRACE_C_API
+    #define TRACE_LUA_API
+    #define TRACE_INTERNAL
+#else
+    #define TRACE_C_API CFuncTrace funcTrace(__func__,sim_verbosity_traceall)
+    #define TRACE_LUA_API CFuncTrace funcTrace(__func__,sim_verbosity_tracelua)
+    #define TRACE_INTERNAL CFuncTrace funcTrace(__func__,sim_verbosity_traceall)
+#endif
 
 //#include <typeinfo>
 #define SIMPLE_FUNCNAME_DEBUG printf("SYNC_DEBUG: %s, %s\n",typeid(*this).name(),__func__);
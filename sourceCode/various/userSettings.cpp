@@ -95,6 +95,11 @@
 #define _USR_ADDITIONAL_LUA_PATH "additionalLuaPath"
 #define _USR_ADDITIONAL_PYTHON_PATH "additionalPythonPath"
 #define _USR_DEFAULT_PYTHON "defaultPython"
+#define _USR_LUA_BYTECODE_CACHE_FOLDER "luaBytecodeCacheFolder"
+#define _USR_LUA_STATE_POOL_SIZE "luaStatePoolSize"
+#define _USR_ISOLATED_SCRIPT_THREADS "isolatedScriptThreads"
+#define _USR_WORLD_TRANSFORM_STORE "worldTransformStore"
+#define _USR_SCENE_BROADPHASE "sceneBroadphase"
 #define _USR_EXECUTE_UNSAFE "executeUnsafe"
 
 #define _USR_DIRECTORY_FOR_SCENES "defaultDirectoryForScenes"
@@ -375,6 +380,11 @@ CUserSettings::CUserSettings()
     additionalLuaPath="";
     additionalPythonPath="";
     defaultPython="";
+    luaBytecodeCacheFolder="";
+    luaStatePoolSize=0;
+    isolatedScriptThreads=0;
+    worldTransformStore=false;
+    sceneBroadphase=true;
     executeUnsafe=false;
 
     desktopRecordingIndex=0;
@@ -754,6 +764,11 @@ void CUserSettings::saveUserSettings()
     c.addString(_USR_ADDITIONAL_LUA_PATH,additionalLuaPath,"e.g. d:/myLuaRoutines");
     c.addString(_USR_ADDITIONAL_PYTHON_PATH,additionalPythonPath,"e.g. d:/myPythonRoutines");
     c.addString(_USR_DEFAULT_PYTHON,defaultPython,"e.g. c:/Python38/python.exe");
+    c.addString(_USR_LUA_BYTECODE_CACHE_FOLDER,luaBytecodeCacheFolder,"compiled Lua scripts are also cached there, e.g. d:/luaCache. Empty=only in memory. Only use a folder that only trusted users can write to");
+    c.addInteger(_USR_LUA_STATE_POOL_SIZE,luaStatePoolSize,"number of Lua states prepared in advance for simulation scripts, e.g. 16. 0=disabled");
+    c.addInteger(_USR_ISOLATED_SCRIPT_THREADS,isolatedScriptThreads,"threads running sysCall_sensing of isolated scripts, see sim.setScriptIsolated. 0=one per core, -1=disabled");
+    c.addBoolean(_USR_WORLD_TRANSFORM_STORE,worldTransformStore,"world poses of all scene objects are updated in one batch per simulation step, e.g. for very large scenes");
+    c.addBoolean(_USR_SCENE_BROADPHASE,sceneBroadphase,"collision, distance and proximity sensor checks against all objects only visit nearby objects");
     c.addBoolean(_USR_EXECUTE_UNSAFE,executeUnsafe,"recommended to keep false.");
     c.addInteger(_USR_DESKTOP_RECORDING_INDEX,desktopRecordingIndex,"");
     c.addInteger(_USR_DESKTOP_RECORDING_WIDTH,desktopRecordingWidth,"-1=default.");
@@ -1047,6 +1062,11 @@ void CUserSettings::loadUserSettings()
     c.getString(_USR_ADDITIONAL_LUA_PATH,additionalLuaPath);
     c.getString(_USR_ADDITIONAL_PYTHON_PATH,additionalPythonPath);
     c.getString(_USR_DEFAULT_PYTHON,defaultPython);
+    c.getString(_USR_LUA_BYTECODE_CACHE_FOLDER,luaBytecodeCacheFolder);
+    c.getInteger(_USR_LUA_STATE_POOL_SIZE,luaStatePoolSize);
+    c.getInteger(_USR_ISOLATED_SCRIPT_THREADS,isolatedScriptThreads);
+    c.getBoolean(_USR_WORLD_TRANSFORM_STORE,worldTransformStore);
+    c.getBoolean(_USR_SCENE_BROADPHASE,sceneBroadphase);
     c.getBoolean(_USR_EXECUTE_UNSAFE,executeUnsafe);
     c.getInteger(_USR_DESKTOP_RECORDING_INDEX,desktopRecordingIndex);
     c.getInteger(_USR_DESKTOP_RECORDING_WIDTH,desktopRecordingWidth);
@@ -117,6 +117,11 @@ public:
     std::string additionalLuaPath;
     std::string additionalPythonPath;
     std::string defaultPython;
+    std::string luaBytecodeCacheFolder;
+    int luaStatePoolSize;
+    int isolatedScriptThreads;
+    bool worldTransformStore;
+    bool sceneBroadphase;
     bool executeUnsafe;
 
     int guiFontSize_Win;